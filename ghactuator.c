@@ -0,0 +1,619 @@
+/** @brief Gh actuator output functions
+*   @file ghactuator.c
+*/
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "ghactuator.h"
+#include "ghpid.h"
+
+// A pulse the guard would hold back is stretched without the loop knowing
+#if PIDMINPULSE < ACTMINON || PIDMINPULSE < ACTMINOFF
+#error "PIDMINPULSE must be at least ACTMINON and ACTMINOFF"
+#endif
+
+// In-memory gpiochip: enforces the same request rules as the kernel
+static struct
+{
+    int requested;
+    uint32_t num;
+    uint32_t offsets[GPIO_V2_LINES_MAX];
+    int activelow;
+    uint64_t level;             // physical level, one bit per chip line
+    uint64_t sets;              // SET_VALUES ioctls, counted for GhActReport()
+    uint64_t setmask;           // mask of the last one
+}fakechip;
+
+/** @brief Handles a GPIO ioctl on the fake chip
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fd ACTFAKECHIPFD or ACTFAKELINEFD
+ *  @param req ioctl request
+ *  @param arg pointer to the request structure
+ *  @return int 0 on success, -1 with errno set on error
+*/
+static int GhActFakeIoctl(int fd, unsigned long req, void * arg)
+{
+    struct gpio_v2_line_request * lr = arg;
+    struct gpio_v2_line_values * lv = arg;
+    uint64_t seen = 0;
+    uint64_t bit;
+    uint32_t i;
+    uint32_t a;
+
+    if(fd == ACTFAKECHIPFD && req == GPIO_V2_GET_LINE_IOCTL)
+    {
+        if(fakechip.requested)
+        {
+            errno = EBUSY;
+            return -1;
+        }
+        if(lr->num_lines == 0 || lr->num_lines > GPIO_V2_LINES_MAX || !(lr->config.flags & GPIO_V2_LINE_FLAG_OUTPUT))
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        for(i=0; i<lr->num_lines; i++)
+        {
+            bit = 1ull << lr->offsets[i];
+            if(lr->offsets[i] >= ACTFAKELINES || (seen & bit))
+            {
+                errno = EINVAL;
+                return -1;
+            }
+            seen |= bit;
+            fakechip.offsets[i] = lr->offsets[i];
+        }
+        fakechip.num = lr->num_lines;
+        fakechip.activelow = (lr->config.flags & GPIO_V2_LINE_FLAG_ACTIVE_LOW) != 0;
+        for(i=0; i<lr->num_lines; i++)
+        {
+            fakechip.level = (fakechip.level & ~(1ull << fakechip.offsets[i])) | ((uint64_t) fakechip.activelow << fakechip.offsets[i]);
+        }
+        for(a=0; a<lr->config.num_attrs; a++)
+        {
+            if(lr->config.attrs[a].attr.id == GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES)
+            {
+                for(i=0; i<lr->num_lines; i++)
+                {
+                    if(lr->config.attrs[a].mask & (1ull << i))
+                    {
+                        bit = ((lr->config.attrs[a].attr.values >> i) & 1) ^ fakechip.activelow;
+                        fakechip.level = (fakechip.level & ~(1ull << fakechip.offsets[i])) | (bit << fakechip.offsets[i]);
+                    }
+                }
+            }
+        }
+        fakechip.requested = 1;
+        lr->fd = ACTFAKELINEFD;
+        return 0;
+    }
+    if(fd == ACTFAKELINEFD && fakechip.requested && (req == GPIO_V2_LINE_SET_VALUES_IOCTL || req == GPIO_V2_LINE_GET_VALUES_IOCTL))
+    {
+        if(lv->mask == 0 || (lv->mask >> fakechip.num) != 0)
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        if(req == GPIO_V2_LINE_SET_VALUES_IOCTL)
+        {
+            fakechip.sets++;
+            fakechip.setmask = lv->mask;
+        }
+        for(i=0; i<fakechip.num; i++)
+        {
+            if(!(lv->mask & (1ull << i)))
+            {
+                continue;
+            }
+            if(req == GPIO_V2_LINE_SET_VALUES_IOCTL)
+            {
+                bit = ((lv->bits >> i) & 1) ^ fakechip.activelow;
+                fakechip.level = (fakechip.level & ~(1ull << fakechip.offsets[i])) | (bit << fakechip.offsets[i]);
+            }
+            else
+            {
+                bit = ((fakechip.level >> fakechip.offsets[i]) & 1) ^ fakechip.activelow;
+                lv->bits = (lv->bits & ~(1ull << i)) | (bit << i);
+            }
+        }
+        return 0;
+    }
+    errno = (fd == ACTFAKECHIPFD || fd == ACTFAKELINEFD) ? ENOTTY : EBADF;
+    return -1;
+}
+
+/** @brief Opens the fake chip, which is always present
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param path ignored
+ *  @return int ACTFAKECHIPFD
+*/
+static int GhActFakeOpen(const char * path)
+{
+    (void) path;
+    return ACTFAKECHIPFD;
+}
+
+/** @brief Releases the fake line request
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fd ACTFAKECHIPFD or ACTFAKELINEFD
+ *  @return void
+*/
+static void GhActFakeClose(int fd)
+{
+    if(fd == ACTFAKELINEFD)
+    {
+        fakechip.requested = 0;
+    }
+}
+
+/** @brief Opens a gpiochip device
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param path pointer to gpiochip device path
+ *  @return int chip descriptor, -1 on error
+*/
+static int GhActChipOpen(const char * path)
+{
+    int fd = open(path,O_RDWR | O_CLOEXEC);
+    if(fd == -1)
+    {
+        perror(path);
+    }
+    return fd;
+}
+
+/** @brief Issues a GPIO ioctl to the kernel
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fd chip or line request descriptor
+ *  @param req ioctl request
+ *  @param arg pointer to the request structure
+ *  @return int 0 on success, -1 on error
+*/
+static int GhActChipIoctl(int fd, unsigned long req, void * arg)
+{
+    return ioctl(fd,req,arg);
+}
+
+/** @brief Closes a chip or line request descriptor
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fd descriptor
+ *  @return void
+*/
+static void GhActChipClose(int fd)
+{
+    close(fd);
+}
+
+const actchip_s actgpiochip = {"gpiochip",GhActChipOpen,GhActChipIoctl,GhActChipClose};
+const actchip_s actfakechip = {"fake gpiochip",GhActFakeOpen,GhActFakeIoctl,GhActFakeClose};
+
+/** @brief Issues a GPIO ioctl through the chip table
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @param fd chip or line request descriptor
+ *  @param req ioctl request
+ *  @param arg pointer to the request structure
+ *  @return int 0 on success, -1 on error
+*/
+static int GhActIoctl(ghact_s * act, int fd, unsigned long req, void * arg)
+{
+    return act->chip->ioctl(fd,req,arg);
+}
+
+/** @brief Reads the monotonic clock in nanoseconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t nanoseconds
+*/
+static int64_t GhActNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Requests both relay lines as outputs, initially off
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators, usable (simulated) even when this fails
+ *  @param ops pointer to the chip table, actgpiochip or actfakechip
+ *  @param chip pointer to gpiochip device path
+ *  @return int 1 on success, 0 on error
+*/
+int GhActOpen(ghact_s * act, const actchip_s * ops, const char * chip)
+{
+    int k;
+    struct gpio_v2_line_request lr = {0};
+
+    memset(act,0,sizeof(ghact_s));
+    act->chip = ops;
+    act->chipfd = -1;
+    act->linefd = -1;
+    act->timerfd = -1;
+    act->latmin = INT64_MAX;
+    act->line[TEMPERATURE].offset = ACTHEATERPIN;
+    act->line[HUMIDITY].offset = ACTHUMIDPIN;
+    for(k=0; k<ACTLINES; k++)
+    {
+        act->line[k].state = OFF;
+        act->line[k].changed = -1;
+        lr.offsets[k] = (uint32_t) act->line[k].offset;
+    }
+
+    act->chipfd = ops->open(chip);
+    if(act->chipfd == -1)
+    {
+        return 0;
+    }
+    // One request for both lines, driven low (off) from the moment it is granted
+    strncpy(lr.consumer,ACTCONSUMER,sizeof(lr.consumer) - 1);
+    lr.num_lines = ACTLINES;
+    lr.config.flags = GPIO_V2_LINE_FLAG_OUTPUT | (ACTACTIVELOW ? GPIO_V2_LINE_FLAG_ACTIVE_LOW : 0);
+    lr.config.num_attrs = 1;
+    lr.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+    lr.config.attrs[0].attr.values = 0;
+    lr.config.attrs[0].mask = (1ull << ACTLINES) - 1;
+    act->timerfd = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+    if(GhActIoctl(act,act->chipfd,GPIO_V2_GET_LINE_IOCTL,&lr) == -1 || act->timerfd == -1)
+    {
+        perror("Error (GPIO line request)");
+        GhActClose(act);
+        return 0;
+    }
+    act->linefd = lr.fd;
+    return 1;
+}
+
+/** @brief Drives the relays to a command, within the minimum on and off times
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @param ctrl object of controls type
+ *  @param nowms monotonic milliseconds
+ *  @return object of controls type with the relay states actually driven
+*/
+control_s GhActApply(ghact_s * act, control_s ctrl, int64_t nowms)
+{
+    int k;
+    int want[ACTLINES];
+    int64_t t0 = GhActNowNs();
+    int64_t lat;
+    int64_t need;
+    int64_t wait = -1;
+    struct gpio_v2_line_values lv = {0};
+    struct itimerspec its = {0};
+
+    act->cmd = ctrl;
+    if(act->linefd == -1)
+    {
+        return ctrl;
+    }
+    want[TEMPERATURE] = ctrl.heateron ? ON : OFF;
+    want[HUMIDITY] = ctrl.humidifieron ? ON : OFF;
+    for(k=0; k<ACTLINES; k++)
+    {
+        if(want[k] == act->line[k].state)
+        {
+            continue;
+        }
+        need = act->line[k].changed + (act->line[k].state == ON ? ACTMINON : ACTMINOFF);
+        if(act->line[k].changed >= 0 && nowms < need)
+        {
+            wait = (wait < 0 || need - nowms < wait) ? need - nowms : wait;
+            continue;
+        }
+        lv.mask |= 1ull << k;
+        lv.bits |= (uint64_t) want[k] << k;
+    }
+    act->held += (wait >= 0);
+
+    // Only lines that change are written, all of them in one ioctl
+    if(lv.mask == 0)
+    {
+        act->unchanged++;
+    }
+    else if(GhActIoctl(act,act->linefd,GPIO_V2_LINE_SET_VALUES_IOCTL,&lv) == 0)
+    {
+        lat = GhActNowNs() - t0;
+        act->writes++;
+        act->latsum += lat;
+        act->latmin = (lat < act->latmin) ? lat : act->latmin;
+        act->latmax = (lat > act->latmax) ? lat : act->latmax;
+        for(k=0; k<ACTLINES; k++)
+        {
+            if(lv.mask & (1ull << k))
+            {
+                act->line[k].state = want[k];
+                act->line[k].changed = nowms;
+                act->line[k].switches++;
+            }
+        }
+    }
+    else
+    {
+        perror("Error (GPIO set values)");
+    }
+
+    // Retry a held change when its guard expires, or disarm
+    if(wait > 0)
+    {
+        its.it_value.tv_sec = wait / 1000;
+        its.it_value.tv_nsec = (wait % 1000) * 1000000L;
+    }
+    timerfd_settime(act->timerfd,0,&its,NULL);
+
+    ctrl.heateron = act->line[TEMPERATURE].state;
+    ctrl.humidifieron = act->line[HUMIDITY].state;
+    return ctrl;
+}
+
+/** @brief Handles a guard timer expiry by re-applying the last command
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @return object of controls type with the relay states actually driven
+*/
+control_s GhActTick(ghact_s * act)
+{
+    uint64_t expiries;
+    control_s ctrl = act->cmd;
+    if(read(act->timerfd,&expiries,sizeof(expiries)) != sizeof(expiries))
+    {
+        ctrl.heateron = act->line[TEMPERATURE].state;
+        ctrl.humidifieron = act->line[HUMIDITY].state;
+        return ctrl;
+    }
+    return GhActApply(act,act->cmd,GhActNowNs() / 1000000);
+}
+
+/** @brief Reads the relay lines back from the chip
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @param pins array of ACTLINES values filled with ON or OFF
+ *  @return int 1 on success, 0 on error
+*/
+int GhActPins(ghact_s * act, int * pins)
+{
+    int k;
+    struct gpio_v2_line_values lv = {0};
+    lv.mask = (1ull << ACTLINES) - 1;
+    if(act->linefd == -1 || GhActIoctl(act,act->linefd,GPIO_V2_LINE_GET_VALUES_IOCTL,&lv) == -1)
+    {
+        return 0;
+    }
+    for(k=0; k<ACTLINES; k++)
+    {
+        pins[k] = (lv.bits >> k) & 1;
+    }
+    return 1;
+}
+
+/** @brief Prints relay switch counts and command-to-pin latency
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @return void
+*/
+void GhActDisplay(ghact_s * act)
+{
+    if(act->linefd == -1)
+    {
+        return;
+    }
+    fprintf(stdout,"Actuators\tswitches %llu/%llu\twrites %llu\tunchanged %llu\theld %llu\tlatency %.1lf/%.1lf/%.1lf us\n",
+        (unsigned long long) act->line[TEMPERATURE].switches,(unsigned long long) act->line[HUMIDITY].switches,
+        (unsigned long long) act->writes,(unsigned long long) act->unchanged,(unsigned long long) act->held,
+        act->writes ? act->latmin / 1e3 : 0.0,act->writes ? act->latsum / 1e3 / act->writes : 0.0,act->latmax / 1e3);
+}
+
+/** @brief Switches the relays off and releases the lines
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @return void
+*/
+void GhActClose(ghact_s * act)
+{
+    struct gpio_v2_line_values lv = {0};
+    if(act->linefd != -1)
+    {
+        // Safe state on the way out, regardless of the minimum on time
+        lv.mask = (1ull << ACTLINES) - 1;
+        GhActIoctl(act,act->linefd,GPIO_V2_LINE_SET_VALUES_IOCTL,&lv);
+        act->chip->close(act->linefd);
+        act->linefd = -1;
+    }
+    if(act->chipfd != -1)
+    {
+        act->chip->close(act->chipfd);
+        act->chipfd = -1;
+    }
+    if(act->timerfd != -1)
+    {
+        close(act->timerfd);
+        act->timerfd = -1;
+    }
+}
+
+/** @brief Reads a fake chip line as ON or OFF, undoing the active-low inversion
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param offset chip line
+ *  @return int ON or OFF
+*/
+static int GhActFakePin(int offset)
+{
+    return (int)((fakechip.level >> offset) & 1) ^ ACTACTIVELOW;
+}
+
+/** @brief Prints one report check
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @param what description of the check
+ *  @param ok 1 if it passed
+ *  @return int 1 for a failure, to be counted
+*/
+static int GhActCheck(FILE * fp, const char * what, int ok)
+{
+    fprintf(fp,"%-60s %s\n",what,ok ? "ok" : "FAILED");
+    return !ok;
+}
+
+/** @brief Applies a command and reports whether it wrote exactly the expected lines
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to actuators
+ *  @param heater heater command
+ *  @param humid humidifier command
+ *  @param nowms monotonic milliseconds
+ *  @param mask lines the command should write, 0 for no ioctl at all
+ *  @return int 1 if the ioctls and pins match
+*/
+static int GhActExpect(ghact_s * act, int heater, int humid, int64_t nowms, uint64_t mask)
+{
+    uint64_t sets = fakechip.sets;
+    int pins[ACTLINES] = {GhActFakePin(ACTHEATERPIN),GhActFakePin(ACTHUMIDPIN)};
+    control_s ctrl = {0};
+
+    ctrl.heateron = heater;
+    ctrl.humidifieron = humid;
+    ctrl = GhActApply(act,ctrl,nowms);
+    if(mask & (1ull << TEMPERATURE))
+    {
+        pins[TEMPERATURE] = heater ? ON : OFF;
+    }
+    if(mask & (1ull << HUMIDITY))
+    {
+        pins[HUMIDITY] = humid ? ON : OFF;
+    }
+    return fakechip.sets == sets + (mask != 0) && (mask == 0 || fakechip.setmask == mask)
+        && GhActFakePin(ACTHEATERPIN) == pins[TEMPERATURE] && GhActFakePin(ACTHUMIDPIN) == pins[HUMIDITY]
+        && ctrl.heateron == pins[TEMPERATURE] && ctrl.humidifieron == pins[HUMIDITY];
+}
+
+/** @brief Checks change-only writes, the minimum on and off times and the guard
+ *  timer retry on the fake chip, and times command to pin
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if every check passed, 0 otherwise
+*/
+int GhActReport(FILE * fp)
+{
+    int i;
+    int bad = 0;
+    int wrong = 0;
+    int held;
+    int64_t t;
+    int64_t t0;
+    int64_t lat;
+    int64_t latmin = INT64_MAX;
+    int64_t latmax = 0;
+    int64_t latsum = 0;
+    uint64_t sets;
+    struct itimerspec its;
+    struct pollfd pfd;
+    control_s ctrl = {0};
+    ghact_s act;
+    ghpid_s pid;
+    setpoint_s spts;
+    reading_s rd = {0};
+
+    bad += GhActCheck(fp,"both lines granted in one request, driven off",
+        GhActOpen(&act,&actfakechip,ACTCHIP) && fakechip.num == ACTLINES
+        && GhActFakePin(ACTHEATERPIN) == OFF && GhActFakePin(ACTHUMIDPIN) == OFF);
+    if(act.linefd == -1)
+    {
+        return 0;
+    }
+
+    // Simulated milliseconds, so the guard times are exact
+    t = ACTMINON + ACTMINOFF;
+    bad += GhActCheck(fp,"command equal to the pins issues no ioctl",GhActExpect(&act,OFF,OFF,t,0));
+    bad += GhActCheck(fp,"heater on writes only the heater line",GhActExpect(&act,ON,OFF,t,1ull << TEMPERATURE));
+    bad += GhActCheck(fp,"repeated command issues no ioctl",GhActExpect(&act,ON,OFF,t + 100,0));
+    bad += GhActCheck(fp,"humidifier on writes only the humidifier line",GhActExpect(&act,ON,ON,t + 200,1ull << HUMIDITY));
+    sets = act.held;
+    bad += GhActCheck(fp,"heater off 1 ms inside ACTMINON is held",GhActExpect(&act,OFF,ON,t + ACTMINON - 1,0)
+        && act.held == sets + 1 && timerfd_gettime(act.timerfd,&its) == 0 && its.it_value.tv_nsec > 0);
+    bad += GhActCheck(fp,"heater off at ACTMINON is written",GhActExpect(&act,OFF,ON,t + ACTMINON,1ull << TEMPERATURE));
+    t += ACTMINON;
+    bad += GhActCheck(fp,"heater on 1 ms inside ACTMINOFF is held",GhActExpect(&act,ON,ON,t + ACTMINOFF - 1,0));
+    bad += GhActCheck(fp,"heater on at ACTMINOFF is written",GhActExpect(&act,ON,ON,t + ACTMINOFF,1ull << TEMPERATURE));
+    t += ACTMINOFF + ACTMINON;
+    bad += GhActCheck(fp,"both lines switching share one ioctl",GhActExpect(&act,OFF,OFF,t,(1ull << ACTLINES) - 1));
+
+    // Real time: the held change must go out from the guard timer without a new command
+    t = GhActNowNs() / 1000000;
+    GhActExpect(&act,ON,OFF,t - ACTMINOFF,1ull << TEMPERATURE);
+    act.line[TEMPERATURE].changed = t - ACTMINON + ACTRETRYMS;
+    ctrl.heateron = OFF;
+    ctrl.humidifieron = OFF;
+    ctrl = GhActApply(&act,ctrl,t);
+    pfd.fd = act.timerfd;
+    pfd.events = POLLIN;
+    sets = fakechip.sets;
+    bad += GhActCheck(fp,"held heater off goes out from the guard timer",ctrl.heateron == ON
+        && poll(&pfd,1,ACTRETRYWAITMS) == 1 && GhActTick(&act).heateron == OFF
+        && fakechip.sets == sets + 1 && GhActFakePin(ACTHEATERPIN) == OFF);
+
+    // Command to pin, every command a change that no guard holds back
+    t = GhActNowNs() / 1000000;
+    act.latmin = INT64_MAX;
+    act.latmax = 0;
+    act.latsum = 0;
+    act.writes = 0;
+    for(i=0; i<ACTBENCHN; i++)
+    {
+        t += (ACTMINON > ACTMINOFF) ? ACTMINON : ACTMINOFF;
+        ctrl.heateron = (i & 1) ? OFF : ON;
+        ctrl.humidifieron = ctrl.heateron;
+        t0 = GhActNowNs();
+        GhActApply(&act,ctrl,t);
+        lat = GhActNowNs() - t0;
+        wrong += (GhActFakePin(ACTHEATERPIN) != ctrl.heateron || GhActFakePin(ACTHUMIDPIN) != ctrl.humidifieron);
+        latmin = (lat < latmin) ? lat : latmin;
+        latmax = (lat > latmax) ? lat : latmax;
+        latsum += lat;
+    }
+    bad += GhActCheck(fp,"every timed command reached the pins",wrong == 0);
+
+    // A dead temperature sensor under PID: the heater is held, then opened after PIDSTALESECS
+    GhPidInit(&pid,1);
+    spts.temperature = 20.0;
+    spts.humidity = 50.0;
+    rd.temperature = 10.0;
+    rd.humidity = 50.0;
+    t += ACTMINON + ACTMINOFF;
+    ctrl = GhActApply(&act,GhPidUpdate(&pid,spts,rd,t),t);
+    rd.stale = 1 << TEMPERATURE;
+    held = ctrl.heateron == ON;
+    for(i=1; i*1000 < PIDSTALESECS * 1000; i++)
+    {
+        ctrl = GhActApply(&act,GhPidUpdate(&pid,spts,rd,t + i * 1000),t + i * 1000);
+        held = held && ctrl.heateron == ON && GhActFakePin(ACTHEATERPIN) == ON;
+    }
+    bad += GhActCheck(fp,"heater held on while its sensor is stale under PIDSTALESECS",held);
+    ctrl = GhActApply(&act,GhPidUpdate(&pid,spts,rd,t + i * 1000),t + i * 1000);
+    bad += GhActCheck(fp,"heater off and integral cleared at PIDSTALESECS stale",
+        ctrl.heateron == OFF && GhActFakePin(ACTHEATERPIN) == OFF && pid.loop[TEMPERATURE].integral == 0.0);
+
+    GhActClose(&act);
+    bad += GhActCheck(fp,"close drives both lines off and releases the request",
+        !fakechip.requested && GhActFakePin(ACTHEATERPIN) == OFF && GhActFakePin(ACTHUMIDPIN) == OFF);
+    fprintf(fp,"Command to pin on the %s, %d commands: ioctl %.2lf/%.2lf/%.2lf us, GhActApply() %.2lf/%.2lf/%.2lf us\n",
+        actfakechip.name,ACTBENCHN,act.latmin / 1e3,act.latsum / 1e3 / act.writes,act.latmax / 1e3,
+        latmin / 1e3,latsum / 1e3 / ACTBENCHN,latmax / 1e3);
+    fprintf(fp,"Failures: %d\n",bad);
+    return bad == 0;
+}
@@ -0,0 +1,87 @@
+/** @brief Gh actuator output constants, structures, function prototypes
+*   @file ghactuator.h
+*
+*   Drives the heater and humidifier relays through the GPIO character
+*   device. Both lines are held in one line request, so an update is a
+*   single GPIO_V2_LINE_SET_VALUES_IOCTL with a mask of the lines that
+*   actually change, and no ioctl at all when nothing does. A relay is not
+*   switched off before ACTMINON or on again before ACTMINOFF; a change held
+*   back by the guard is retried from a one-shot timer when it expires.
+*   The chip is reached through an actchip_s table chosen at startup:
+*   actgpiochip for the kernel device, actfakechip for an in-memory gpiochip
+*   that enforces the same request rules, for running without relays.
+*/
+#ifndef GHACTUATOR_H
+#define GHACTUATOR_H
+
+// Includes
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <linux/gpio.h>
+#include "ghcontrol.h"
+
+// Actuator Constants
+#define ACTCHIP "/dev/gpiochip0"
+#define ACTCONSUMER "ghc"
+#define ACTLINES 2              // indexed by TEMPERATURE and HUMIDITY
+#define ACTHEATERPIN 17         // line offsets on ACTCHIP (BCM numbering on a Pi)
+#define ACTHUMIDPIN 27
+#define ACTACTIVELOW 0          // 1 for relay boards that switch on a low level
+#define ACTMINON 10000          // ms a relay stays on before it may switch off
+#define ACTMINOFF 10000         // ms a relay stays off before it may switch on
+#define ACTFAKELINES 58         // lines on the fake chip (as on a Pi 4 gpiochip0)
+#define ACTFAKECHIPFD 1000      // descriptors the fake hands out, never passed to the kernel
+#define ACTFAKELINEFD 1001
+#define ACTBENCHN 10000         // commands GhActReport() times from command to pin
+#define ACTRETRYMS 50           // ms left on the guard when it checks the timer retry
+#define ACTRETRYWAITMS 1000     // ms it waits for that retry
+
+//Typedefs
+typedef struct actchip
+{
+    const char * name;
+    int (*open)(const char * path);             // chip descriptor, -1 on error
+    int (*ioctl)(int fd, unsigned long req, void * arg);
+    void (*close)(int fd);
+}actchip_s;
+
+typedef struct actline
+{
+    int offset;
+    int state;                  // ON or OFF as driven
+    int64_t changed;            // ms of the last switch, -1 before the first
+    uint64_t switches;
+}actline_s;
+
+typedef struct ghact
+{
+    const actchip_s * chip;
+    int chipfd;
+    int linefd;                 // -1 while the outputs are only simulated
+    int timerfd;
+    control_s cmd;              // last command, including changes still held back
+    actline_s line[ACTLINES];
+    uint64_t writes;            // SET_VALUES ioctls issued
+    uint64_t unchanged;         // updates that needed no ioctl
+    uint64_t held;              // updates delayed by the minimum on or off time
+    int64_t latmin;             // ns from command to pin
+    int64_t latmax;
+    int64_t latsum;
+}ghact_s;
+
+// Actuator Chips
+extern const actchip_s actgpiochip;
+extern const actchip_s actfakechip;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhActOpen(ghact_s * act, const actchip_s * ops, const char * chip);
+control_s GhActApply(ghact_s * act, control_s ctrl, int64_t nowms);
+control_s GhActTick(ghact_s * act);
+int GhActPins(ghact_s * act, int * pins);
+void GhActDisplay(ghact_s * act);
+void GhActClose(ghact_s * act);
+int GhActReport(FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,389 @@
+/** @brief Gh backend profile functions
+*   @file ghbackend.c
+*/
+#include "ghbackend.h"
+#include "ghplant.h"
+#include "ghlog.h"
+
+// Plant model sensors
+static plant_s plant;
+static reading_s plantrd;
+static int64_t plantns;         // monotonic ns the plant has been stepped to
+static double plantdue;         // simulated s not yet stepped
+static ghact_s * relays;        // set once by GhBackendAttach(), read from the sensor job
+
+// Log replay sensors
+static const char * replayname;
+static logstream_s * replay;
+static logbatch_s * replaybatch;
+static int replayrow = -1;
+
+/** @brief Reads the monotonic clock in nanoseconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t nanoseconds
+*/
+static int64_t GhBackendNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Starts the plant model at the local time of day
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int exit status, always success
+*/
+static int GhBackendPlantOpen(void)
+{
+    time_t now = time(NULL);
+    struct tm lt;
+
+    localtime_r(&now,&lt);
+    GhPlantInit(&plant,PLANTSEED);
+    plant.t = lt.tm_hour * 3600.0 + lt.tm_min * 60.0 + lt.tm_sec;
+    plantrd = GhPlantRead(&plant);
+    plantns = GhBackendNowNs();
+    plantdue = 0.0;
+    return EXIT_SUCCESS;
+}
+
+/** @brief Steps the plant up to now with the relays as they are driven
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return reading_s plant reading, unchanged when no step was due
+*/
+static reading_s GhBackendPlantSync(void)
+{
+    int64_t now = GhBackendNowNs();
+    int pins[ACTLINES];
+    int steps = 0;
+    control_s ctrl = {0};
+    ghact_s * act = __atomic_load_n(&relays,__ATOMIC_ACQUIRE);
+
+    if(act != NULL && GhActPins(act,pins))
+    {
+        ctrl.heateron = pins[TEMPERATURE];
+        ctrl.humidifieron = pins[HUMIDITY];
+    }
+    plantdue += (now - plantns) / 1e9 * BKSIMSPEED;
+    plantdue = (plantdue > BKSIMMAXSTEP) ? BKSIMMAXSTEP : plantdue;
+    plantns = now;
+    while(plantdue >= PLANTDT)
+    {
+        GhPlantStep(&plant,ctrl,PLANTDT);
+        plantdue -= PLANTDT;
+        steps++;
+    }
+    if(steps > 0)
+    {
+        plantrd = GhPlantRead(&plant);
+    }
+    return plantrd;
+}
+
+/** @brief Reads temperature and humidity from the plant model
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return ht221sData_s temperature and humidity data
+*/
+static ht221sData_s GhBackendPlantHTS221(void)
+{
+    ht221sData_s ht = {0};
+    reading_s rd = GhBackendPlantSync();
+    ht.temperature = rd.temperature;
+    ht.humidity = rd.humidity;
+    ht.valid = 1;
+    return ht;
+}
+
+/** @brief Reads pressure from the plant model
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return lps25hData_s pressure data
+*/
+static lps25hData_s GhBackendPlantLPS25H(void)
+{
+    lps25hData_s lp = {0};
+    reading_s rd = GhBackendPlantSync();
+    lp.temperature = rd.temperature;
+    lp.pressure = rd.pressure;
+    lp.valid = 1;
+    return lp;
+}
+
+/** @brief Leaves sensors with nothing to release
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return void
+*/
+static void GhBackendNoClose(void)
+{
+}
+
+/** @brief Starts the replay before its first line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int exit status, always success (the log is opened by GhBackendSelect())
+*/
+static int GhBackendReplayOpen(void)
+{
+    replayrow = -1;
+    replaybatch->n = 0;
+    return EXIT_SUCCESS;
+}
+
+/** @brief Closes the replayed log
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return void
+*/
+static void GhBackendReplayClose(void)
+{
+    if(replay != NULL)
+    {
+        GhLogClose(replay);
+    }
+    free(replay);
+    free(replaybatch);
+    replay = NULL;
+    replaybatch = NULL;
+}
+
+/** @brief Advances the replay one line and reads its temperature and humidity
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return ht221sData_s temperature and humidity data, not valid past the end of the log
+*/
+static ht221sData_s GhBackendReplayHTS221(void)
+{
+    ht221sData_s ht = {0};
+    if(replaybatch->n > 0 && ++replayrow >= replaybatch->n)
+    {
+        replayrow = 0;
+        replaybatch->n = 0;
+    }
+    if(replaybatch->n == 0 && !replay->eof)
+    {
+        replayrow = (GhLogRead(replay,replaybatch) > 0) ? 0 : -1;
+    }
+    if(replayrow >= 0 && replayrow < replaybatch->n)
+    {
+        ht.temperature = replaybatch->temperature[replayrow];
+        ht.humidity = replaybatch->humidity[replayrow];
+        ht.valid = 1;
+    }
+    return ht;
+}
+
+/** @brief Reads the pressure of the replay's current line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return lps25hData_s pressure data, not valid past the end of the log
+*/
+static lps25hData_s GhBackendReplayLPS25H(void)
+{
+    lps25hData_s lp = {0};
+    if(replayrow >= 0 && replayrow < replaybatch->n)
+    {
+        lp.temperature = replaybatch->temperature[replayrow];
+        lp.pressure = replaybatch->pressure[replayrow];
+        lp.valid = 1;
+    }
+    return lp;
+}
+
+static const shsensors_s bkplantsensors = {"plant model", NULL, 0, GhBackendPlantOpen, GhBackendNoClose,
+    GhBackendPlantHTS221, GhBackendPlantLPS25H, NULL, NULL};
+static const shsensors_s bkreplaysensors = {"log replay", NULL, 0, GhBackendReplayOpen, GhBackendReplayClose,
+    GhBackendReplayHTS221, GhBackendReplayLPS25H, NULL, NULL};
+
+static const ghbackend_s backends[] =
+{
+    {"hardware",&shi2csensors,&shfbdisplay,&actgpiochip},
+    {"emulator",&shemusensors,&shemudisplay,&actfakechip},
+    {"simulator",&bkplantsensors,&shnodisplay,&actfakechip},
+    {"simbus",&shsimsensors,&shnodisplay,&actfakechip},
+    {"replay",&bkreplaysensors,&shnodisplay,&actfakechip},
+};
+#define BKCOUNT ((int)(sizeof(backends) / sizeof(backends[0])))
+
+/** @brief Looks up a backend profile, opening the log for a replay
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param spec profile name, or BKREPLAY followed by a log file name
+ *  @return const ghbackend_s pointer, NULL for an unknown profile or an unreadable log
+*/
+const ghbackend_s * GhBackendSelect(const char * spec)
+{
+    int k;
+
+    if(strncmp(spec,BKREPLAY,strlen(BKREPLAY)) == 0)
+    {
+        replayname = spec + strlen(BKREPLAY);
+        replay = (logstream_s *) malloc(sizeof(logstream_s));
+        replaybatch = (logbatch_s *) malloc(sizeof(logbatch_s));
+        if(replay == NULL || replaybatch == NULL || !GhLogOpen(replay,replayname))
+        {
+            perror(replayname);
+            free(replay);
+            free(replaybatch);
+            replay = NULL;
+            replaybatch = NULL;
+            return NULL;
+        }
+        spec = "replay";
+    }
+    else if(strcmp(spec,"replay") == 0)
+    {
+        spec = "";              // needs a log
+    }
+    for(k=0; k<BKCOUNT; k++)
+    {
+        if(strcmp(spec,backends[k].name) == 0)
+        {
+            return &backends[k];
+        }
+    }
+    fprintf(stderr,"Unknown backend, choose one of:");
+    for(k=0; k<BKCOUNT; k++)
+    {
+        fprintf(stderr," %s%s",backends[k].name,(strcmp(backends[k].name,"replay") == 0) ? ":<log>" : "");
+    }
+    fprintf(stderr,"\n");
+    return NULL;
+}
+
+/** @brief Lets the plant model see the relays
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param act pointer to opened actuators
+ *  @return void
+*/
+void GhBackendAttach(ghact_s * act)
+{
+    __atomic_store_n(&relays,act,__ATOMIC_RELEASE);
+}
+
+/** @brief Prints what a backend runs against
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param be pointer to backend
+ *  @return void
+*/
+void GhBackendDisplay(const ghbackend_s * be)
+{
+    fprintf(stdout,"Backend %s%s%s: sensors %s, display %s, relays %s\n",be->name,
+        (be->sensors == &bkreplaysensors) ? " of " : "",(be->sensors == &bkreplaysensors) ? replayname : "",
+        be->sensors->name,be->display->name,be->actuators->name);
+}
+
+/** @brief Times one pass of plant model sensor calls, made directly or through the sensor table
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param sensor TEMPERATURE for the HTS221 call, PRESSURE for the LPS25H call
+ *  @param table 1 to call through ShGetHT221SData() or ShGetLPS25HData() as the controller does
+ *  @return double ns per call
+*/
+static double GhBackendTime(int sensor, int table)
+{
+    int i;
+    int64_t t0;
+    volatile double sink;   // keeps the timed calls from being optimised away
+
+    t0 = GhBackendNowNs();
+    if(sensor == TEMPERATURE && table)
+    {
+        for(i=0; i<BKBENCHN; i++)
+        {
+            sink = ShGetHT221SData().temperature;
+        }
+    }
+    else if(sensor == TEMPERATURE)
+    {
+        for(i=0; i<BKBENCHN; i++)
+        {
+            sink = GhBackendPlantHTS221().temperature;
+        }
+    }
+    else if(table)
+    {
+        for(i=0; i<BKBENCHN; i++)
+        {
+            sink = ShGetLPS25HData().pressure;
+        }
+    }
+    else
+    {
+        for(i=0; i<BKBENCHN; i++)
+        {
+            sink = GhBackendPlantLPS25H().pressure;
+        }
+    }
+    (void) sink;
+    return (GhBackendNowNs() - t0) / (double) BKBENCHN;
+}
+
+/** @brief Times the plant model sensors called directly, as a compile-time backend would, and through the backend table
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if the table adds less than BKBENCHMAXNS to a reading, 0 otherwise
+*/
+int GhBackendReport(FILE * fp)
+{
+    static const struct
+    {
+        const char * name;
+        int sensor;
+    } calls[] = {{"hts221",TEMPERATURE},{"lps25h",PRESSURE}};
+    int ncalls = (int)(sizeof(calls) / sizeof(calls[0]));
+    int c;
+    int rep;
+    int table;
+    int ok;
+    double ns[2];
+    double t;
+    double added = 0.0;
+    char what[64];
+
+    ShSelect(&bkplantsensors,&shnodisplay);
+    if(ShSensorInit() == EXIT_FAILURE)
+    {
+        fprintf(fp,"Cannot open the plant model sensors\n");
+        return 0;
+    }
+    fprintf(fp,"Backend dispatch, %s sensors, %d calls per pass, fastest of %d passes\n",bkplantsensors.name,BKBENCHN,BKBENCHREPS);
+    fprintf(fp,"%-10s %12s %12s %12s\n","Call","direct ns","table ns","added ns");
+    for(c=0; c<ncalls; c++)
+    {
+        ns[0] = INFINITY;
+        ns[1] = INFINITY;
+        for(rep=0; rep<BKBENCHREPS; rep++)
+        {
+            for(table=0; table<2; table++)
+            {
+                t = GhBackendTime(calls[c].sensor,table);
+                ns[table] = (t < ns[table]) ? t : ns[table];
+            }
+        }
+        fprintf(fp,"%-10s %12.1lf %12.1lf %+12.1lf\n",calls[c].name,ns[0],ns[1],ns[1] - ns[0]);
+        added += ns[1] - ns[0];
+    }
+    ShExit();
+    snprintf(what,sizeof(what),"tables add %+.1lf ns to a reading, %.1e of the period",added,added / (GHUPDATE * 1e6));
+    ok = added < BKBENCHMAXNS;
+    fprintf(fp,"%-60s %s\n",what,ok ? "ok" : "FAILED");
+    return ok;
+}
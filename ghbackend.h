@@ -0,0 +1,51 @@
+/** @brief Gh backend profile constants, structures, function prototypes
+*   @file ghbackend.h
+*
+*   A backend is the sensors, display and relay chip the controller runs
+*   against, picked by name at startup with -b rather than at compile time,
+*   so one binary runs on the Pi, on the emulator and on a desk:
+*
+*     hardware        Sense Hat on i2c-dev, LED framebuffer, gpiochip relays
+*     emulator        sense_emu sensors and display, fake relays
+*     simulator       the ghplant.c greenhouse, driven by the fake relays
+*     simbus          the register-level driver on the simulated bus
+*     replay:<log>    a recorded data log, one line per reading
+*
+*   The plant model runs in real time (BKSIMSPEED) and starts at the local
+*   time of day. The replay is read a chunk at a time and its readings go
+*   stale at the end of the log.
+*/
+#ifndef GHBACKEND_H
+#define GHBACKEND_H
+
+// Includes
+#include "ghcontrol.h"
+#include "ghactuator.h"
+
+// Backend Constants
+#define BKDEFAULT "hardware"
+#define BKREPLAY "replay:"
+#define BKSIMSPEED 1.0          // simulated seconds per second
+#define BKSIMMAXSTEP 3600.0     // s simulated at most per reading, so a stopped process does not stall on resume
+#define BKBENCHN 1000000        // sensor calls GhBackendReport() times per pass
+#define BKBENCHREPS 7           // passes per call path, taken in turn with the other path, the fastest kept
+#define BKBENCHMAXNS 1000.0     // ns the tables may add to a reading, 5e-7 of GHUPDATE
+
+//Typedefs
+typedef struct ghbackend
+{
+    const char * name;
+    const shsensors_s * sensors;
+    const shdisplay_s * display;
+    const actchip_s * actuators;
+}ghbackend_s;
+
+// Function Prototypes
+///@cond INTERNAL
+const ghbackend_s * GhBackendSelect(const char * spec);
+void GhBackendAttach(ghact_s * act);
+void GhBackendDisplay(const ghbackend_s * be);
+int GhBackendReport(FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,407 @@
+/** @brief Gh batch control and alarm kernels
+*   @file ghbatch.c
+*
+*   Branchless versions of GhSetControls() and GhSetAlarms() that work on
+*   arrays of readings (replayed logs, many zones). Each sample gets a
+*   control bitmap (CTRLHEATER, CTRLHUMIDIFIER) and an alarm bitmask
+*   (ALARMBIT(code)) that match the scalar comparisons exactly.
+*/
+#include "ghbatch.h"
+
+#if defined(__AVX__)
+ #include <immintrin.h>
+ #define GHLANES 4
+ #define GHKERNEL "AVX"
+#elif defined(__SSE2__)
+ #include <emmintrin.h>
+ #define GHLANES 2
+ #define GHKERNEL "SSE2"
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+ #include <arm_neon.h>
+ #define GHLANES 2
+ #define GHKERNEL "NEON"
+ #define GHNEONMASK(m) ((int)((vgetq_lane_u64((m),0) & 1) | ((vgetq_lane_u64((m),1) & 1) << 1)))
+#else
+ #define GHLANES 1
+ #define GHKERNEL "scalar"
+#endif
+
+/** @brief Packs per-lane comparison masks into control bitmaps
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param cbits pointer to first output bitmap
+ *  @param lanes number of lanes in the masks
+ *  @param heat heater mask, one bit per lane
+ *  @param humid humidifier mask, one bit per lane
+ *  @return void
+*/
+static inline void GhStoreControlLanes(uint8_t * cbits, int lanes, int heat, int humid)
+{
+    int l;
+    for(l=0; l<lanes; l++)
+    {
+        cbits[l] = (uint8_t)((((heat >> l) & 1) * CTRLHEATER) | (((humid >> l) & 1) * CTRLHUMIDIFIER));
+    }
+}
+
+/** @brief Packs per-lane comparison masks into alarm bitmasks
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param abits pointer to first output bitmask
+ *  @param lanes number of lanes in the masks
+ *  @param m array of masks indexed by alarm_e code, one bit per lane
+ *  @return void
+*/
+static inline void GhStoreAlarmLanes(uint16_t * abits, int lanes, const int * m)
+{
+    int l;
+    int code;
+    uint16_t bits;
+    for(l=0; l<lanes; l++)
+    {
+        bits = 0;
+        for(code=HTEMP; code<=LPRESS; code++)
+        {
+            bits |= (uint16_t)(((m[code] >> l) & 1) << code);
+        }
+        abits[l] = bits;
+    }
+}
+
+/** @brief Converts a control structure to a control bitmap
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctrl object of controls type
+ *  @return uint8_t control bitmap
+*/
+uint8_t GhControlBits(control_s ctrl)
+{
+    return (uint8_t)(((ctrl.heateron == ON) * CTRLHEATER) | ((ctrl.humidifieron == ON) * CTRLHUMIDIFIER));
+}
+
+/** @brief Converts an alarm list to an alarm bitmask
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param head pointer to alarm_s list
+ *  @return uint16_t alarm bitmask
+*/
+uint16_t GhAlarmBits(alarm_s * head)
+{
+    uint16_t bits = 0;
+    alarm_s * cur;
+    for(cur = head; cur != NULL; cur = cur->next)
+    {
+        if(cur->code != NOALARM)
+        {
+            bits |= ALARMBIT(cur->code);
+        }
+    }
+    return bits;
+}
+
+/** @brief Computes the alarm bitmask for one reading
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param alarmpt object of alarm limits type
+ *  @param rdata object of readings type
+ *  @return uint16_t alarm bitmask
+*/
+uint16_t GhAlarmMask(alarmlimit_s alarmpt, reading_s rdata)
+{
+    uint16_t abits;
+    GhSetAlarmsBatch(alarmpt,&rdata.temperature,&rdata.humidity,&rdata.pressure,&abits,1);
+    return abits;
+}
+
+/** @brief Sets Heater/Humidifier control bitmaps for an array of readings
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param target object of setpoints (targets) data
+ *  @param temperature array of n temperatures
+ *  @param humidity array of n humidities
+ *  @param cbits array of n control bitmaps to fill
+ *  @param n number of samples
+ *  @return void
+*/
+void GhSetControlsBatch(setpoint_s target, const double * temperature, const double * humidity, uint8_t * cbits, size_t n)
+{
+    size_t i = 0;
+#if defined(__AVX__)
+    __m256d st = _mm256_set1_pd(target.temperature);
+    __m256d sh = _mm256_set1_pd(target.humidity);
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        GhStoreControlLanes(cbits+i,GHLANES,
+            _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(temperature+i),st,_CMP_LT_OQ)),
+            _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(humidity+i),sh,_CMP_LT_OQ)));
+    }
+#elif defined(__SSE2__)
+    __m128d st = _mm_set1_pd(target.temperature);
+    __m128d sh = _mm_set1_pd(target.humidity);
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        GhStoreControlLanes(cbits+i,GHLANES,
+            _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(temperature+i),st)),
+            _mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(humidity+i),sh)));
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    float64x2_t st = vdupq_n_f64(target.temperature);
+    float64x2_t sh = vdupq_n_f64(target.humidity);
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        GhStoreControlLanes(cbits+i,GHLANES,
+            GHNEONMASK(vcltq_f64(vld1q_f64(temperature+i),st)),
+            GHNEONMASK(vcltq_f64(vld1q_f64(humidity+i),sh)));
+    }
+#endif
+    for(; i<n; i++)
+    {
+        GhStoreControlLanes(cbits+i,1,temperature[i] < target.temperature,humidity[i] < target.humidity);
+    }
+}
+
+/** @brief Sets alarm bitmasks for an array of readings
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param alarmpt object of alarm limits type
+ *  @param temperature array of n temperatures
+ *  @param humidity array of n humidities
+ *  @param pressure array of n pressures
+ *  @param abits array of n alarm bitmasks to fill
+ *  @param n number of samples
+ *  @return void
+*/
+void GhSetAlarmsBatch(alarmlimit_s alarmpt, const double * temperature, const double * humidity, const double * pressure, uint16_t * abits, size_t n)
+{
+    size_t i = 0;
+    int m[NALARMS] = {0};
+#if defined(__AVX__)
+    __m256d ht = _mm256_set1_pd(alarmpt.hight);
+    __m256d lt = _mm256_set1_pd(alarmpt.lowt);
+    __m256d hh = _mm256_set1_pd(alarmpt.highh);
+    __m256d lh = _mm256_set1_pd(alarmpt.lowh);
+    __m256d hp = _mm256_set1_pd(alarmpt.highp);
+    __m256d lp = _mm256_set1_pd(alarmpt.lowp);
+    __m256d t,h,p;
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        t = _mm256_loadu_pd(temperature+i);
+        h = _mm256_loadu_pd(humidity+i);
+        p = _mm256_loadu_pd(pressure+i);
+        m[HTEMP] = _mm256_movemask_pd(_mm256_cmp_pd(t,ht,_CMP_GE_OQ));
+        m[LTEMP] = _mm256_movemask_pd(_mm256_cmp_pd(t,lt,_CMP_LE_OQ));
+        m[HHUMID] = _mm256_movemask_pd(_mm256_cmp_pd(h,hh,_CMP_GE_OQ));
+        m[LHUMID] = _mm256_movemask_pd(_mm256_cmp_pd(h,lh,_CMP_LE_OQ));
+        m[HPRESS] = _mm256_movemask_pd(_mm256_cmp_pd(p,hp,_CMP_GE_OQ));
+        m[LPRESS] = _mm256_movemask_pd(_mm256_cmp_pd(p,lp,_CMP_LE_OQ));
+        GhStoreAlarmLanes(abits+i,GHLANES,m);
+    }
+#elif defined(__SSE2__)
+    __m128d ht = _mm_set1_pd(alarmpt.hight);
+    __m128d lt = _mm_set1_pd(alarmpt.lowt);
+    __m128d hh = _mm_set1_pd(alarmpt.highh);
+    __m128d lh = _mm_set1_pd(alarmpt.lowh);
+    __m128d hp = _mm_set1_pd(alarmpt.highp);
+    __m128d lp = _mm_set1_pd(alarmpt.lowp);
+    __m128d t,h,p;
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        t = _mm_loadu_pd(temperature+i);
+        h = _mm_loadu_pd(humidity+i);
+        p = _mm_loadu_pd(pressure+i);
+        // x >= limit is written as limit <= x so NaN compares false like the scalar path
+        m[HTEMP] = _mm_movemask_pd(_mm_cmple_pd(ht,t));
+        m[LTEMP] = _mm_movemask_pd(_mm_cmple_pd(t,lt));
+        m[HHUMID] = _mm_movemask_pd(_mm_cmple_pd(hh,h));
+        m[LHUMID] = _mm_movemask_pd(_mm_cmple_pd(h,lh));
+        m[HPRESS] = _mm_movemask_pd(_mm_cmple_pd(hp,p));
+        m[LPRESS] = _mm_movemask_pd(_mm_cmple_pd(p,lp));
+        GhStoreAlarmLanes(abits+i,GHLANES,m);
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    float64x2_t ht = vdupq_n_f64(alarmpt.hight);
+    float64x2_t lt = vdupq_n_f64(alarmpt.lowt);
+    float64x2_t hh = vdupq_n_f64(alarmpt.highh);
+    float64x2_t lh = vdupq_n_f64(alarmpt.lowh);
+    float64x2_t hp = vdupq_n_f64(alarmpt.highp);
+    float64x2_t lp = vdupq_n_f64(alarmpt.lowp);
+    float64x2_t t,h,p;
+    for(; i+GHLANES <= n; i += GHLANES)
+    {
+        t = vld1q_f64(temperature+i);
+        h = vld1q_f64(humidity+i);
+        p = vld1q_f64(pressure+i);
+        m[HTEMP] = GHNEONMASK(vcgeq_f64(t,ht));
+        m[LTEMP] = GHNEONMASK(vcleq_f64(t,lt));
+        m[HHUMID] = GHNEONMASK(vcgeq_f64(h,hh));
+        m[LHUMID] = GHNEONMASK(vcleq_f64(h,lh));
+        m[HPRESS] = GHNEONMASK(vcgeq_f64(p,hp));
+        m[LPRESS] = GHNEONMASK(vcleq_f64(p,lp));
+        GhStoreAlarmLanes(abits+i,GHLANES,m);
+    }
+#endif
+    for(; i<n; i++)
+    {
+        m[HTEMP] = temperature[i] >= alarmpt.hight;
+        m[LTEMP] = temperature[i] <= alarmpt.lowt;
+        m[HHUMID] = humidity[i] >= alarmpt.highh;
+        m[LHUMID] = humidity[i] <= alarmpt.lowh;
+        m[HPRESS] = pressure[i] >= alarmpt.highp;
+        m[LPRESS] = pressure[i] <= alarmpt.lowp;
+        GhStoreAlarmLanes(abits+i,1,m);
+    }
+}
+
+/** @brief Fills one benchmark channel around its alarm limits
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param x array of n values to fill
+ *  @param n number of samples
+ *  @param low lower alarm limit
+ *  @param high upper alarm limit
+ *  @param seed pointer to generator state
+ *  @return void
+*/
+static void GhBatchFill(double * x, size_t n, double low, double high, uint64_t * seed)
+{
+    size_t i;
+    double span = high - low;
+    for(i=0; i<n; i++)
+    {
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 7;
+        *seed ^= *seed << 17;
+        x[i] = low - span * 0.25 + span * 1.5 * (double)(*seed >> 11) / 9007199254740992.0;
+        // Exact limits and missing readings are where the kernels could disagree
+        if(i % 97 == 0)
+        {
+            x[i] = (i % 194 == 0) ? low : high;
+        }
+        else if(i % 1009 == 0)
+        {
+            x[i] = NAN;
+        }
+    }
+}
+
+/** @brief Reads the monotonic clock in seconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return double seconds
+*/
+static double GhBatchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** @brief Times the batch kernels against the scalar control and alarm path and checks they agree
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param spts setpoints
+ *  @param limits alarm limits
+ *  @param fp output stream
+ *  @return int 1 if every sample matched, 0 otherwise
+*/
+int GhBatchReport(setpoint_s spts, alarmlimit_s limits, FILE * fp)
+{
+    size_t i;
+    size_t bad = 0;
+    int rep;
+    double t0;
+    double secs[4];
+    double * t = (double *) malloc(SENSORS * BATCHBENCHN * sizeof(double));
+    double * h;
+    double * p;
+    uint8_t * cbits = (uint8_t *) malloc(2 * BATCHBENCHN * sizeof(uint8_t));
+    uint8_t * cref;
+    uint16_t * abits = (uint16_t *) malloc(2 * BATCHBENCHN * sizeof(uint16_t));
+    uint16_t * aref;
+    alarm_s * head = (alarm_s *) calloc(1,sizeof(alarm_s));
+    alarm_s * next;
+    reading_s rd = {0};
+    uint64_t seed = BATCHBENCHSEED;
+    const char * names[4] = {"controls","alarms","controls","alarms"};
+
+    if(t == NULL || cbits == NULL || abits == NULL || head == NULL)
+    {
+        fprintf(fp,"Cannot allocate memory\n");
+        free(t);
+        free(cbits);
+        free(abits);
+        free(head);
+        return 0;
+    }
+    h = t + BATCHBENCHN;
+    p = h + BATCHBENCHN;
+    cref = cbits + BATCHBENCHN;
+    aref = abits + BATCHBENCHN;
+    GhBatchFill(t,BATCHBENCHN,limits.lowt,limits.hight,&seed);
+    GhBatchFill(h,BATCHBENCHN,limits.lowh,limits.highh,&seed);
+    GhBatchFill(p,BATCHBENCHN,limits.lowp,limits.highp,&seed);
+
+    // The scalar path is what the control loop runs for each reading
+    t0 = GhBatchNow();
+    for(rep=0; rep<BATCHBENCHREPS; rep++)
+    {
+        for(i=0; i<BATCHBENCHN; i++)
+        {
+            rd.temperature = t[i];
+            rd.humidity = h[i];
+            cref[i] = GhControlBits(GhSetControls(spts,rd));
+        }
+    }
+    secs[2] = GhBatchNow() - t0;
+    t0 = GhBatchNow();
+    for(rep=0; rep<BATCHBENCHREPS; rep++)
+    {
+        for(i=0; i<BATCHBENCHN; i++)
+        {
+            rd.temperature = t[i];
+            rd.humidity = h[i];
+            rd.pressure = p[i];
+            head = GhSetAlarms(head,limits,rd);
+            aref[i] = GhAlarmBits(head);
+        }
+    }
+    secs[3] = GhBatchNow() - t0;
+    t0 = GhBatchNow();
+    for(rep=0; rep<BATCHBENCHREPS; rep++)
+    {
+        GhSetControlsBatch(spts,t,h,cbits,BATCHBENCHN);
+    }
+    secs[0] = GhBatchNow() - t0;
+    t0 = GhBatchNow();
+    for(rep=0; rep<BATCHBENCHREPS; rep++)
+    {
+        GhSetAlarmsBatch(limits,t,h,p,abits,BATCHBENCHN);
+    }
+    secs[1] = GhBatchNow() - t0;
+    for(i=0; i<BATCHBENCHN; i++)
+    {
+        bad += (cbits[i] != cref[i]) || (abits[i] != aref[i]);
+    }
+
+    fprintf(fp,"Batch kernels, %s with %d lanes, %d samples x %d passes\n",GHKERNEL,GHLANES,BATCHBENCHN,BATCHBENCHREPS);
+    fprintf(fp,"%-8s %-9s %14s %10s\n","path","kernel","samples/s","ns/sample");
+    for(rep=0; rep<4; rep++)
+    {
+        fprintf(fp,"%-8s %-9s %14.0lf %10.2lf\n",(rep < 2) ? "batch" : "scalar",names[rep],
+            BATCHBENCHN * (double) BATCHBENCHREPS / secs[rep],secs[rep] * 1e9 / (BATCHBENCHN * (double) BATCHBENCHREPS));
+    }
+    fprintf(fp,"Speedup: controls %.1lfx, alarms %.1lfx\n",secs[2] / secs[0],secs[3] / secs[1]);
+    fprintf(fp,"Mismatches against the scalar path: %zu of %d\n",bad,BATCHBENCHN);
+
+    while(head != NULL)
+    {
+        next = head->next;
+        free(head);
+        head = next;
+    }
+    free(t);
+    free(cbits);
+    free(abits);
+    return bad == 0;
+}
@@ -0,0 +1,33 @@
+/** @brief Gh batch control and alarm kernels
+*   @file ghbatch.h
+*/
+#ifndef GHBATCH_H
+#define GHBATCH_H
+
+// Includes
+#include <stddef.h>
+#include "ghcontrol.h"
+
+// Control Bitmap Constants
+#define CTRLHEATER 0x01
+#define CTRLHUMIDIFIER 0x02
+
+// Alarm Bitmask Constants (one bit per alarm_e code)
+#define ALARMBIT(code) (1u << (code))
+
+// Benchmark Constants
+#define BATCHBENCHN 65537       // samples, odd so the scalar tail runs too
+#define BATCHBENCHREPS 50
+#define BATCHBENCHSEED 20261018u
+
+// Function Prototypes
+///@cond INTERNAL
+uint8_t GhControlBits(control_s ctrl);
+uint16_t GhAlarmBits(alarm_s * head);
+uint16_t GhAlarmMask(alarmlimit_s alarmpt, reading_s rdata);
+void GhSetControlsBatch(setpoint_s target, const double * temperature, const double * humidity, uint8_t * cbits, size_t n);
+void GhSetAlarmsBatch(alarmlimit_s alarmpt, const double * temperature, const double * humidity, const double * pressure, uint16_t * abits, size_t n);
+int GhBatchReport(setpoint_s spts, alarmlimit_s limits, FILE * fp);
+///@endcond
+
+#endif
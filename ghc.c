@@ -3,38 +3,493 @@
  * @file ghc.c
  * */
 #include "ghcontrol.h"
+#include "ghbatch.h"
+#include "ghhistory.h"
+#include "ghcompress.h"
+#include "ghstats.h"
+#include "ghreplay.h"
+#include "ghshm.h"
+#include "ghserver.h"
+#include "ghevent.h"
+#include "ghconfig.h"
+#include "ghcheckpoint.h"
+#include "ghfilter.h"
+#include "ghsched.h"
+#include "ghplant.h"
+#include "ghpid.h"
+#include "ghactuator.h"
+#include "ghpredict.h"
+#include "ghderive.h"
+#include "ghmatrix.h"
+#include "ghstartup.h"
+#include "ghpress.h"
+#include "ghupload.h"
+#include "ghbackend.h"
 
-int main(void)
+int main(int argc, char * argv[])
 {
-    int logged;
+    int logged = 1;
+    int running = 1;
+    int k;
+    int n;
+    int sig;
+    int period = GHUPDATE;
+    int next;
+    int started = 0;
+    int ph;
+    int ok = 0;
+    double hours;
+    size_t len;
+    uint64_t expiries;
+    uint64_t missed = 0;
 	control_s ctrl = {0};
 	reading_s creadings = {0};
+	reading_s live;
+	reading_s raw = {0};
+	reading_s * stream;
 	setpoint_s sets = {0};
+	alarmlimit_s alimits;
 	alarm_s * arecord;
+	alarm_s * anext;
+	history_s * hist;
+	cring_s * cring;
+	stats_s * stats;
+	ghshm_s * shm = NULL;
+	ghsnapshot_s snap = {0};
+	ghserver_s * srv = NULL;
+	ghevent_s ev;
+	evsource_e ready[EVTMAXEVENTS];
+	ghconfigctl_s cfgctl;
+	ghconfig_s replaycfg;
+	const ghconfig_s * cfg;
+	ghcheckpoint_s ckpt;
+	ckptwriter_s * cw;
+	int64_t ckptdue;
+	int restored = 0;
+	ghfilter_s filter;
+	sched_s sched;
+	ghpid_s pid;
+	ghact_s act;
+	ghpredict_s pred;
+	derived_s drv = {0};
+	ghmatrix_s mx;
+	ghstartup_s st;
+	ghpress_s press;
+	ghupload_s * up = NULL;
+	const char * collector = NULL;
+	const char * backend = BKDEFAULT;
+	const ghbackend_s * be;
+	struct timespec t0,t1;
+    GhStartupInit(&st);
     arecord = (alarm_s *) calloc(1,sizeof(alarm_s));
-    if(arecord == NULL)
+    hist = (history_s *) calloc(1,sizeof(history_s));
+    cring = (cring_s *) calloc(1,sizeof(cring_s));
+    stats = (stats_s *) calloc(1,sizeof(stats_s));
+    cw = (ckptwriter_s *) calloc(1,sizeof(ckptwriter_s));
+    if(arecord == NULL || hist == NULL || cring == NULL || stats == NULL || cw == NULL)
     {
         printf("\nCannot allocate memory\n");
         return EXIT_FAILURE;
     }
+	ph = GhStartupBegin(&st,"targets",STMAIN);
 	sets = GhSetTargets();
-	alarmlimit_s alimits = GhSetAlarmLimits();
+	alimits = GhSetAlarmLimits();
+	GhStartupEnd(&st,ph);
+	if(argc == 3 && strcmp(argv[1],"-r") == 0)
+	{
+		// Replay a recorded log instead of reading the sensors
+		replaycfg.version = 0;
+		replaycfg.spts = sets;
+		replaycfg.vpd = 0.0;
+		replaycfg.limits = alimits;
+		if(GhConfigParse(CONFIGFILE,&replaycfg,&replaycfg))
+		{
+			sets = replaycfg.spts;
+			alimits = replaycfg.limits;
+		}
+		return (GhReplay(argv[2],sets,alimits,stdout) < 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+	}
+	if(argc == 3 && strcmp(argv[1],"-p") == 0)
+	{
+		// Compare fixed and adaptive sampling against the plant simulator
+		return GhPlantReport(atof(argv[2]),sets,alimits,stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(argc == 4 && strcmp(argv[1],"-m") == 0)
+	{
+		// Render the matrix dashboard from the plant simulator into a file
+		return GhMatrixReport(argv[2],atof(argv[3]),sets,alimits,stdout) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if((argc == 3 || argc == 4) && strcmp(argv[1],"-t") == 0)
+	{
+		// Check one subsystem against its reference and report what it costs,
+		// the stream-driven ones on hours of plant simulator readings
+		hours = (argc == 4) ? atof(argv[3]) : PLANTSTREAMHOURS;
+		if(strcmp(argv[2],"batch") == 0)
+		{
+			ok = GhBatchReport(sets,alimits,stdout);
+		}
+		else if(strcmp(argv[2],"compress") == 0)
+		{
+			stream = GhPlantStream(hours,sets,alimits,&len);
+			ok = stream != NULL && GhCRingReport(stream,len,stdout);
+			free(stream);
+		}
+		else if(strcmp(argv[2],"stats") == 0)
+		{
+			stream = GhPlantStream(hours,sets,alimits,&len);
+			ok = stream != NULL && GhStatsReport(stream,len,stdout);
+			free(stream);
+		}
+		else if(strcmp(argv[2],"simbus") == 0)
+		{
+			ok = ShSimBusReport(stdout);
+		}
+		else if(strcmp(argv[2],"shm") == 0)
+		{
+			ok = GhShmReport(stdout);
+		}
+		else if(strcmp(argv[2],"config") == 0)
+		{
+			ok = GhConfigReport(stdout);
+		}
+		else if(strcmp(argv[2],"filter") == 0)
+		{
+			ok = GhFilterReport(stdout);
+		}
+		else if(strcmp(argv[2],"convert") == 0)
+		{
+			ok = ShConvertReport(stdout);
+		}
+		else if(strcmp(argv[2],"relays") == 0)
+		{
+			ok = GhActReport(stdout);
+		}
+		else if(strcmp(argv[2],"press") == 0)
+		{
+			ok = GhPressReport(stdout);
+		}
+		else if(strcmp(argv[2],"backend") == 0)
+		{
+			ok = GhBackendReport(stdout);
+		}
+		else
+		{
+			fprintf(stderr,"Unknown test, choose one of: batch compress stats simbus shm config filter convert relays press backend [hours]\n");
+		}
+		return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	for(k=1; k+1<argc; k+=2)
+	{
+		// Run as usual, uploading to this collector or against this backend
+		if(strcmp(argv[k],"-u") == 0)
+		{
+			collector = argv[k + 1];
+		}
+		else if(strcmp(argv[k],"-b") == 0)
+		{
+			backend = argv[k + 1];
+		}
+	}
+	ph = GhStartupBegin(&st,"backend",STMAIN);
+	be = GhBackendSelect(backend);
+	if(be == NULL)
+	{
+		return EXIT_FAILURE;
+	}
+	ShSelect(be->sensors,be->display);
+	GhBackendDisplay(be);
+	GhStartupEnd(&st,ph);
+	ph = GhStartupBegin(&st,"event loop",STMAIN);
+	if(!GhEventInit(&ev,GHUPDATE))
+	{
+		return EXIT_FAILURE;
+	}
 	GhControllerInit();
-	while (1)
-	{
-		creadings = GhGetReadings();
-		logged = GhLogData("ghdata.txt",creadings);
-		ctrl = GhSetControls(sets,creadings);
-		arecord = GhSetAlarms(arecord,alimits,creadings);
-		GhDisplayAll(creadings,sets);
-		GhDisplayReadings(creadings);
-		GhDisplayTargets(sets);
-		GhDisplayControls(ctrl);
-		GhDisplayAlarms(arecord);
-		GhDelay (GHUPDATE);
-	}
-	fprintf(stdout,"Press ENTER to continue...");
-	getchar();
 
-	return EXIT_FAILURE;
+	// The sensors and the framebuffer come up on their own threads, started
+	// after GhEventInit() so they inherit the blocked signals
+	ShLPS25HFifoPeriod(period);
+	GhStartupSensors(&st);
+	GhStartupDisplay(&st);
+	GhHistoryInit(hist);
+	GhCRingInit(cring);
+	GhStatsInit(stats,NULL);
+	GhFilterInit(&filter);
+	GhSchedInit(&sched,SCHEDADAPTIVE);
+	GhPidInit(&pid,PIDENABLE);
+	GhPredictInit(&pred);
+	GhPressInit(&press);
+	GhStartupEnd(&st,ph);
+
+	// Warm restart: resume alarms, targets and statistics from the last checkpoint
+	ph = GhStartupBegin(&st,"checkpoint",STMAIN);
+	clock_gettime(CLOCK_MONOTONIC,&t0);
+	if(GhCheckpointLoad(CKPTFILE,&ckpt))
+	{
+		sets = ckpt.snap.spts;
+		alimits = ckpt.limits;
+		arecord = GhCheckpointAlarms(&ckpt,arecord);
+		snap.cycle = ckpt.snap.cycle;
+		restored = 1;
+		if(time(NULL) - ckpt.hdr.saved <= CKPTMAXAGE)
+		{
+			filter = ckpt.filter;
+			GhFilterPeriod(&filter,period / 1000.0);
+			memcpy(pid.loop,ckpt.loop,sizeof(pid.loop));
+		}
+		clock_gettime(CLOCK_MONOTONIC,&t1);
+		fprintf(stdout,"Restored checkpoint from cycle %llu in %.2lf ms\n",(unsigned long long) snap.cycle,
+			(t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+	}
+	clock_gettime(CLOCK_MONOTONIC,&t0);
+	k = GhStatsRebuild(stats,"ghdata.txt",time(NULL));
+	clock_gettime(CLOCK_MONOTONIC,&t1);
+	if(k > 0)
+	{
+		fprintf(stdout,"Rebuilt statistics from %d logged samples in %.2lf ms\n",k,
+			(t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+	}
+	else if(restored)
+	{
+		// Nothing recent in the log, so show what the windows held at the checkpoint
+		fprintf(stdout,"Statistics at the checkpoint:\n");
+		for(k=0; k<STATWINDOWS; k++)
+		{
+			GhDisplaySummary(ckpt.summary[k],stats->win[k].secs);
+		}
+	}
+	GhCheckpointStart(cw,CKPTFILE);
+	ckptdue = GhPidClock() + CKPTSECS * 1000;
+	GhStartupEnd(&st,ph);
+
+	// Started after GhEventInit() so the watcher inherits the blocked signals
+	ph = GhStartupBegin(&st,"config",STMAIN);
+	GhConfigStart(&cfgctl,CONFIGFILE,sets,alimits);
+	GhStartupEnd(&st,ph);
+	ph = GhStartupBegin(&st,"relays",STMAIN);
+	if(pid.enabled && GhPidStart(&pid))
+	{
+		GhEventAdd(&ev,pid.timerfd,EVOUTPUT);
+	}
+	if(GhActOpen(&act,be->actuators,ACTCHIP))
+	{
+		GhEventAdd(&ev,act.timerfd,EVACTUATOR);
+		GhBackendAttach(&act);
+	}
+	GhStartupEnd(&st,ph);
+	while (running)
+	{
+		n = GhEventWait(&ev,ready,EVTMAXEVENTS);
+		for(k=0; k<n && running; k++)
+		{
+			if(ready[k] == EVSIGNAL)
+			{
+				while((sig = GhEventSignal(&ev)) != 0)
+				{
+					if(sig == SIGHUP)
+					{
+						GhConfigReload(&cfgctl);
+					}
+					else
+					{
+						running = 0;
+					}
+				}
+			}
+			else if(ready[k] == EVSERVER)
+			{
+				GhServerPoll(srv,0);
+			}
+			else if(ready[k] == EVOUTPUT)
+			{
+				// Relay edges inside the time-proportioning window
+				ctrl = GhActApply(&act,GhPidTick(&pid),GhPidClock());
+			}
+			else if(ready[k] == EVACTUATOR)
+			{
+				// A change held back by the minimum on or off time is now allowed
+				ctrl = GhActTick(&act);
+			}
+			else if(ready[k] == EVMATRIX)
+			{
+				GhMatrixTick(&mx,GhPidClock());
+			}
+			else if(ready[k] == EVTIMER && (expiries = GhEventTimer(&ev)) > 0)
+			{
+				if(expiries > 1)
+				{
+					missed += expiries - 1;
+					fprintf(stderr,"Missed %llu update(s), %llu total\n",
+						(unsigned long long)(expiries - 1),(unsigned long long) missed);
+				}
+				cfg = GhConfigAcquire(&cfgctl);
+				sets = cfg->spts;
+				alimits = cfg->limits;
+				raw = started ? GhGetReadings() : GhStartupReading(&st);
+				creadings = GhFilterApply(&filter,raw);
+				live = GhLiveReadings(creadings);
+				GhDerivedSample(&drv,live);
+				if(cfg->vpd > 0)
+				{
+					sets.humidity = GhDerivedHumidityFor(&drv,cfg->vpd,sets.humidity);
+				}
+				GhPredictUpdate(&pred,creadings,GhPidClock());
+				ctrl = GhActApply(&act,GhPidUpdate(&pid,sets,PREDCONTROL ? GhPredictControl(&pred,creadings) : creadings,GhPidClock()),GhPidClock());
+				if(!started)
+				{
+					// The first decision is on the relays; now bring up what only reports on it
+					GhStartupDecision(&st);
+					ph = GhStartupBegin(&st,"matrix",STMAIN);
+					GhStartupJoin(&st,STDISPLAY);
+					if(GhMatrixOpen(&mx,NULL) && GhMatrixStart(&mx))
+					{
+						GhEventAdd(&ev,mx.timerfd,EVMATRIX);
+					}
+					GhStartupEnd(&st,ph);
+					ph = GhStartupBegin(&st,"snapshot",STMAIN);
+					shm = GhShmCreate();
+					GhStartupEnd(&st,ph);
+					ph = GhStartupBegin(&st,"server",STMAIN);
+					srv = (ghserver_s *) calloc(1,sizeof(ghserver_s));
+					if(srv != NULL && GhServerInit(srv,hist))
+					{
+						GhEventAdd(&ev,srv->epfd,EVSERVER);
+					}
+					else
+					{
+						free(srv);
+						srv = NULL;
+					}
+					GhStartupEnd(&st,ph);
+#if UPLOAD
+					if(collector != NULL)
+					{
+						ph = GhStartupBegin(&st,"uploader",STMAIN);
+						up = (ghupload_s *) calloc(1,sizeof(ghupload_s));
+						if(up != NULL && !GhUploadStart(up,collector,UPOUTBOX))
+						{
+							free(up);
+							up = NULL;
+						}
+						GhStartupEnd(&st,ph);
+					}
+#endif
+					GhStartupReport(&st,stdout);
+					started = 1;
+				}
+				if(creadings.stale != (1 << SENSORS) - 1)
+				{
+					// Held values are not new samples: failed channels go in as NAN, the rest as read
+					if(GhLogData("ghdata.txt",live,&drv) != logged)
+					{
+						// Say so once when logging stops, and once when it resumes
+						logged = !logged;
+						fprintf(stderr,logged ? "Logging to ghdata.txt resumed\n" : "Warning: cannot write ghdata.txt, samples are not being logged\n");
+					}
+					GhHistoryAdd(hist,live);
+					GhCRingAdd(cring,live);
+					GhStatsAdd(stats,live);
+				}
+				GhPressBatch(&press,GhGetPressureBatch(),raw.rtime);
+				arecord = GhSetAlarms(arecord,alimits,creadings);
+				arecord = GhDerivedAlarms(arecord,alimits,&drv);
+				GhPredictAlarms(&pred,alimits,creadings,PREDHORIZON);
+				GhShmSnapshot(&snap,creadings,sets,ctrl,arecord,pred.predicted,pred.eta);
+				if(up != NULL)
+				{
+					GhUploadSample(up,&snap);
+				}
+				if(GhPidClock() >= ckptdue)
+				{
+					// By time, as the sampling period adapts; the writer thread does the fsyncs
+					GhCheckpointPost(cw,&snap,alimits,stats,&filter,&pid);
+					ckptdue = GhPidClock() + CKPTSECS * 1000;
+				}
+				if(shm != NULL)
+				{
+					GhShmPublish(shm,&snap);
+				}
+				if(srv != NULL)
+				{
+					GhServerPublish(srv,&snap);
+				}
+				if(mx.fb != NULL)
+				{
+					GhMatrixUpdate(&mx,hist,&snap,alimits,GhPidClock());
+				}
+				else
+				{
+					GhDisplayAll(creadings,sets);
+				}
+				GhDisplayReadings(creadings);
+				GhDerivedDisplay(&drv);
+				GhPressDisplay(&press);
+				GhDisplayStats(stats);
+				GhDisplayTargets(sets);
+				GhDisplayControls(ctrl);
+				GhActDisplay(&act);
+				GhDisplayAlarms(arecord);
+				GhPredictDisplay(&pred);
+				GhMatrixDisplay(&mx);
+				if(up != NULL)
+				{
+					GhUploadDisplay(up);
+				}
+
+				// Raw readings, so the filter's lag does not hide a sudden change
+				next = GhSchedNext(&sched,raw,alimits);
+				if(next != period && GhEventPeriod(&ev,next))
+				{
+					period = next;
+					ShLPS25HFifoPeriod(period);
+					GhFilterPeriod(&filter,period / 1000.0);
+				}
+			}
+		}
+	}
+
+	// Graceful shutdown: release clients, the outbox, the snapshot, the matrix and the sensors
+	fprintf(stdout,"\nShutting down\n");
+	fflush(stdout);
+	if(creadings.rtime != 0)
+	{
+		GhCheckpointPost(cw,&snap,alimits,stats,&filter,&pid);
+	}
+	GhCheckpointStop(cw);
+	if(srv != NULL)
+	{
+		GhServerClose(srv);
+	}
+	if(up != NULL)
+	{
+		GhUploadStop(up);
+	}
+	if(shm != NULL)
+	{
+		GhShmDetach(shm);
+		shm_unlink(SHMNAME);
+	}
+	GhStartupClose(&st);
+	if(started)
+	{
+		GhMatrixClose(&mx);
+	}
+	ShExit();
+	GhConfigStop(&cfgctl);
+	GhPidStop(&pid);
+	GhActClose(&act);
+	GhEventClose(&ev);
+	while(arecord != NULL)
+	{
+		anext = arecord->next;
+		free(arecord);
+		arecord = anext;
+	}
+	free(cw);
+	free(srv);
+	free(up);
+	free(stats);
+	free(cring);
+	free(hist);
+	return EXIT_SUCCESS;
 }
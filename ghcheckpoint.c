@@ -0,0 +1,221 @@
+/** @brief Gh checkpoint functions
+*   @file ghcheckpoint.c
+*/
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include "ghcheckpoint.h"
+#include "ghbatch.h"
+
+/** @brief Seals a checkpoint record and writes it atomically
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param ck pointer to the filled record
+ *  @return int 1 on success, 0 on error
+*/
+static int GhCheckpointWrite(const char * fname, ghcheckpoint_s * ck)
+{
+    ck->hdr.magic = CKPTMAGIC;
+    ck->hdr.version = CKPTVERSION;
+    ck->hdr.size = sizeof(ghcheckpoint_s) - sizeof(ckptheader_s);
+    ck->hdr.crc = GhCrc32((const char *) ck + sizeof(ckptheader_s),ck->hdr.size);
+    return GhWriteAtomic(fname,ck,sizeof(ghcheckpoint_s));
+}
+
+/** @brief Writes each posted record, the latest one when several are waiting
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to checkpoint writer
+ *  @return void * always NULL
+*/
+static void * GhCheckpointThread(void * arg)
+{
+    ckptwriter_s * cw = (ckptwriter_s *) arg;
+    uint64_t wakes;
+    int dirty;
+    int stop = 0;
+
+    // Lower priority, so the fsyncs never hold the control loop off the core
+    setpriority(PRIO_PROCESS,(id_t) syscall(SYS_gettid),CKPTNICE);
+    while(!stop)
+    {
+        if(read(cw->wakefd,&wakes,sizeof(wakes)) != sizeof(wakes) && errno != EINTR)
+        {
+            break;
+        }
+        pthread_mutex_lock(&cw->lock);
+        dirty = cw->dirty;
+        if(dirty)
+        {
+            cw->out = cw->pending;
+            cw->dirty = 0;
+        }
+        stop = cw->stop;
+        pthread_mutex_unlock(&cw->lock);
+        if(dirty && !GhCheckpointWrite(cw->fname,&cw->out))
+        {
+            perror("Error (checkpoint)");
+        }
+    }
+    return NULL;
+}
+
+/** @brief Starts the checkpoint writer thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param cw pointer to checkpoint writer
+ *  @param fname pointer to checkpoint file name
+ *  @return int 1 if the thread runs, 0 if posts will write inline
+*/
+int GhCheckpointStart(ckptwriter_s * cw, const char * fname)
+{
+    cw->dirty = 0;
+    cw->stop = 0;
+    snprintf(cw->fname,sizeof(cw->fname),"%s",fname);
+    pthread_mutex_init(&cw->lock,NULL);
+    cw->wakefd = eventfd(0,EFD_CLOEXEC);
+    if(cw->wakefd == -1 || pthread_create(&cw->tid,NULL,GhCheckpointThread,cw) != 0)
+    {
+        perror("Error (checkpoint writer)");
+        if(cw->wakefd != -1)
+        {
+            close(cw->wakefd);
+            cw->wakefd = -1;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Hands the writer a new checkpoint; the loop never waits on the disk
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param cw pointer to checkpoint writer
+ *  @param snap pointer to the latest snapshot
+ *  @param limits alarm limits in force
+ *  @param stats pointer to rolling statistics, only their summaries are kept
+ *  @param filter pointer to reading filters
+ *  @param pid pointer to controller
+ *  @return void
+*/
+void GhCheckpointPost(ckptwriter_s * cw, const ghsnapshot_s * snap, alarmlimit_s limits, stats_s * stats, const ghfilter_s * filter, const ghpid_s * pid)
+{
+    int w;
+    int s;
+    uint64_t one = 1;
+
+    pthread_mutex_lock(&cw->lock);
+    cw->pending.snap = *snap;
+    cw->pending.limits = limits;
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        for(s=0; s<SENSORS; s++)
+        {
+            cw->pending.summary[w][s] = GhStatsGet(stats,w,s);
+        }
+    }
+    cw->pending.filter = *filter;
+    memcpy(cw->pending.loop,pid->loop,sizeof(cw->pending.loop));
+    cw->pending.hdr.saved = (int64_t) time(NULL);
+    cw->dirty = 1;
+    if(cw->wakefd == -1)
+    {
+        // No writer thread, so this is the only thread using the record
+        cw->dirty = 0;
+        pthread_mutex_unlock(&cw->lock);
+        if(!GhCheckpointWrite(cw->fname,&cw->pending))
+        {
+            perror("Error (checkpoint)");
+        }
+        return;
+    }
+    pthread_mutex_unlock(&cw->lock);
+    if(write(cw->wakefd,&one,sizeof(one)) != sizeof(one))
+    {
+        perror("Error (checkpoint post)");
+    }
+}
+
+/** @brief Writes what is still pending, then stops the writer thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param cw pointer to checkpoint writer
+ *  @return void
+*/
+void GhCheckpointStop(ckptwriter_s * cw)
+{
+    uint64_t one = 1;
+
+    if(cw->wakefd != -1)
+    {
+        pthread_mutex_lock(&cw->lock);
+        cw->stop = 1;
+        pthread_mutex_unlock(&cw->lock);
+        if(write(cw->wakefd,&one,sizeof(one)) != sizeof(one))
+        {
+            perror("Error (checkpoint stop)");
+        }
+        pthread_join(cw->tid,NULL);
+        close(cw->wakefd);
+        cw->wakefd = -1;
+    }
+    pthread_mutex_destroy(&cw->lock);
+}
+
+/** @brief Reads and validates a checkpoint
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param ck pointer to checkpoint filled on success
+ *  @return int 1 if a valid checkpoint was read, 0 otherwise
+*/
+int GhCheckpointLoad(const char * fname, ghcheckpoint_s * ck)
+{
+    int fd;
+    ssize_t n;
+    size_t done = 0;
+
+    fd = open(fname,O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+    {
+        return 0;
+    }
+    while(done < sizeof(ghcheckpoint_s))
+    {
+        n = read(fd,(char *) ck + done,sizeof(ghcheckpoint_s) - done);
+        if(n <= 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    close(fd);
+    if(done != sizeof(ghcheckpoint_s) || ck->hdr.magic != CKPTMAGIC || ck->hdr.version != CKPTVERSION
+        || ck->hdr.size != sizeof(ghcheckpoint_s) - sizeof(ckptheader_s))
+    {
+        return 0;
+    }
+    return GhCrc32((const char *) ck + sizeof(ckptheader_s),ck->hdr.size) == ck->hdr.crc;
+}
+
+/** @brief Restores the active alarms saved in a checkpoint
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ck pointer to a validated checkpoint
+ *  @param head pointer to the (empty) alarm list
+ *  @return pointer to alarm_s type
+*/
+alarm_s * GhCheckpointAlarms(const ghcheckpoint_s * ck, alarm_s * head)
+{
+    int code;
+    for(code = HTEMP; code < NALARMS; code++)
+    {
+        if(ck->snap.alarms & ALARMBIT(code))
+        {
+            GhSetOneAlarm(code,(time_t) ck->snap.atime[code],ck->snap.avalue[code],head);
+        }
+    }
+    return head;
+}
@@ -0,0 +1,76 @@
+/** @brief Gh checkpoint constants, structures, function prototypes
+*   @file ghcheckpoint.h
+*
+*   The checkpoint is one fixed-layout record: a header with a format
+*   version, the payload size and a CRC-32 of the payload, then the last
+*   snapshot (setpoints, controls, active alarms), the alarm limits, the
+*   statistics summaries, the reading filter state and the PID loops. A
+*   record that fails any check is ignored.
+*
+*   The statistics windows themselves are not saved; on restart they are
+*   rebuilt from the tail of the data log (GhStatsRebuild()). That keeps the
+*   record near 1 KB, and the control loop only copies it: a writer thread
+*   does the atomic write and its fsyncs, keeping the latest record when the
+*   loop posts faster than the disk takes them.
+*/
+#ifndef GHCHECKPOINT_H
+#define GHCHECKPOINT_H
+
+// Includes
+#include <pthread.h>
+#include "ghcontrol.h"
+#include "ghshm.h"
+#include "ghstats.h"
+#include "ghfilter.h"
+#include "ghpid.h"
+
+// Checkpoint Constants
+#define CKPTFILE "ghc.ckpt"
+#define CKPTMAGIC 0x54504b43        // "CKPT"
+#define CKPTVERSION 10
+#define CKPTSECS 60                 // s between checkpoints, whatever the sampling period
+#define CKPTNICE 10                 // writer thread nice value
+#define CKPTMAXAGE STATWIN0SECS     // older filter and loop state are not restored
+
+//Typedefs
+typedef struct ckptheader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;                  // bytes after the header
+    uint32_t crc;                   // CRC-32 of those bytes
+    int64_t saved;
+}ckptheader_s;
+
+typedef struct ghcheckpoint
+{
+    ckptheader_s hdr;
+    ghsnapshot_s snap;
+    alarmlimit_s limits;
+    statsummary_s summary[STATWINDOWS][SENSORS];
+    ghfilter_s filter;
+    pidloop_s loop[PIDLOOPS];
+}ghcheckpoint_s;
+
+typedef struct ckptwriter
+{
+    ghcheckpoint_s pending;         // latest posted record, under lock
+    ghcheckpoint_s out;             // record being written, writer thread only
+    pthread_mutex_t lock;
+    pthread_t tid;
+    int wakefd;                     // -1 when there is no thread and posts write inline
+    int dirty;
+    int stop;
+    char fname[FILEPATHSZ];
+}ckptwriter_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhCheckpointStart(ckptwriter_s * cw, const char * fname);
+void GhCheckpointPost(ckptwriter_s * cw, const ghsnapshot_s * snap, alarmlimit_s limits, stats_s * stats, const ghfilter_s * filter, const ghpid_s * pid);
+void GhCheckpointStop(ckptwriter_s * cw);
+int GhCheckpointLoad(const char * fname, ghcheckpoint_s * ck);
+alarm_s * GhCheckpointAlarms(const ghcheckpoint_s * ck, alarm_s * head);
+///@endcond
+
+#endif
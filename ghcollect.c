@@ -0,0 +1,468 @@
+/** @brief ghc-collect: stand-in collector for the uploader
+*   @file ghcollect.c
+*
+*   Usage: ghc-collect [-p port] [-o outfile]
+*
+*   Accepts frames from ghupload.c on a TCP port, bare or as the body of
+*   an HTTP POST, and answers each one "ACK <seq>" or "NAK <seq>". Frames
+*   are checked, decoded with ghcompress.c and appended to the output as
+*   CSV lines:
+*     <node>,<time>,<temperature>,<humidity>,<pressure>
+*     <node>,<time>,alarm,<code>,<value>,raised|cleared
+*     <node>,frame,<seq>
+*   The frame line comes last, once the rest of the frame is written. A
+*   frame numbered at or below the last one stored for its node is a
+*   resend after a lost answer; it is acknowledged but not stored again.
+*   The frame lines already in the output set those numbers on start, so
+*   this holds across collector restarts too.
+*   One thread and poll(), for testing rather than for a fleet.
+*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "ghupload.h"
+
+// Collector Constants
+#define COLPORT 7070
+#define COLOUTFILE "ghcollect.txt"
+#define COLMAXCLIENTS 32
+#define COLMAXNODES 64
+#define COLLINESZ 128
+#define COLBUFSZ (UPHTTPHDRSZ + UPSENDFRAMES * sizeof(upframe_s))
+#define COLMAXSAMPLES (CBLOCKWORDS * 64 / (1 + SENSORS))   // an unchanged sample costs one bit per field
+
+//Typedefs
+typedef struct colclient
+{
+    int fd;
+    size_t len;
+    uint8_t buf[COLBUFSZ];
+}colclient_s;
+
+typedef struct colnode
+{
+    uint64_t node;
+    uint64_t seq;               // last frame stored
+}colnode_s;
+
+typedef struct collector
+{
+    FILE * out;
+    int nnodes;
+    colnode_s nodes[COLMAXNODES];
+    uint64_t frames;
+    uint64_t samples;
+    uint64_t events;
+    uint64_t resent;
+    uint64_t rejected;
+    uint64_t bytes;
+}collector_s;
+
+static volatile sig_atomic_t stop = 0;
+
+/** @brief Asks the main loop to stop
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param sig signal number
+ *  @return void
+*/
+static void GhCollectSignal(int sig)
+{
+    (void) sig;
+    stop = 1;
+}
+
+/** @brief Finds or adds the dedup entry of a node
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param col pointer to collector
+ *  @param node serial number
+ *  @return colnode_s * entry, NULL when the table is full
+*/
+static colnode_s * GhCollectNode(collector_s * col, uint64_t node)
+{
+    int i;
+    for(i=0; i<col->nnodes; i++)
+    {
+        if(col->nodes[i].node == node)
+        {
+            return &col->nodes[i];
+        }
+    }
+    if(col->nnodes == COLMAXNODES)
+    {
+        return NULL;
+    }
+    col->nodes[col->nnodes].node = node;
+    col->nodes[col->nnodes].seq = 0;
+    return &col->nodes[col->nnodes++];
+}
+
+/** @brief Reads back the last frame stored for each node
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param col pointer to collector
+ *  @param fname output file name
+ *  @return void
+*/
+static void GhCollectResume(collector_s * col, const char * fname)
+{
+    unsigned long long node;
+    unsigned long long seq;
+    char line[COLLINESZ];
+    colnode_s * nd;
+    FILE * fp = fopen(fname,"r");
+
+    if(fp == NULL)
+    {
+        return;
+    }
+    while(fgets(line,sizeof(line),fp) != NULL)
+    {
+        if(sscanf(line,"%llx,frame,%llu",&node,&seq) == 2 && (nd = GhCollectNode(col,node)) != NULL && seq > nd->seq)
+        {
+            nd->seq = seq;
+        }
+    }
+    fclose(fp);
+}
+
+/** @brief Checks, decodes and stores one frame
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param col pointer to collector
+ *  @param hdr pointer to frame header
+ *  @param payload pointer to the hdr->size bytes after the header
+ *  @return int 1 if the frame is stored (or was already), 0 if it is damaged
+*/
+static int GhCollectFrame(collector_s * col, const upheader_s * hdr, const uint8_t * payload)
+{
+    static reading_s rows[COLMAXSAMPLES];
+    uint32_t k;
+    uint32_t n = 0;
+    size_t blen;
+    cblock_s blk;
+    cblockiter_s it;
+    upevent_s ev;
+    colnode_s * nd;
+
+    if(hdr->size < UPBLOCKHDRSZ || GhCrc32(payload,hdr->size) != hdr->crc)
+    {
+        return 0;
+    }
+    memset(&blk,0,sizeof(blk));
+    memcpy(&blk,payload,UPBLOCKHDRSZ);
+    blen = UPBLOCKHDRSZ + ((blk.nbits + 63) / 64) * sizeof(uint64_t);
+    if(blk.nbits > CBLOCKWORDS * 64 || blk.nsamples > COLMAXSAMPLES || hdr->size != blen + hdr->nevents * sizeof(upevent_s))
+    {
+        return 0;
+    }
+    nd = GhCollectNode(col,hdr->node);
+    if(nd != NULL && hdr->seq <= nd->seq)
+    {
+        col->resent++;
+        return 1;
+    }
+
+    // Decode in full first; the bits must run out exactly at the last sample
+    memcpy(&blk,payload,blen);
+    GhCBlockIterInit(&blk,&it);
+    while((it.sample == 0 || it.pos + CSAMPLEMAXBITS <= CBLOCKWORDS * 64) && GhCBlockNext(&it,&rows[n]))
+    {
+        n++;
+    }
+    if(n != blk.nsamples || it.pos != blk.nbits)
+    {
+        return 0;
+    }
+    for(k=0; k<n; k++)
+    {
+        fprintf(col->out,"%016llx,%lld,%.1lf,%.1lf,%.1lf\n",(unsigned long long) hdr->node,(long long) rows[k].rtime,
+            rows[k].temperature,rows[k].humidity,rows[k].pressure);
+    }
+    for(k=0; k<hdr->nevents; k++)
+    {
+        memcpy(&ev,payload + blen + k * sizeof(upevent_s),sizeof(ev));
+        fprintf(col->out,"%016llx,%lld,alarm,%u,%.1lf,%s\n",(unsigned long long) hdr->node,(long long) ev.time,
+            ev.code,ev.value,ev.active ? "raised" : "cleared");
+    }
+    fprintf(col->out,"%016llx,frame,%llu\n",(unsigned long long) hdr->node,(unsigned long long) hdr->seq);
+    fflush(col->out);
+    if(nd != NULL)
+    {
+        nd->seq = hdr->seq;
+    }
+    col->frames++;
+    col->samples += n;
+    col->events += hdr->nevents;
+    col->bytes += sizeof(upheader_s) + hdr->size;
+    fprintf(stderr,"node %016llx frame %llu: %u samples, %u events, %zu bytes\n",(unsigned long long) hdr->node,
+        (unsigned long long) hdr->seq,n,hdr->nevents,sizeof(upheader_s) + hdr->size);
+    return 1;
+}
+
+/** @brief Handles the whole frames at the start of a buffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param col pointer to collector
+ *  @param p pointer to buffered bytes
+ *  @param len number of bytes
+ *  @param reply buffer for the answer lines
+ *  @param rlen pointer to the length of reply, advanced
+ *  @param bad pointer set to 1 if the stream cannot be followed past a frame
+ *  @return size_t bytes used
+*/
+static size_t GhCollectFrames(collector_s * col, const uint8_t * p, size_t len, char * reply, size_t * rlen, int * bad)
+{
+    size_t used = 0;
+    upheader_s hdr;
+
+    while(len - used >= sizeof(upheader_s))
+    {
+        memcpy(&hdr,p + used,sizeof(hdr));
+        if(hdr.magic != UPMAGIC || hdr.version != UPVERSION || hdr.size > sizeof(upframe_s) - sizeof(upheader_s))
+        {
+            *bad = 1;
+            break;
+        }
+        if(len - used < sizeof(upheader_s) + hdr.size)
+        {
+            break;
+        }
+        if(!GhCollectFrame(col,&hdr,p + used + sizeof(upheader_s)))
+        {
+            col->rejected++;
+            fprintf(stderr,"node %016llx frame %llu: damaged\n",(unsigned long long) hdr.node,(unsigned long long) hdr.seq);
+            *rlen += snprintf(reply + *rlen,UPREPLYSZ - *rlen,"NAK %llu\n",(unsigned long long) hdr.seq);
+        }
+        else
+        {
+            *rlen += snprintf(reply + *rlen,UPREPLYSZ - *rlen,"ACK %llu\n",(unsigned long long) hdr.seq);
+        }
+        used += sizeof(upheader_s) + hdr.size;
+    }
+    return used;
+}
+
+/** @brief Answers an HTTP request that cannot be handled
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fd client socket
+ *  @param status status code and reason
+ *  @return void
+*/
+static void GhCollectRefuse(int fd, const char * status)
+{
+    int n;
+    char head[UPHTTPHDRSZ];
+    n = snprintf(head,sizeof(head),"HTTP/1.1 %s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",status);
+    send(fd,head,n,MSG_NOSIGNAL);
+}
+
+/** @brief Handles what a client has sent so far
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param col pointer to collector
+ *  @param c pointer to client
+ *  @return int 1 to keep the connection, 0 to close it
+*/
+static int GhCollectClient(collector_s * col, colclient_s * c)
+{
+    int bad;
+    long body;
+    ssize_t n;
+    size_t used;
+    size_t hlen;
+    size_t rlen;
+    char save;
+    char * field;
+    uint8_t * hend;
+    uint32_t magic = UPMAGIC;
+    char reply[UPREPLYSZ];
+    char head[UPHTTPHDRSZ];
+
+    n = recv(c->fd,c->buf + c->len,COLBUFSZ - c->len,MSG_DONTWAIT);
+    if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    {
+        return 1;
+    }
+    if(n <= 0)
+    {
+        return 0;
+    }
+    c->len += n;
+    for(;;)
+    {
+        bad = 0;
+        rlen = 0;
+        if(c->len >= sizeof(magic) && memcmp(c->buf,&magic,sizeof(magic)) == 0)
+        {
+            // Bare frames, answered as they complete
+            used = GhCollectFrames(col,c->buf,c->len,reply,&rlen,&bad);
+            if(used == 0)
+            {
+                return !bad && c->len < COLBUFSZ;
+            }
+        }
+        else if(c->len >= 5 && memcmp(c->buf,"POST ",5) == 0)
+        {
+            hend = memmem(c->buf,c->len,"\r\n\r\n",4);
+            if(hend == NULL)
+            {
+                return c->len < COLBUFSZ;
+            }
+            hlen = hend + 4 - c->buf;
+            save = *hend;
+            *hend = '\0';
+            field = strcasestr((char *) c->buf,"\r\nContent-Length:");
+            body = (field == NULL) ? -1 : strtol(field + 17,NULL,10);
+            *hend = save;
+            if(body < 0 || (size_t) body > COLBUFSZ - hlen)
+            {
+                GhCollectRefuse(c->fd,"413 Payload Too Large");
+                return 0;
+            }
+            if(c->len < hlen + body)
+            {
+                return 1;
+            }
+            if(GhCollectFrames(col,c->buf + hlen,body,reply,&rlen,&bad) != (size_t) body)
+            {
+                GhCollectRefuse(c->fd,"400 Bad Request");
+                return 0;
+            }
+            n = snprintf(head,sizeof(head),"HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n\r\n",rlen);
+            if(send(c->fd,head,n,MSG_NOSIGNAL) != n)
+            {
+                return 0;
+            }
+            used = hlen + body;
+        }
+        else
+        {
+            // Not a frame or a POST, or too little of either to tell
+            return c->len < 5;
+        }
+        if(rlen > 0 && send(c->fd,reply,rlen,MSG_NOSIGNAL) != (ssize_t) rlen)
+        {
+            return 0;
+        }
+        c->len -= used;
+        memmove(c->buf,c->buf + used,c->len);
+        if(bad)
+        {
+            return 0;
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int opt;
+    int i;
+    int n;
+    int fd;
+    int lfd;
+    int one = 1;
+    int port = COLPORT;
+    const char * fname = COLOUTFILE;
+    struct sockaddr_in ia = {0};
+    struct sigaction sa = {0};
+    struct pollfd pfds[COLMAXCLIENTS + 1];
+    static colclient_s clients[COLMAXCLIENTS];
+    static collector_s col;
+
+    while((opt = getopt(argc,argv,"p:o:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'o':
+                fname = optarg;
+                break;
+            default:
+                fprintf(stderr,"Usage: %s [-p port] [-o outfile]\n",argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    GhCollectResume(&col,fname);
+    col.out = fopen(fname,"a");
+    if(col.out == NULL)
+    {
+        perror(fname);
+        return EXIT_FAILURE;
+    }
+    lfd = socket(AF_INET,SOCK_STREAM | SOCK_CLOEXEC,0);
+    ia.sin_family = AF_INET;
+    ia.sin_port = htons(port);
+    ia.sin_addr.s_addr = htonl(INADDR_ANY);
+    if(lfd != -1)
+    {
+        setsockopt(lfd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+    }
+    if(lfd == -1 || bind(lfd,(struct sockaddr *) &ia,sizeof(ia)) == -1 || listen(lfd,COLMAXCLIENTS) == -1)
+    {
+        perror("ghc-collect");
+        return EXIT_FAILURE;
+    }
+    sa.sa_handler = GhCollectSignal;
+    sigaction(SIGINT,&sa,NULL);
+    sigaction(SIGTERM,&sa,NULL);
+    fprintf(stderr,"ghc-collect: listening on port %d, writing %s (%d nodes seen)\n",port,fname,col.nnodes);
+
+    for(i=0; i<COLMAXCLIENTS; i++)
+    {
+        clients[i].fd = -1;
+    }
+    while(!stop)
+    {
+        pfds[0].fd = lfd;
+        pfds[0].events = POLLIN;
+        for(i=0; i<COLMAXCLIENTS; i++)
+        {
+            pfds[i + 1].fd = clients[i].fd;
+            pfds[i + 1].events = POLLIN;
+        }
+        n = poll(pfds,COLMAXCLIENTS + 1,-1);
+        if(n <= 0)
+        {
+            continue;
+        }
+        if(pfds[0].revents & POLLIN)
+        {
+            fd = accept4(lfd,NULL,NULL,SOCK_CLOEXEC);
+            for(i=0; fd != -1 && i<COLMAXCLIENTS && clients[i].fd != -1; i++)
+            {
+            }
+            if(fd != -1 && i == COLMAXCLIENTS)
+            {
+                close(fd);
+            }
+            else if(fd != -1)
+            {
+                clients[i].fd = fd;
+                clients[i].len = 0;
+            }
+        }
+        for(i=0; i<COLMAXCLIENTS; i++)
+        {
+            if(clients[i].fd != -1 && pfds[i + 1].revents != 0 && !GhCollectClient(&col,&clients[i]))
+            {
+                close(clients[i].fd);
+                clients[i].fd = -1;
+            }
+        }
+    }
+
+    fprintf(stderr,"ghc-collect: %llu frames, %llu samples, %llu events, %llu resent, %llu rejected, %.1lf B/sample\n",
+        (unsigned long long) col.frames,(unsigned long long) col.samples,(unsigned long long) col.events,
+        (unsigned long long) col.resent,(unsigned long long) col.rejected,col.samples ? (double) col.bytes / col.samples : 0.0);
+    fclose(col.out);
+    close(lfd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,469 @@
+/** @brief Gh compressed sample ring functions
+*   @file ghcompress.c
+*
+*   Readings are packed into fixed-size blocks with delta-of-delta encoded
+*   timestamps and XOR encoded values (the Gorilla scheme). Values are
+*   stored as whole steps of the log resolution, so unchanged readings cost
+*   one bit per channel. When the ring is full the oldest block is reused.
+*   A block stands alone (its first sample is stored whole), so single
+*   blocks can also be encoded, sent and decoded outside the ring.
+*/
+#include <math.h>
+#include "ghcompress.h"
+
+/** @brief Appends bits to a block, most significant bit first
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param blk pointer to block
+ *  @param value bits to write in the low n bits
+ *  @param n number of bits (1 to 64)
+ *  @return void
+*/
+static inline void GhBitsPut(cblock_s * blk, uint64_t value, int n)
+{
+    int room;
+    int take;
+    uint64_t chunk;
+    while(n > 0)
+    {
+        room = 64 - (blk->nbits & 63);
+        take = (n < room) ? n : room;
+        chunk = (take == 64) ? value : (value >> (n - take)) & ((1ULL << take) - 1);
+        blk->words[blk->nbits >> 6] |= chunk << (room - take);
+        blk->nbits += take;
+        n -= take;
+    }
+}
+
+/** @brief Reads bits from a block, most significant bit first
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param blk pointer to block
+ *  @param pos pointer to bit position, advanced by n
+ *  @param n number of bits (1 to 64)
+ *  @return uint64_t bits read
+*/
+static inline uint64_t GhBitsGet(const cblock_s * blk, uint32_t * pos, int n)
+{
+    int room;
+    int take;
+    uint64_t w;
+    uint64_t value = 0;
+    while(n > 0)
+    {
+        room = 64 - (*pos & 63);
+        take = (n < room) ? n : room;
+        w = blk->words[*pos >> 6] >> (room - take);
+        if(take == 64)
+        {
+            value = w;
+        }
+        else
+        {
+            value = (value << take) | (w & ((1ULL << take) - 1));
+        }
+        *pos += take;
+        n -= take;
+    }
+    return value;
+}
+
+/** @brief Scales a value to whole ring resolution steps and returns its bits
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param v value
+ *  @return uint64_t IEEE-754 bits of the scaled value
+*/
+static inline uint64_t GhQuantBits(double v)
+{
+    uint64_t bits;
+    // Integral doubles leave the low mantissa bits clear, keeping XOR windows short
+    v = round(v * CRINGQUANT);
+    memcpy(&bits,&v,sizeof(bits));
+    return bits;
+}
+
+/** @brief Returns a value from the bits of its scaled double
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param bits IEEE-754 bits of the scaled value
+ *  @return double
+*/
+static inline double GhBitsDouble(uint64_t bits)
+{
+    double v;
+    memcpy(&v,&bits,sizeof(v));
+    return v / CRINGQUANT;
+}
+
+/** @brief Resets codec state to the first sample of a block
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to codec state
+ *  @param blk pointer to block
+ *  @return void
+*/
+static void GhCStateReset(cstate_s * st, const cblock_s * blk)
+{
+    int i;
+    st->time = blk->t0;
+    st->delta = 0;
+    for(i=0; i<SENSORS; i++)
+    {
+        memcpy(&st->bits[i],&blk->v0[i],sizeof(uint64_t));
+        st->lead[i] = 64;
+        st->trail[i] = 64;
+    }
+}
+
+/** @brief Initialises an empty compressed ring
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to compressed ring
+ *  @return void
+*/
+void GhCRingInit(cring_s * ring)
+{
+    memset(ring,0,sizeof(cring_s));
+    ring->head = -1;
+}
+
+/** @brief Appends one reading to a block
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param blk pointer to block, zeroed before its first sample
+ *  @param st pointer to encoder state, reset by the first sample
+ *  @param rdata object of readings type
+ *  @return int 1 if the reading was added, 0 if the block is full
+*/
+int GhCBlockAdd(cblock_s * blk, cstate_s * st, reading_s rdata)
+{
+    int i;
+    int lead;
+    int trail;
+    int64_t delta;
+    int64_t dod;
+    uint64_t bits[SENSORS];
+    uint64_t x;
+
+    bits[TEMPERATURE] = GhQuantBits(rdata.temperature);
+    bits[HUMIDITY] = GhQuantBits(rdata.humidity);
+    bits[PRESSURE] = GhQuantBits(rdata.pressure);
+
+    if(blk->nsamples == 0)
+    {
+        blk->t0 = (int64_t) rdata.rtime;
+        for(i=0; i<SENSORS; i++)
+        {
+            memcpy(&blk->v0[i],&bits[i],sizeof(double));
+        }
+        blk->nsamples = 1;
+        GhCStateReset(st,blk);
+        return 1;
+    }
+    if(blk->nbits + CSAMPLEMAXBITS > CBLOCKWORDS * 64)
+    {
+        return 0;
+    }
+
+    // Timestamp: delta-of-delta with variable-length buckets
+    delta = (int64_t) rdata.rtime - st->time;
+    dod = delta - st->delta;
+    if(dod == 0)
+    {
+        GhBitsPut(blk,0x0,1);
+    }
+    else if(dod >= -63 && dod <= 64)
+    {
+        GhBitsPut(blk,0x2,2);
+        GhBitsPut(blk,(uint64_t)(dod + 63),7);
+    }
+    else if(dod >= -255 && dod <= 256)
+    {
+        GhBitsPut(blk,0x6,3);
+        GhBitsPut(blk,(uint64_t)(dod + 255),9);
+    }
+    else if(dod >= -2047 && dod <= 2048)
+    {
+        GhBitsPut(blk,0xE,4);
+        GhBitsPut(blk,(uint64_t)(dod + 2047),12);
+    }
+    else
+    {
+        GhBitsPut(blk,0xF,4);
+        GhBitsPut(blk,(uint64_t)(uint32_t)(int32_t) dod,32);
+    }
+    st->time = (int64_t) rdata.rtime;
+    st->delta = delta;
+
+    // Values: XOR against the previous value, reusing the previous window when it fits
+    for(i=0; i<SENSORS; i++)
+    {
+        x = bits[i] ^ st->bits[i];
+        st->bits[i] = bits[i];
+        if(x == 0)
+        {
+            GhBitsPut(blk,0x0,1);
+            continue;
+        }
+        lead = __builtin_clzll(x);
+        trail = __builtin_ctzll(x);
+        if(lead > 31)
+        {
+            lead = 31;
+        }
+        if(lead >= st->lead[i] && trail >= st->trail[i])
+        {
+            GhBitsPut(blk,0x2,2);
+            GhBitsPut(blk,x >> st->trail[i],64 - st->lead[i] - st->trail[i]);
+        }
+        else
+        {
+            GhBitsPut(blk,0x3,2);
+            GhBitsPut(blk,(uint64_t) lead,5);
+            GhBitsPut(blk,(uint64_t)(64 - lead - trail - 1),6);
+            GhBitsPut(blk,x >> trail,64 - lead - trail);
+            st->lead[i] = lead;
+            st->trail[i] = trail;
+        }
+    }
+    blk->nsamples++;
+    return 1;
+}
+
+/** @brief Adds one reading to the compressed ring
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to compressed ring
+ *  @param rdata object of readings type
+ *  @return void
+*/
+void GhCRingAdd(cring_s * ring, reading_s rdata)
+{
+    cblock_s * blk = (ring->head < 0) ? NULL : &ring->blocks[ring->head];
+
+    if(blk == NULL || !GhCBlockAdd(blk,&ring->enc,rdata))
+    {
+        // Start a new block, evicting the oldest one when the ring is full
+        ring->head = (ring->head + 1) % CRINGBLOCKS;
+        blk = &ring->blocks[ring->head];
+        if(ring->count == CRINGBLOCKS)
+        {
+            ring->samples -= blk->nsamples;
+        }
+        else
+        {
+            ring->count++;
+        }
+        memset(blk,0,sizeof(cblock_s));
+        GhCBlockAdd(blk,&ring->enc,rdata);
+    }
+    ring->samples++;
+}
+
+/** @brief Positions an iterator at the first sample of a block
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param blk pointer to block
+ *  @param it pointer to iterator
+ *  @return void
+*/
+void GhCBlockIterInit(const cblock_s * blk, cblockiter_s * it)
+{
+    memset(it,0,sizeof(cblockiter_s));
+    it->blk = blk;
+}
+
+/** @brief Decodes the next sample of a block
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param it pointer to iterator
+ *  @param out pointer to reading filled on success
+ *  @return int 1 if a sample was decoded, 0 at the end of the block
+*/
+int GhCBlockNext(cblockiter_s * it, reading_s * out)
+{
+    int i;
+    int lead;
+    int len;
+    int64_t dod;
+    const cblock_s * blk = it->blk;
+    cstate_s * st = &it->dec;
+
+    if(it->sample >= blk->nsamples)
+    {
+        return 0;
+    }
+    if(it->sample == 0)
+    {
+        GhCStateReset(st,blk);
+        it->pos = 0;
+    }
+    else
+    {
+        if(GhBitsGet(blk,&it->pos,1) == 0)
+        {
+            dod = 0;
+        }
+        else if(GhBitsGet(blk,&it->pos,1) == 0)
+        {
+            dod = (int64_t) GhBitsGet(blk,&it->pos,7) - 63;
+        }
+        else if(GhBitsGet(blk,&it->pos,1) == 0)
+        {
+            dod = (int64_t) GhBitsGet(blk,&it->pos,9) - 255;
+        }
+        else if(GhBitsGet(blk,&it->pos,1) == 0)
+        {
+            dod = (int64_t) GhBitsGet(blk,&it->pos,12) - 2047;
+        }
+        else
+        {
+            dod = (int32_t)(uint32_t) GhBitsGet(blk,&it->pos,32);
+        }
+        st->delta += dod;
+        st->time += st->delta;
+        for(i=0; i<SENSORS; i++)
+        {
+            if(GhBitsGet(blk,&it->pos,1) == 0)
+            {
+                continue;
+            }
+            if(GhBitsGet(blk,&it->pos,1) == 1)
+            {
+                lead = (int) GhBitsGet(blk,&it->pos,5);
+                len = (int) GhBitsGet(blk,&it->pos,6) + 1;
+                st->lead[i] = lead;
+                st->trail[i] = 64 - lead - len;
+            }
+            len = 64 - st->lead[i] - st->trail[i];
+            st->bits[i] ^= GhBitsGet(blk,&it->pos,len) << st->trail[i];
+        }
+    }
+    it->sample++;
+    out->rtime = (time_t) st->time;
+    out->temperature = GhBitsDouble(st->bits[TEMPERATURE]);
+    out->humidity = GhBitsDouble(st->bits[HUMIDITY]);
+    out->pressure = GhBitsDouble(st->bits[PRESSURE]);
+    return 1;
+}
+
+/** @brief Positions an iterator at the oldest sample in the ring
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to compressed ring
+ *  @param it pointer to iterator
+ *  @return void
+*/
+void GhCRingIterInit(const cring_s * ring, cringiter_s * it)
+{
+    memset(it,0,sizeof(cringiter_s));
+    it->ring = ring;
+    it->blocksleft = ring->count;
+    it->block = (ring->head - ring->count + 1 + CRINGBLOCKS) % CRINGBLOCKS;
+    GhCBlockIterInit(&ring->blocks[it->block],&it->cur);
+}
+
+/** @brief Decodes the next sample, oldest first
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param it pointer to iterator
+ *  @param out pointer to reading filled on success
+ *  @return int 1 if a sample was decoded, 0 at the end of the ring
+*/
+int GhCRingNext(cringiter_s * it, reading_s * out)
+{
+    while(it->blocksleft > 0)
+    {
+        if(GhCBlockNext(&it->cur,out))
+        {
+            return 1;
+        }
+        it->block = (it->block + 1) % CRINGBLOCKS;
+        it->blocksleft--;
+        GhCBlockIterInit(&it->ring->blocks[it->block],&it->cur);
+    }
+    return 0;
+}
+
+/** @brief Reports the compression ratio against raw reading_s storage
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to compressed ring
+ *  @return double raw bytes divided by encoded bytes in use
+*/
+double GhCRingRatio(const cring_s * ring)
+{
+    int b;
+    uint64_t bytes = 0;
+    for(b=0; b<ring->count; b++)
+    {
+        bytes += sizeof(cblock_s) - sizeof(ring->blocks[0].words) + (ring->blocks[(ring->head - b + CRINGBLOCKS) % CRINGBLOCKS].nbits + 7) / 8;
+    }
+    if(bytes == 0)
+    {
+        return 0.0;
+    }
+    return (double)(ring->samples * sizeof(reading_s)) / bytes;
+}
+
+/** @brief Round-trips readings through the ring, checking the decode and timing both ways
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param rd array of readings, oldest first
+ *  @param n number of readings
+ *  @param fp output stream
+ *  @return int 1 if every retained reading decoded to within the ring resolution, 0 otherwise
+*/
+int GhCRingReport(const reading_s * rd, size_t n, FILE * fp)
+{
+    size_t i;
+    size_t first;
+    size_t bad = 0;
+    double err;
+    double maxerr = 0.0;
+    double encsecs;
+    double decsecs;
+    double bytes;
+    reading_s out;
+    cringiter_s it;
+    struct timespec t0,t1,t2;
+    cring_s * ring = (cring_s *) malloc(sizeof(cring_s));
+
+    if(ring == NULL)
+    {
+        fprintf(fp,"Cannot allocate memory\n");
+        return 0;
+    }
+    GhCRingInit(ring);
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    for(i=0; i<n; i++)
+    {
+        GhCRingAdd(ring,rd[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+
+    // The ring keeps the newest samples once it wraps
+    first = n - ring->samples;
+    GhCRingIterInit(ring,&it);
+    for(i=first; i<n && GhCRingNext(&it,&out); i++)
+    {
+        err = fmax(fabs(out.temperature - rd[i].temperature),fmax(fabs(out.humidity - rd[i].humidity),fabs(out.pressure - rd[i].pressure)));
+        maxerr = fmax(maxerr,err);
+        // Rounding to the nearest step is off by at most half a step
+        bad += (out.rtime != rd[i].rtime) || !(err <= 0.5 / CRINGQUANT + 1e-9);
+    }
+    bad += n - i;
+    clock_gettime(CLOCK_MONOTONIC,&t2);
+    encsecs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    decsecs = (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec) / 1e9;
+    bytes = (ring->samples > 0) ? ring->samples * (double) sizeof(reading_s) / GhCRingRatio(ring) : 0.0;
+
+    fprintf(fp,"Compressed ring, %zu readings, %llu retained in %d blocks\n",n,(unsigned long long) ring->samples,ring->count);
+    fprintf(fp,"Bytes per sample: %.2lf (%.1lf bits), %.1lfx against reading_s\n",
+        bytes / ring->samples,bytes * 8.0 / ring->samples,GhCRingRatio(ring));
+    fprintf(fp,"Encode: %.0lf samples/s, decode: %.0lf samples/s\n",n / encsecs,(n - first) / decsecs);
+    fprintf(fp,"Largest decode error: %.4lf (limit %.2lf), failures: %zu\n",maxerr,0.5 / CRINGQUANT,bad);
+    free(ring);
+    return bad == 0;
+}
@@ -0,0 +1,73 @@
+/** @brief Gh compressed sample ring constants, structures, function prototypes
+*   @file ghcompress.h
+*/
+#ifndef GHCOMPRESS_H
+#define GHCOMPRESS_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Compressed Ring Constants
+#define CBLOCKWORDS 128     // 1 KB of encoded bits per block
+#define CRINGBLOCKS 1024    // over a week of samples at GHUPDATE
+#define CRINGQUANT 10.0     // values are rounded to 1/CRINGQUANT (the log resolution)
+#define CSAMPLEMAXBITS 267  // worst-case encoded size of one sample
+
+//Typedefs
+typedef struct cblock
+{
+    int64_t t0;
+    double v0[SENSORS];
+    uint32_t nsamples;
+    uint32_t nbits;
+    uint64_t words[CBLOCKWORDS];
+}cblock_s;
+
+typedef struct cstate
+{
+    int64_t time;
+    int64_t delta;
+    uint64_t bits[SENSORS];
+    int lead[SENSORS];
+    int trail[SENSORS];
+}cstate_s;
+
+typedef struct cring
+{
+    cblock_s blocks[CRINGBLOCKS];
+    int head;
+    int count;
+    uint64_t samples;
+    cstate_s enc;
+}cring_s;
+
+typedef struct cblockiter
+{
+    const cblock_s * blk;
+    uint32_t sample;
+    uint32_t pos;
+    cstate_s dec;
+}cblockiter_s;
+
+typedef struct cringiter
+{
+    const cring_s * ring;
+    int block;
+    int blocksleft;
+    cblockiter_s cur;
+}cringiter_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhCBlockAdd(cblock_s * blk, cstate_s * st, reading_s rdata);
+void GhCBlockIterInit(const cblock_s * blk, cblockiter_s * it);
+int GhCBlockNext(cblockiter_s * it, reading_s * out);
+void GhCRingInit(cring_s * ring);
+void GhCRingAdd(cring_s * ring, reading_s rdata);
+void GhCRingIterInit(const cring_s * ring, cringiter_s * it);
+int GhCRingNext(cringiter_s * it, reading_s * out);
+double GhCRingRatio(const cring_s * ring);
+int GhCRingReport(const reading_s * rd, size_t n, FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,533 @@
+/** @brief Gh runtime configuration functions
+*   @file ghconfig.c
+*
+*   Keys: temperature, humidity (setpoints), vpd (kPa, replaces the
+*   humidity setpoint when above 0), hight, lowt, highh, lowh, highp, lowp,
+*   highvpd, lowvpd, dewmargin (alarm limits, the last three off at 0).
+*   Keys left out keep their current values.
+*/
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "ghconfig.h"
+
+// Configuration Watcher Constants
+#define CONFIGEVBUFSZ 4096
+#define CONFIGRETIREUS 10000
+
+/** @brief Parses and validates a configuration file
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param base configuration supplying values for keys not in the file
+ *  @param out pointer to the parsed configuration
+ *  @return int 1 if the file was read and is valid, 0 otherwise
+*/
+int GhConfigParse(const char * fname, const ghconfig_s * base, ghconfig_s * out)
+{
+    FILE * fp;
+    int lineno = 0;
+    int ok = 1;
+    double val;
+    char * hash;
+    char key[32];
+    char line[CONFIGLINESZ];
+    char rest[2];
+
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return 0;
+    }
+    *out = *base;
+    while(ok && fgets(line,sizeof(line),fp) != NULL)
+    {
+        lineno++;
+        hash = strchr(line,'#');
+        if(hash != NULL)
+        {
+            *hash = '\0';
+        }
+        if(sscanf(line," %1s",rest) != 1)
+        {
+            continue;
+        }
+        if(sscanf(line," %31[a-z] = %lf %1s",key,&val,rest) != 2 || !isfinite(val))
+        {
+            // strtod reads nan and inf, which pass every range test below
+            ok = 0;
+        }
+        else if(!strcmp(key,"temperature")) out->spts.temperature = val;
+        else if(!strcmp(key,"humidity")) out->spts.humidity = val;
+        else if(!strcmp(key,"vpd")) out->vpd = val;
+        else if(!strcmp(key,"hight")) out->limits.hight = val;
+        else if(!strcmp(key,"lowt")) out->limits.lowt = val;
+        else if(!strcmp(key,"highh")) out->limits.highh = val;
+        else if(!strcmp(key,"lowh")) out->limits.lowh = val;
+        else if(!strcmp(key,"highp")) out->limits.highp = val;
+        else if(!strcmp(key,"lowp")) out->limits.lowp = val;
+        else if(!strcmp(key,"highvpd")) out->limits.highvpd = val;
+        else if(!strcmp(key,"lowvpd")) out->limits.lowvpd = val;
+        else if(!strcmp(key,"dewmargin")) out->limits.dewmargin = val;
+        else ok = 0;
+    }
+    fclose(fp);
+    if(!ok)
+    {
+        fprintf(stderr,"%s:%d: invalid setting\n",fname,lineno);
+        return 0;
+    }
+
+    // Reject values outside the ranges the controller and display handle
+    if(out->spts.temperature < LSTEMP || out->spts.temperature > USTEMP
+        || out->spts.humidity < LSHUMID || out->spts.humidity > USHUMID
+        || out->limits.lowt >= out->limits.hight || out->limits.lowt < LSTEMP || out->limits.hight > USTEMP
+        || out->limits.lowh >= out->limits.highh || out->limits.lowh < LSHUMID || out->limits.highh > USHUMID
+        || out->limits.lowp >= out->limits.highp || out->limits.lowp < CONFIGMINPRESS || out->limits.highp > CONFIGMAXPRESS
+        || out->vpd < 0 || out->vpd > CONFIGMAXVPD
+        || out->limits.lowvpd < 0 || out->limits.highvpd < 0 || out->limits.highvpd > CONFIGMAXVPD
+        || (out->limits.highvpd > 0 && out->limits.lowvpd >= out->limits.highvpd)
+        || out->limits.dewmargin < 0 || out->limits.dewmargin > USTEMP - LSTEMP)
+    {
+        fprintf(stderr,"%s: value out of range\n",fname);
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Parses the file and swaps in the new configuration
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctl pointer to configuration control
+ *  @return void
+*/
+static void GhConfigPublish(ghconfigctl_s * ctl)
+{
+    ghconfig_s * old;
+    ghconfig_s * next;
+    struct timespec t0,t1;
+
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    old = __atomic_load_n(&ctl->current,__ATOMIC_SEQ_CST);
+    next = (ghconfig_s *) malloc(sizeof(ghconfig_s));
+    if(next == NULL)
+    {
+        return;
+    }
+    if(!GhConfigParse(ctl->path,old,next))
+    {
+        fprintf(stderr,"Config %s rejected, keeping version %llu\n",ctl->path,(unsigned long long) old->version);
+        free(next);
+        return;
+    }
+    next->version = old->version + 1;
+    __atomic_store_n(&ctl->current,next,__ATOMIC_SEQ_CST);
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    if(!ctl->quiet)
+    {
+        fprintf(stdout,"Config version %llu loaded in %.2lf ms\n",(unsigned long long) next->version,
+            (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+    }
+
+    // Free the old version once the control loop has moved past it
+    while(__atomic_load_n(&ctl->inuse,__ATOMIC_SEQ_CST) == old)
+    {
+        if(__atomic_load_n(&ctl->stop,__ATOMIC_ACQUIRE))
+        {
+            return;     // still referenced; the loop is ending anyway
+        }
+        usleep(CONFIGRETIREUS);
+    }
+    free(old);
+}
+
+/** @brief Waits for file changes and reload requests
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to configuration control
+ *  @return void * NULL
+*/
+static void * GhConfigWatcher(void * arg)
+{
+    ghconfigctl_s * ctl = arg;
+    int reload;
+    ssize_t len;
+    uint64_t wake;
+    char * p;
+    const struct inotify_event * ie;
+    char buf[CONFIGEVBUFSZ] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfds[2];
+
+    pfds[0].fd = ctl->inotifyfd;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = ctl->wakefd;
+    pfds[1].events = POLLIN;
+    while(!__atomic_load_n(&ctl->stop,__ATOMIC_ACQUIRE))
+    {
+        if(poll(pfds,2,-1) <= 0)
+        {
+            continue;
+        }
+        reload = 0;
+        if(pfds[0].revents & POLLIN)
+        {
+            while((len = read(ctl->inotifyfd,buf,sizeof(buf))) > 0)
+            {
+                for(p = buf; p < buf + len; p += sizeof(struct inotify_event) + ie->len)
+                {
+                    ie = (const struct inotify_event *) p;
+                    if(ie->len > 0 && strcmp(ie->name,ctl->name) == 0)
+                    {
+                        reload = 1;
+                    }
+                }
+            }
+        }
+        if(pfds[1].revents & POLLIN)
+        {
+            if(read(ctl->wakefd,&wake,sizeof(wake)) == sizeof(wake))
+            {
+                reload = 1;
+            }
+        }
+        if(reload && !__atomic_load_n(&ctl->stop,__ATOMIC_ACQUIRE))
+        {
+            GhConfigPublish(ctl);
+        }
+    }
+    return NULL;
+}
+
+/** @brief Loads the configuration and starts watching it
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctl pointer to configuration control
+ *  @param fname pointer to configuration file name
+ *  @param spts setpoints used when the file is missing or invalid
+ *  @param limits alarm limits used when the file is missing or invalid
+ *  @return int 1 if the watcher is running, 0 if only the initial values are available
+*/
+int GhConfigStart(ghconfigctl_s * ctl, const char * fname, setpoint_s spts, alarmlimit_s limits)
+{
+    const char * slash;
+    ghconfig_s base = {0};
+    ghconfig_s * cfg;
+
+    memset(ctl,0,sizeof(ghconfigctl_s));
+    ctl->inotifyfd = -1;
+    ctl->wakefd = -1;
+    strncpy(ctl->path,fname,CONFIGPATHSZ - 1);
+    slash = strrchr(fname,'/');
+    if(slash == NULL)
+    {
+        strcpy(ctl->dir,".");
+        strncpy(ctl->name,fname,CONFIGPATHSZ - 1);
+    }
+    else
+    {
+        snprintf(ctl->dir,CONFIGPATHSZ,"%.*s",(int)(slash - fname),fname);
+        strncpy(ctl->name,slash + 1,CONFIGPATHSZ - 1);
+    }
+
+    base.spts = spts;
+    base.limits = limits;
+    cfg = (ghconfig_s *) malloc(sizeof(ghconfig_s));
+    if(cfg == NULL)
+    {
+        return 0;
+    }
+    if(!GhConfigParse(ctl->path,&base,cfg))
+    {
+        *cfg = base;
+    }
+    cfg->version = 1;
+    ctl->current = cfg;
+
+    // Watch the directory so editors that replace the file by rename are seen
+    ctl->inotifyfd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    ctl->wakefd = eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC);
+    if(ctl->inotifyfd == -1 || ctl->wakefd == -1
+        || inotify_add_watch(ctl->inotifyfd,ctl->dir,IN_CLOSE_WRITE | IN_MOVED_TO) == -1
+        || pthread_create(&ctl->tid,NULL,GhConfigWatcher,ctl) != 0)
+    {
+        perror("Error (configuration watcher)");
+        if(ctl->inotifyfd != -1)
+        {
+            close(ctl->inotifyfd);
+            ctl->inotifyfd = -1;
+        }
+        if(ctl->wakefd != -1)
+        {
+            close(ctl->wakefd);
+            ctl->wakefd = -1;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Gets the current configuration for this control cycle
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctl pointer to configuration control
+ *  @return const ghconfig_s * configuration, valid until the next call
+*/
+const ghconfig_s * GhConfigAcquire(ghconfigctl_s * ctl)
+{
+    ghconfig_s * cfg;
+    // Announce the pointer, then confirm it is still current so the watcher cannot free it
+    do
+    {
+        cfg = __atomic_load_n(&ctl->current,__ATOMIC_SEQ_CST);
+        __atomic_store_n(&ctl->inuse,cfg,__ATOMIC_SEQ_CST);
+    }
+    while(__atomic_load_n(&ctl->current,__ATOMIC_SEQ_CST) != cfg);
+    return cfg;
+}
+
+/** @brief Asks the watcher to re-read the file (e.g. on SIGHUP)
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctl pointer to configuration control
+ *  @return void
+*/
+void GhConfigReload(ghconfigctl_s * ctl)
+{
+    uint64_t one = 1;
+    if(ctl->wakefd != -1 && write(ctl->wakefd,&one,sizeof(one)) != sizeof(one))
+    {
+        perror("Error (configuration reload)");
+    }
+}
+
+/** @brief Stops the watcher and frees the configuration
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ctl pointer to configuration control
+ *  @return void
+*/
+void GhConfigStop(ghconfigctl_s * ctl)
+{
+    __atomic_store_n(&ctl->stop,1,__ATOMIC_RELEASE);
+    if(ctl->wakefd != -1)
+    {
+        GhConfigReload(ctl);
+        pthread_join(ctl->tid,NULL);
+        close(ctl->wakefd);
+        close(ctl->inotifyfd);
+    }
+    if(ctl->inuse != NULL && ctl->inuse != ctl->current)
+    {
+        free(ctl->inuse);
+    }
+    free(ctl->current);
+    ctl->current = NULL;
+    ctl->inuse = NULL;
+}
+
+/** @brief Reads the monotonic clock in nanoseconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t nanoseconds
+*/
+static int64_t GhConfigNowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Writes one benchmark version and renames it into place, as an editor would
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param b pointer to benchmark state
+ *  @param k version number
+ *  @return int 1 on success, 0 on error
+*/
+static int GhConfigBenchWrite(configbench_s * b, int k)
+{
+    FILE * fp;
+    char tmp[CONFIGPATHSZ + 4];
+    double t = CONFIGBENCHT0 + k * CONFIGBENCHSTEP;
+
+    snprintf(tmp,sizeof(tmp),"%s.new",b->path);
+    fp = fopen(tmp,"w");
+    if(fp == NULL)
+    {
+        return 0;
+    }
+    fprintf(fp,"# version %d\ntemperature = %.1lf\nhumidity = %.1lf\n",k,t,t + CONFIGBENCHGAP);
+    if(fclose(fp) != 0)
+    {
+        return 0;
+    }
+    __atomic_store_n(&b->at[k],GhConfigNowNs(),__ATOMIC_RELEASE);
+    return rename(tmp,b->path) == 0;
+}
+
+/** @brief Rewrites the benchmark file, each version once the loop has the last
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to benchmark state
+ *  @return void * always NULL
+*/
+static void * GhConfigBenchWriter(void * arg)
+{
+    configbench_s * b = (configbench_s *) arg;
+    int k;
+    int64_t due;
+
+    for(k=1; k<=CONFIGBENCHWRITES; k++)
+    {
+        if(!GhConfigBenchWrite(b,k))
+        {
+            perror(b->path);
+            break;
+        }
+        __atomic_store_n(&b->written,k,__ATOMIC_RELEASE);
+        due = GhConfigNowNs() + CONFIGBENCHWAITMS * 1000000LL;
+        while(__atomic_load_n(&b->seen,__ATOMIC_ACQUIRE) < k && GhConfigNowNs() < due)
+        {
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+/** @brief Writes a configuration and checks that it is rejected
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param path pointer to scratch file name
+ *  @param text file contents
+ *  @param base configuration supplying values for keys not in the file
+ *  @return int 1 if GhConfigParse() rejected it, 0 otherwise
+*/
+static int GhConfigBenchRejects(const char * path, const char * text, const ghconfig_s * base)
+{
+    FILE * fp = fopen(path,"w");
+    ghconfig_s out;
+
+    if(fp == NULL)
+    {
+        return 0;
+    }
+    fputs(text,fp);
+    fclose(fp);
+    return !GhConfigParse(path,base,&out);
+}
+
+/** @brief Rewrites a scratch configuration under a running loop, timing each reload
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if every version reached the loop whole, 0 otherwise
+*/
+int GhConfigReport(FILE * fp)
+{
+    int k;
+    int ok;
+    int tfd;
+    int torn = 0;
+    int done = 0;
+    int rejected;
+    uint64_t ticks = 0;
+    uint64_t missed = 0;
+    uint64_t expiries;
+    int64_t now;
+    int64_t t0;
+    int64_t acquire = 0;
+    int64_t lat;
+    int64_t latmin = INT64_MAX;
+    int64_t latmax = 0;
+    int64_t latsum = 0;
+    char dir[] = "/tmp/ghcXXXXXX";
+    char tmp[CONFIGPATHSZ + 4];
+    const ghconfig_s * cfg;
+    ghconfigctl_s ctl;
+    ghconfig_s base = {0};
+    setpoint_s spts = {0};
+    alarmlimit_s limits = GhSetAlarmLimits();
+    configbench_s * b = (configbench_s *) calloc(1,sizeof(configbench_s));
+    pthread_t tid;
+    struct itimerspec its = {{0,CONFIGBENCHMS * 1000000L},{0,CONFIGBENCHMS * 1000000L}};
+
+    // A scratch directory, so the real configuration is never touched
+    if(b == NULL || mkdtemp(dir) == NULL)
+    {
+        perror("Error (config report)");
+        free(b);
+        return 0;
+    }
+    snprintf(b->path,sizeof(b->path),"%s/%s",dir,CONFIGFILE);
+    tfd = timerfd_create(CLOCK_MONOTONIC,TFD_CLOEXEC);
+    ok = tfd != -1 && timerfd_settime(tfd,0,&its,NULL) == 0 && GhConfigBenchWrite(b,0)
+        && GhConfigStart(&ctl,b->path,spts,limits);
+    ctl.quiet = 1;
+    ok = ok && pthread_create(&tid,NULL,GhConfigBenchWriter,b) == 0;
+    if(!ok)
+    {
+        perror("Error (config report)");
+    }
+
+    // The stand-in loop takes the configuration every cycle, as ghc does
+    while(ok && !done)
+    {
+        if(read(tfd,&expiries,sizeof(expiries)) != sizeof(expiries))
+        {
+            continue;
+        }
+        ticks++;
+        missed += expiries - 1;
+        t0 = GhConfigNowNs();
+        cfg = GhConfigAcquire(&ctl);
+        now = GhConfigNowNs();
+        acquire = (now - t0 > acquire) ? now - t0 : acquire;
+        k = (int) lround((cfg->spts.temperature - CONFIGBENCHT0) / CONFIGBENCHSTEP);
+        torn += fabs(cfg->spts.humidity - cfg->spts.temperature - CONFIGBENCHGAP) > 1e-6 || k < 0 || k > CONFIGBENCHWRITES;
+        if(k > b->seen && k <= CONFIGBENCHWRITES)
+        {
+            lat = now - __atomic_load_n(&b->at[k],__ATOMIC_ACQUIRE);
+            latmin = (lat < latmin) ? lat : latmin;
+            latmax = (lat > latmax) ? lat : latmax;
+            latsum += lat;
+            __atomic_store_n(&b->seen,k,__ATOMIC_RELEASE);
+        }
+        done = b->seen == CONFIGBENCHWRITES
+            || (__atomic_load_n(&b->written,__ATOMIC_ACQUIRE) > b->seen && now - b->at[b->seen + 1] > CONFIGBENCHWAITMS * 1000000LL);
+    }
+    if(ok)
+    {
+        pthread_join(tid,NULL);
+        GhConfigStop(&ctl);
+    }
+    if(tfd != -1)
+    {
+        close(tfd);
+    }
+
+    // Values strtod accepts but no range test catches
+    base.spts = spts;
+    base.limits = limits;
+    rejected = GhConfigBenchRejects(b->path,"temperature = nan\n",&base) + GhConfigBenchRejects(b->path,"hight = inf\n",&base)
+        + GhConfigBenchRejects(b->path,"lowp = -nan\n",&base);
+    snprintf(tmp,sizeof(tmp),"%s.new",b->path);
+    unlink(tmp);
+    unlink(b->path);
+    rmdir(dir);
+
+    fprintf(fp,"Config reload, %d versions renamed into place under a %d ms loop\n",CONFIGBENCHWRITES,CONFIGBENCHMS);
+    if(b->seen > 0)
+    {
+        fprintf(fp,"Reload latency, rename to the loop's next acquire: min %.2lf, mean %.2lf, max %.2lf ms\n",
+            latmin / 1e6,latsum / 1e6 / b->seen,latmax / 1e6);
+    }
+    fprintf(fp,"Loop: %llu cycles, %llu missed, slowest acquire %.1lf us\n",(unsigned long long) ticks,
+        (unsigned long long) missed,acquire / 1e3);
+    fprintf(fp,"Versions reaching the loop: %d of %d, mixed: %d\n",b->seen,CONFIGBENCHWRITES,torn);
+    fprintf(fp,"Non-finite values rejected: %d of 3\n",rejected);
+    ok = ok && b->seen == CONFIGBENCHWRITES && torn == 0 && rejected == 3;
+    free(b);
+    return ok;
+}
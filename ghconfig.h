@@ -0,0 +1,71 @@
+/** @brief Gh runtime configuration constants, structures, function prototypes
+*   @file ghconfig.h
+*
+*   Setpoints and alarm limits live in a "key = value" text file watched
+*   with inotify. A watcher thread parses and validates each new version
+*   and publishes it by atomic pointer swap; the control loop only ever
+*   loads the current pointer, so it never blocks or sees a partial update.
+*/
+#ifndef GHCONFIG_H
+#define GHCONFIG_H
+
+// Includes
+#include <pthread.h>
+#include "ghcontrol.h"
+
+// Configuration Constants
+#define CONFIGFILE "ghc.conf"
+#define CONFIGPATHSZ 256
+#define CONFIGLINESZ 128
+#define CONFIGMINPRESS 300
+#define CONFIGMAXPRESS 1100
+#define CONFIGMAXVPD 5.0        // kPa
+#define CONFIGBENCHWRITES 50    // versions GhConfigReport() writes
+#define CONFIGBENCHMS 10        // ms period of its stand-in control loop
+#define CONFIGBENCHWAITMS 2000  // ms a version may take to reach the loop
+#define CONFIGBENCHT0 10.0      // version k sets temperature T0 + k * STEP
+#define CONFIGBENCHSTEP 0.1
+#define CONFIGBENCHGAP 20.0     // and humidity GAP above it, so a mixed version shows
+
+//Typedefs
+typedef struct ghconfig
+{
+    uint64_t version;
+    setpoint_s spts;
+    double vpd;                 // kPa humidity target, 0 to control spts.humidity
+    alarmlimit_s limits;
+}ghconfig_s;
+
+typedef struct ghconfigctl
+{
+    ghconfig_s * current;       // swapped by the watcher
+    ghconfig_s * inuse;         // announced by the control loop
+    pthread_t tid;
+    int inotifyfd;
+    int wakefd;
+    int stop;
+    int quiet;                  // 1 leaves reloads unreported
+    char dir[CONFIGPATHSZ];
+    char name[CONFIGPATHSZ];
+    char path[CONFIGPATHSZ];
+}ghconfigctl_s;
+
+typedef struct configbench
+{
+    char path[CONFIGPATHSZ];
+    int written;                // versions renamed into place
+    int seen;                   // newest version the loop has acquired
+    int64_t at[CONFIGBENCHWRITES + 1];  // monotonic ns each version was renamed into place
+}configbench_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhConfigParse(const char * fname, const ghconfig_s * base, ghconfig_s * out);
+int GhConfigStart(ghconfigctl_s * ctl, const char * fname, setpoint_s spts, alarmlimit_s limits);
+const ghconfig_s * GhConfigAcquire(ghconfigctl_s * ctl);
+void GhConfigReload(ghconfigctl_s * ctl);
+void GhConfigStop(ghconfigctl_s * ctl);
+int GhConfigReport(FILE * fp);
+///@endcond
+
+#endif
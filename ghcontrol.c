@@ -2,9 +2,13 @@
 *   @file ghcontrol.c
 */
 #include "ghcontrol.h"
+#include "ghderive.h"
 
 // Alarm Message Array
-const char alarmnames[NALARMS][ALARMNMSZ] = {"No Alarms","High Temperature","Low Temperature","High Humidity","Low Humidity","High Pressure","Low Pressure"};
+const char alarmnames[NALARMS][ALARMNMSZ] = {"No Alarms","High Temperature","Low Temperature","High Humidity","Low Humidity","High Pressure","Low Pressure","High VPD","Low VPD","Condensation","Sensor Fault"};
+
+// Pressure samples behind the latest reading
+static lps25hFifo_s pbatch;
 
 
 //Function Definitions
@@ -71,26 +75,6 @@ int GhGetRandom(int range)
 	return rand() % range;
 }
 
-/** @brief Delays Program/Functions
- *  @version 19FEB2021
- *  @author Jakob Wood
- *  @param int as milliseconds
- *  @return void
-*/
-void GhDelay(int milliseconds)
-{
-	long wait;
-	clock_t now,start;
-
-	wait = milliseconds*(CLOCKS_PER_SEC/1000);
-	start = clock();
-	now = start;
-	while( (now-start) < wait )
-	{
-		now = clock();
-	}
-}
-
 /** @brief Calls srand, SetTargets, and DisplayHeader functions
  *  @version 19FEB2021
  *  @author Jakob Wood
@@ -101,9 +85,6 @@ void GhControllerInit(void)
 {
 	srand((unsigned) time(NULL));
 	GhDisplayHeader("Jakob Wood");
-#if SENSEHAT
-    ShInit();
-#endif
 }
 
 /** @brief Prints Heater/Humidifier Controls
@@ -114,7 +95,8 @@ void GhControllerInit(void)
 */
 void GhDisplayControls(control_s ctrl)
 {
-	fprintf(stdout,"Controls\tHeater: %d\tHumidifier: %d\n",ctrl);
+	fprintf(stdout,"Controls\tHeater: %3.0lf%% %s\tHumidifier: %3.0lf%% %s\n",ctrl.heater,ctrl.heateron ? "(on)" : "(off)",
+		ctrl.humidifier,ctrl.humidifieron ? "(on)" : "(off)");
 }
 
 /** @brief Prints Readings
@@ -125,7 +107,8 @@ void GhDisplayControls(control_s ctrl)
 */
 void GhDisplayReadings(reading_s rdata)
 {
-    fprintf(stdout,"\nUnit: %LX %sReadings\tT: %4.1lfC\tH: %4.1lf%%\tP: %6.1lfmB\n",GhGetSerial(),ctime(&rdata.rtime),rdata.temperature,rdata.humidity,rdata.pressure);
+    fprintf(stdout,"\nUnit: %LX %sReadings\tT: %4.1lfC\tH: %4.1lf%%\tP: %6.1lfmB%s\n",GhGetSerial(),ctime(&rdata.rtime),rdata.temperature,rdata.humidity,rdata.pressure,
+        rdata.stale ? "\t(stale)" : "");
 }
 
 
@@ -153,21 +136,23 @@ control_s GhSetControls(setpoint_s target,reading_s rdata)
 
     if(rdata.temperature<target.temperature)
     {
-        cset.heater = ON;
+        cset.heateron = ON;
     }
     else
     {
-        cset.heater = OFF;
+        cset.heateron = OFF;
     }
 
     if(rdata.humidity<target.humidity)
     {
-        cset.humidifier = ON;
+        cset.humidifieron = ON;
     }
     else
     {
-        cset.humidifier = OFF;
+        cset.humidifieron = OFF;
     }
+    cset.heater = cset.heateron * 100.0;
+    cset.humidifier = cset.humidifieron * 100.0;
     return cset;
 }
 
@@ -191,72 +176,111 @@ setpoint_s GhSetTargets(void)
     return cpoints;
 }
 
-/** @brief Retrieves/Simulates Humidity
- *  @version 30MAR2021
+/** @brief Retrieves Humidity from the selected sensor backend
+ *  @version 18OCT2026
  *  @author Jakob Wood
  *  @param void
  *  @return double
 */
 double GhGetHumidity(void)
 {
-#if SIMHUMIDITY
-	return GhGetRandom(USHUMID-LSHUMID)+LSHUMID;
-#else
 	ht221sData_s ct = {0};
 	ct = ShGetHT221SData();
-	return ct.humidity;
-#endif
+	return ct.valid ? ct.humidity : NAN;
 }
 
-/** @brief Retrieves/Simulates Pressure
- *  @version 30MAR2021
+/** @brief Retrieves Pressure from the selected sensor backend
+ *  @version 18OCT2026
  *  @author Jakob Wood
  *  @param void
  *  @return double
 */
 double GhGetPressure(void)
 {
-#if SIMPRESSURE
-	return GhGetRandom(USPRESS-LSPRESS)+LSPRESS;
-#else
 	lps25hData_s ct = {0};
 	ct = ShGetLPS25HData();
-	return ct.pressure;
-#endif
+	return ct.valid ? ct.pressure : NAN;
 }
 
-/** @brief Retrieves/Simulates Temperature
- *  @version 30MAR2021
+/** @brief Retrieves Temperature from the selected sensor backend
+ *  @version 18OCT2026
  *  @author Jakob Wood
  *  @param void
  *  @return double
 */
 double GhGetTemperature(void)
 {
-#if SIMTEMPERATURE
-	return GhGetRandom(USTEMP-LSTEMP)+LSTEMP;
-#else
 	ht221sData_s ct = {0};
 	ct = ShGetHT221SData();
-    return ct.temperature;
-#endif
+    return ct.valid ? ct.temperature : NAN;
 }
 
 
 /** @brief Retrieves Readings
- *  @version 07APRIL2021
+ *  @version 18OCT2026
  *  @author Jakob Wood
  *  @param void
- *  @return object of readings type
+ *  @return object of readings type, failed sensors hold their last good value and are flagged stale
 */
 reading_s GhGetReadings(void)
 {
-    reading_s now = {0};
-    now.rtime = time(NULL);
-    now.temperature = GhGetTemperature();
-    now.humidity = GhGetHumidity();
-    now.pressure = GhGetPressure();
-	return now;
+    static double last[SENSORS] = {NAN,NAN,NAN};
+    double now[SENSORS];
+    reading_s rd = {0};
+    int i;
+    rd.rtime = time(NULL);
+
+    // One HTS221 conversion gives both temperature and humidity
+    ht221sData_s ht = ShGetHT221SData();
+    now[TEMPERATURE] = ht.valid ? ht.temperature : NAN;
+    now[HUMIDITY] = ht.valid ? ht.humidity : NAN;
+    rd.raw[TEMPERATURE] = ht.rawtemperature;
+    rd.raw[HUMIDITY] = ht.rawhumidity;
+    rd.calid = ht.calid;
+
+    // The mean of every sample the LPS25H queued since the last reading,
+    // or a single conversion from a backend without a FIFO
+    lps25hData_s lp = ShGetLPS25HFifo(&pbatch);
+    now[PRESSURE] = lp.valid ? lp.pressure : NAN;
+    rd.raw[PRESSURE] = lp.rawpressure;
+    for(i=0; i<SENSORS; i++)
+    {
+        if(isnan(now[i]))
+        {
+            now[i] = last[i];
+            rd.stale |= 1 << i;
+        }
+        last[i] = now[i];
+    }
+    rd.temperature = now[TEMPERATURE];
+    rd.humidity = now[HUMIDITY];
+    rd.pressure = now[PRESSURE];
+	return rd;
+}
+
+/** @brief Replaces the values failed sensors are holding with NAN
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param rdata object of readings data
+ *  @return object of readings type, only the channels still reading keep a value
+*/
+reading_s GhLiveReadings(reading_s rdata)
+{
+    rdata.temperature = (rdata.stale & (1 << TEMPERATURE)) ? NAN : rdata.temperature;
+    rdata.humidity = (rdata.stale & (1 << HUMIDITY)) ? NAN : rdata.humidity;
+    rdata.pressure = (rdata.stale & (1 << PRESSURE)) ? NAN : rdata.pressure;
+    return rdata;
+}
+
+/** @brief Gets the pressure samples behind the latest reading
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return pointer to the LPS25H FIFO batch, one sample from a backend without a FIFO
+*/
+const lps25hFifo_s * GhGetPressureBatch(void)
+{
+    return &pbatch;
 }
 
 /** @brief Logs Gh Data
@@ -264,9 +288,10 @@ reading_s GhGetReadings(void)
  *  @author Jakob Wood
  *  @param fname pointer to file name
  *  @param object of readings data
- *  @return int
+ *  @param drv pointer to the sample's derived metrics, used with LOGDERIVED
+ *  @return int 1 if the sample was written, 0 on error
 */
-int GhLogData(char * fname, reading_s ghdata)
+int GhLogData(char * fname, reading_s ghdata, derived_s * drv)
 {
     FILE *fp;
     char ltime[CTIMESTRSZ];
@@ -281,32 +306,132 @@ int GhLogData(char * fname, reading_s ghdata)
     ltime[10] = ',';
     ltime[19] = ',';
     fprintf(fp, "\n%.24s,%5.1lf,%5.1lf,%6.1lf",ltime,ghdata.temperature,ghdata.humidity,ghdata.pressure);
-    fclose(fp);
-    return 1;
+#if LOGRAW
+    if(ghdata.calid != 0)
+    {
+        fprintf(fp,",r,%d,%d,%d,%08x",ghdata.raw[TEMPERATURE],ghdata.raw[HUMIDITY],ghdata.raw[PRESSURE],ghdata.calid);
+        GhLogCalibration(LOGCALFILE,ghdata.calid);
+    }
+#endif
+#if LOGDERIVED
+    fprintf(fp,",d,%.1lf,%.2lf",GhDerived(drv,DEWPOINT),GhDerived(drv,VPD));
+#else
+    (void) drv;
+#endif
+    return fclose(fp) == 0;
+}
+
+/** @brief Records the calibration behind logged raw counts
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to registry file name
+ *  @param calid calibration id found in the readings
+ *  @return int 1 if the registry holds the set, 0 on error
+*/
+int GhLogCalibration(char * fname, uint32_t calid)
+{
+    static uint32_t saved = 0;
+    shcal_s hc;
+    logcal_s cal = {0};
 
+    if(calid == saved)
+    {
+        return 1;
+    }
+    hc = ShHTS221Calibration();
+    if(!hc.valid || hc.id != calid)
+    {
+        return 0;
+    }
+    cal.id = calid;
+    cal.gain[TEMPERATURE] = hc.t_gradient_m;
+    cal.offset[TEMPERATURE] = hc.t_intercept_c;
+    cal.gain[HUMIDITY] = hc.h_gradient_m;
+    cal.offset[HUMIDITY] = hc.h_intercept_c;
+    cal.gain[PRESSURE] = 1.0 / 4096.0;
+    cal.offset[PRESSURE] = 0.0;
+    if(!GhLogSaveCal(fname,&cal))
+    {
+        return 0;
+    }
+    saved = calid;
+    return 1;
 }
 
-/** @brief Saves Target Data
- *  @version 07APRIL2021
+/** @brief Replaces a file so readers see either the old or the new contents
+ *  @version 18OCT2026
  *  @author Jakob Wood
  *  @param fname pointer to file name
- *  @param object of setpoint data
- *  @return int
+ *  @param buf pointer to the new contents
+ *  @param len number of bytes
+ *  @return int 1 on success, 0 on error (the old file is left untouched)
 */
-int GhSaveSetpoints(char * fname, setpoint_s spts)
+int GhWriteAtomic(const char * fname, const void * buf, size_t len)
 {
-    FILE *fp;
-    fp = fopen(fname, "w");
-    if(fp == NULL)
+    int fd;
+    int ok;
+    ssize_t n;
+    size_t done = 0;
+    const char * slash;
+    char tmp[FILEPATHSZ];
+    char dir[FILEPATHSZ];
+
+    if(snprintf(tmp,sizeof(tmp),"%s.tmp",fname) >= (int) sizeof(tmp))
+    {
+        return 0;
+    }
+    fd = open(tmp,O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,0644);
+    if(fd == -1)
+    {
+        return 0;
+    }
+    while(done < len)
+    {
+        n = write(fd,(const char *) buf + done,len - done);
+        if(n <= 0)
+        {
+            break;
+        }
+        done += n;
+    }
+    // Data must be on disk before the rename makes it visible
+    ok = (done == len) && (fsync(fd) == 0);
+    ok = (close(fd) == 0) && ok;
+    if(!ok || rename(tmp,fname) == -1)
     {
+        unlink(tmp);
         return 0;
     }
+
+    // Persist the rename itself
+    slash = strrchr(fname,'/');
+    if(slash == NULL)
+    {
+        strcpy(dir,".");
+    }
     else
     {
-        fwrite(&spts,sizeof(spts),1,fp);
-        fclose(fp);
-        return 1;
+        snprintf(dir,sizeof(dir),"%.*s",(int)(slash - fname + 1),fname);
     }
+    fd = open(dir,O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd != -1)
+    {
+        fsync(fd);
+        close(fd);
+    }
+    return 1;
+}
+
+/** @brief Saves Target Data
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param object of setpoint data
+ *  @return int
+*/
+int GhSaveSetpoints(char * fname, setpoint_s spts)
+{
+    return GhWriteAtomic(fname,&spts,sizeof(spts));
 }
 
 /** @brief Retreives Target Data
@@ -326,7 +451,10 @@ setpoint_s GhRetrieveSetpoints(char * fname)
     }
     else
     {
-        fread(&spts,sizeof(spts),1,fp);
+        if(fread(&spts,sizeof(spts),1,fp) != 1)
+        {
+            memset(&spts,0,sizeof(spts));
+        }
         fclose(fp);
         return spts;
     }
@@ -393,6 +521,9 @@ alarmlimit_s GhSetAlarmLimits(void)
     calarm.lowh = LOWERAHUMID;
     calarm.highp = UPPERAPRESS;
     calarm.lowp = LOWERAPRESS;
+    calarm.highvpd = UPPERAVPD;
+    calarm.lowvpd = LOWERAVPD;
+    calarm.dewmargin = ADEWMARGIN;
     return calarm;
 }
 
@@ -402,59 +533,78 @@ alarmlimit_s GhSetAlarmLimits(void)
  *  @param pointer to alarm_s type
  *  @param object of alarm limits type
  *  @param object of readings type
- *  @return void
+ *  @return pointer to alarm_s type
 */
 alarm_s * GhSetAlarms(alarm_s * head,alarmlimit_s alarmpt,reading_s rdata)
 {
-    if (rdata.temperature >= alarmpt.hight)
-    {
-        GhSetOneAlarm(HTEMP,rdata.rtime,rdata.temperature,head);
-    }
-    else
+    // A failed sensor raises its own alarm (value: the stale bits), and the
+    // value it holds is not judged again, so its alarms stay as they were
+    if (rdata.stale != 0)
     {
-        head = GhClearOneAlarm(HTEMP,head);
-    }
-    return head;
-    if (rdata.pressure >= alarmpt.highp)
-    {
-        GhSetOneAlarm(HPRESS,rdata.rtime,rdata.pressure,head);
+        GhSetOneAlarm(SENSORFAULT,rdata.rtime,(double) rdata.stale,head);
     }
     else
     {
-        head = GhClearOneAlarm(HPRESS,head);
-    }
-    if (rdata.humidity >= alarmpt.highh)
-    {
-        GhSetOneAlarm(HHUMID,rdata.rtime,rdata.humidity,head);
+        head = GhClearOneAlarm(SENSORFAULT,head);
     }
-    else
+    if (!(rdata.stale & (1 << TEMPERATURE)))
     {
-        head = GhClearOneAlarm(HHUMID,head);
-    }
+        if (rdata.temperature >= alarmpt.hight)
+        {
+            GhSetOneAlarm(HTEMP,rdata.rtime,rdata.temperature,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(HTEMP,head);
+        }
         if (rdata.temperature <= alarmpt.lowt)
-    {
-        GhSetOneAlarm(LTEMP,rdata.rtime,rdata.temperature,head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(LTEMP,head);
-    }
-    if (rdata.pressure <= alarmpt.lowp)
-    {
-        GhSetOneAlarm(LPRESS,rdata.rtime,rdata.pressure,head);
-    }
-    else
-    {
-        head = GhClearOneAlarm(LPRESS,head);
+        {
+            GhSetOneAlarm(LTEMP,rdata.rtime,rdata.temperature,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(LTEMP,head);
+        }
     }
-    if (rdata.humidity <= alarmpt.lowh)
+    if (!(rdata.stale & (1 << PRESSURE)))
     {
-        GhSetOneAlarm(LHUMID,rdata.rtime,rdata.humidity,head);
+        if (rdata.pressure >= alarmpt.highp)
+        {
+            GhSetOneAlarm(HPRESS,rdata.rtime,rdata.pressure,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(HPRESS,head);
+        }
+        if (rdata.pressure <= alarmpt.lowp)
+        {
+            GhSetOneAlarm(LPRESS,rdata.rtime,rdata.pressure,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(LPRESS,head);
+        }
     }
-    else
+    if (!(rdata.stale & (1 << HUMIDITY)))
     {
-        head = GhClearOneAlarm(LHUMID,head);
+        if (rdata.humidity >= alarmpt.highh)
+        {
+            GhSetOneAlarm(HHUMID,rdata.rtime,rdata.humidity,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(HHUMID,head);
+        }
+        if (rdata.humidity <= alarmpt.lowh)
+        {
+            GhSetOneAlarm(LHUMID,rdata.rtime,rdata.humidity,head);
+        }
+        else
+        {
+            head = GhClearOneAlarm(LHUMID,head);
+        }
     }
+    return head;
 }
 
 /** @brief Displays Alarms
@@ -466,39 +616,12 @@ alarm_s * GhSetAlarms(alarm_s * head,alarmlimit_s alarmpt,reading_s rdata)
 void GhDisplayAlarms(alarm_s * head)
 {
     alarm_s *cur;
-    cur = head;
     fprintf(stdout,"\nAlarms\n");
-    while (cur != NULL)
+    for(cur = head; cur != NULL; cur = cur->next)
     {
-        if (cur->code == HTEMP)
-        {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[HTEMP],ctime(&cur->atime));
-            cur = cur->next;
-        }
-        else if (cur->code == LTEMP)
-        {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[LTEMP],ctime(&cur->atime));
-            cur = cur->next;
-        }
-        else if (cur->code == HHUMID)
+        if(cur->code != NOALARM)
         {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[HHUMID],ctime(&cur->atime));
-            cur = cur->next;
-        }
-        else if (cur->code == LHUMID)
-        {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[LHUMID],ctime(&cur->atime));
-            cur = cur->next;
-        }
-        else if (cur->code == HPRESS)
-        {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[HPRESS],ctime(&cur->atime));
-            cur = cur->next;
-        }
-        else if (cur->code == LPRESS)
-        {
-            fprintf(stdout,"%s Alarm on %s",alarmnames[LPRESS],ctime(&cur[NALARMS].atime));
-            cur = cur->next;
+            fprintf(stdout,"%s Alarm on %s",alarmnames[cur->code],ctime(&cur->atime));
         }
     }
 }
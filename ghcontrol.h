@@ -11,7 +11,9 @@
 #include <stdint.h>
 #include <string.h>
 #include <string.h>
+#include <math.h>
 #include "pisensehat.h"
+#include "ghlog.h"
 
 // Constants
 #define SEARCHSTR "serial\t\t:"
@@ -27,8 +29,7 @@
 #define TBAR 7
 #define HBAR 5
 #define PBAR 3
-#define SENSEHAT 1
-#define NALARMS 7
+#define NALARMS 11
 #define ALARMNMSZ 18
 #define LOWERATEMP 10
 #define UPPERATEMP 30
@@ -36,18 +37,18 @@
 #define UPPERAHUMID 70
 #define LOWERAPRESS 985
 #define UPPERAPRESS 1016
+#define LOWERAVPD 0.3            // kPa, 0 disables
+#define UPPERAVPD 2.0            // kPa, 0 disables
+#define ADEWMARGIN 1.0           // C between the temperature and the dew point, 0 disables
+#define FILEPATHSZ 256
 
 // Simulation Constants
-#define SIMULATE 1
 #define USTEMP 50
 #define LSTEMP -10
 #define USHUMID 100
 #define LSHUMID 0
 #define USPRESS 1016
 #define LSPRESS 975
-#define SIMTEMPERATURE 0
-#define SIMHUMIDITY 0
-#define SIMPRESSURE 0
 
 
 // Control Constants
@@ -57,7 +58,8 @@
 #define OFF 0
 
 //Enumerated Types
-typedef enum { NOALARM, HTEMP, LTEMP, HHUMID, LHUMID, HPRESS, LPRESS } alarm_e;
+typedef enum { NOALARM, HTEMP, LTEMP, HHUMID, LHUMID, HPRESS, LPRESS, HVPD, LVPD, CONDENSE, SENSORFAULT } alarm_e;
+typedef enum { DEWPOINT, VPD, ABSHUMID, ENTHALPY, NDERIVED } derived_e;
 
 //Typedefs
 typedef struct readings
@@ -66,8 +68,19 @@ typedef struct readings
     double temperature;
     double humidity;
     double pressure;
+    int stale;          // bit (1 << TEMPERATURE etc.) set while a sensor holds its last good value
+    int32_t raw[SENSORS];   // ADC counts behind the values, valid when calid is not 0
+    uint32_t calid;
 }reading_s;
 
+typedef struct derived
+{
+    reading_s rdata;            // sample the cache belongs to
+    uint32_t valid;             // bit (1 << metric) once computed for rdata
+    double es;                  // hPa, saturation vapour pressure, valid with DRVESBIT
+    double value[NDERIVED];
+}derived_s;
+
 typedef struct setpoints
 {
     double temperature;
@@ -76,8 +89,10 @@ typedef struct setpoints
 
 typedef struct controls
 {
-    int heater;
-    int humidifier;
+    double heater;          // % duty cycle, 0 to 100
+    double humidifier;
+    int heateron;           // relay outputs at this instant, ON or OFF
+    int humidifieron;
 }control_s;
 
 typedef struct alarmlimits
@@ -88,6 +103,9 @@ typedef struct alarmlimits
     double lowh;
     double highp;
     double lowp;
+    double highvpd;
+    double lowvpd;
+    double dewmargin;
 }alarmlimit_s;
 
 typedef struct alarms
@@ -98,12 +116,14 @@ typedef struct alarms
     struct alarms * next;
 }alarm_s;
 
+// Alarm Message Array
+extern const char alarmnames[NALARMS][ALARMNMSZ];
+
 // Function Prototypes
 ///@cond INTERNAL
 void GhDisplayHeader(const char * sname);
 uint64_t GhGetSerial(void);
 int GhGetRandom(int range);
-void GhDelay(int milliseconds);
 void GhControllerInit(void);
 void GhDisplayControls(control_s ctrl);
 void GhDisplayReadings(reading_s rdata);
@@ -114,7 +134,11 @@ double GhGetHumidity(void);
 double GhGetPressue(void);
 double GhGetTemperature(void);
 reading_s GhGetReadings(void);
-int GhLogData(char * fname,reading_s ghdata);
+reading_s GhLiveReadings(reading_s rdata);
+const lps25hFifo_s * GhGetPressureBatch(void);
+int GhLogData(char * fname,reading_s ghdata,derived_s * drv);
+int GhLogCalibration(char * fname, uint32_t calid);
+int GhWriteAtomic(const char * fname, const void * buf, size_t len);
 int GhSaveSetpoints(char * fname,setpoint_s spts);
 setpoint_s GhRetrieveSetpoints(char * fname);
 void GhDisplayAll(reading_s rd,setpoint_s sd);
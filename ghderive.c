@@ -0,0 +1,175 @@
+/** @brief Gh derived metric functions
+*   @file ghderive.c
+*/
+#include "ghderive.h"
+
+/** @brief Evaluates the Magnus saturation vapour pressure
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param t temperature in C
+ *  @return double es in hPa
+*/
+static inline double GhDerivedEs(double t)
+{
+#if DRVFAST
+    // Degree 7 Chebyshev fit of the Magnus curve in x = (t - 20) / 30,
+    // which stands in for the division and the exp() from LSTEMP to USTEMP
+    static const double p[8] = {23.325964652766853,43.29917813946473,35.25042935889744,16.264998020784372,
+        4.537907892244916,0.7298405745891032,0.04664860658789571,-0.003381170299098457};
+    double x = (t - 20.0) * (1.0 / 30.0);
+    if(t >= LSTEMP && t <= USTEMP)
+    {
+        return p[0] + x * (p[1] + x * (p[2] + x * (p[3] + x * (p[4] + x * (p[5] + x * (p[6] + x * p[7]))))));
+    }
+#endif
+    return DRVMAGC * exp(DRVMAGA * t / (DRVMAGB + t));
+}
+
+/** @brief Moves a cache to a sample, keeping it if the sample is unchanged
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param drv pointer to derived metric cache
+ *  @param rdata object of readings type
+ *  @return void
+*/
+void GhDerivedSample(derived_s * drv, reading_s rdata)
+{
+    if(drv->rdata.rtime == rdata.rtime && drv->rdata.temperature == rdata.temperature
+        && drv->rdata.humidity == rdata.humidity && drv->rdata.pressure == rdata.pressure)
+    {
+        return;
+    }
+    drv->rdata = rdata;
+    drv->valid = 0;
+}
+
+/** @brief Returns a derived metric, computing it on first use
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param drv pointer to derived metric cache
+ *  @param metric DEWPOINT (C), VPD (kPa), ABSHUMID (g/m3) or ENTHALPY (kJ/kg dry air)
+ *  @return double metric value, NAN without a valid temperature and humidity
+*/
+double GhDerived(derived_s * drv, derived_e metric)
+{
+    double t = drv->rdata.temperature;
+    double rh;
+    double ea;
+    double gamma;
+
+    if(drv->valid & (1u << metric))
+    {
+        return drv->value[metric];
+    }
+    if(!isfinite(t) || !isfinite(drv->rdata.humidity) || t <= -DRVMAGB)
+    {
+        drv->value[metric] = NAN;
+        drv->valid |= 1u << metric;
+        return NAN;
+    }
+    rh = fmin(fmax(drv->rdata.humidity,DRVMINRH),100.0);
+
+    // The dew point needs a log but no exp; the others share es(t)
+    if(metric == DEWPOINT)
+    {
+        gamma = log(rh / 100.0) + DRVMAGA * t / (DRVMAGB + t);
+        drv->value[DEWPOINT] = DRVMAGB * gamma / (DRVMAGA - gamma);
+        drv->valid |= 1u << DEWPOINT;
+        return drv->value[DEWPOINT];
+    }
+    if(!(drv->valid & DRVESBIT))
+    {
+        drv->es = GhDerivedEs(t);
+        drv->valid |= DRVESBIT;
+    }
+    ea = drv->es * rh / 100.0;
+    switch(metric)
+    {
+        case VPD:
+            drv->value[VPD] = (drv->es - ea) / 10.0;
+            break;
+        case ABSHUMID:
+            drv->value[ABSHUMID] = DRVAHK * ea / (t + DRVKELVIN);
+            break;
+        default:
+            drv->value[ENTHALPY] = (drv->rdata.pressure > ea)
+                ? DRVCPA * t + DRVEPS * ea / (drv->rdata.pressure - ea) * (DRVLV + DRVCPV * t) : NAN;
+            break;
+    }
+    drv->valid |= 1u << metric;
+    return drv->value[metric];
+}
+
+/** @brief Finds the humidity that gives a VPD at the sample's temperature
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param drv pointer to derived metric cache
+ *  @param vpd target VPD in kPa
+ *  @param humidity humidity returned when the temperature is not valid
+ *  @return double %RH target, within LSHUMID to USHUMID
+*/
+double GhDerivedHumidityFor(derived_s * drv, double vpd, double humidity)
+{
+    double es;
+    if(isnan(GhDerived(drv,VPD)))
+    {
+        return humidity;
+    }
+    es = drv->es;
+    return fmin(fmax(100.0 * (1.0 - 10.0 * vpd / es),LSHUMID),USHUMID);
+}
+
+/** @brief Sets and clears the alarms on derived metrics
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param head pointer to alarm_s list
+ *  @param alarmpt object of alarm limits type, a limit of 0 is not checked
+ *  @param drv pointer to derived metric cache
+ *  @return pointer to alarm_s list
+*/
+alarm_s * GhDerivedAlarms(alarm_s * head, alarmlimit_s alarmpt, derived_s * drv)
+{
+    time_t atime = drv->rdata.rtime;
+
+    // Without a live temperature and humidity there is nothing to judge; hold
+    if(drv->rdata.stale & ((1 << TEMPERATURE) | (1 << HUMIDITY)))
+    {
+        return head;
+    }
+    if(alarmpt.highvpd > 0 && GhDerived(drv,VPD) >= alarmpt.highvpd)
+    {
+        GhSetOneAlarm(HVPD,atime,GhDerived(drv,VPD),head);
+    }
+    else
+    {
+        head = GhClearOneAlarm(HVPD,head);
+    }
+    if(alarmpt.lowvpd > 0 && GhDerived(drv,VPD) <= alarmpt.lowvpd)
+    {
+        GhSetOneAlarm(LVPD,atime,GhDerived(drv,VPD),head);
+    }
+    else
+    {
+        head = GhClearOneAlarm(LVPD,head);
+    }
+    if(alarmpt.dewmargin > 0 && drv->rdata.temperature - GhDerived(drv,DEWPOINT) <= alarmpt.dewmargin)
+    {
+        GhSetOneAlarm(CONDENSE,atime,GhDerived(drv,DEWPOINT),head);
+    }
+    else
+    {
+        head = GhClearOneAlarm(CONDENSE,head);
+    }
+    return head;
+}
+
+/** @brief Prints the dew point and VPD
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param drv pointer to derived metric cache
+ *  @return void
+*/
+void GhDerivedDisplay(derived_s * drv)
+{
+    fprintf(stdout,"Derived\t\tDew: %4.1lfC\tVPD: %4.2lfkPa\n",GhDerived(drv,DEWPOINT),GhDerived(drv,VPD));
+}
@@ -0,0 +1,46 @@
+/** @brief Gh derived metric constants, function prototypes
+*   @file ghderive.h
+*
+*   Dew point, vapour-pressure deficit, absolute humidity and enthalpy
+*   follow from a temperature, humidity and pressure sample through the
+*   Magnus saturation vapour pressure. A derived_s cache belongs to one
+*   sample: GhDerivedSample() moves it to a new sample and GhDerived()
+*   computes a metric the first time a consumer asks for it, so a sample
+*   nobody looks at past the readings costs no exp() or log().
+*
+*   With DRVFAST the saturation vapour pressure from LSTEMP to USTEMP is a
+*   degree 7 polynomial instead of a division and an exp(). It is within
+*   2e-6 of the Magnus value (relative), so the VPD moves by less than
+*   1e-6 kPa, far below the Magnus fit's own error. The dew point keeps
+*   libm's log(), which is as fast as any short replacement.
+*/
+#ifndef GHDERIVE_H
+#define GHDERIVE_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Derived Metric Constants
+#define DRVFAST 1               // 1 evaluates the saturation vapour pressure by polynomial
+#define DRVMAGA 17.62           // Magnus fit over water (WMO)
+#define DRVMAGB 243.12          // C
+#define DRVMAGC 6.112           // hPa
+#define DRVMINRH 1.0            // %RH floor, the dew point runs to -inf at 0
+#define DRVKELVIN 273.15
+#define DRVAHK 216.68           // g K / (m3 hPa), 100 / Rv for water vapour
+#define DRVEPS 0.622            // ratio of water to dry air molar mass
+#define DRVCPA 1.006            // kJ/(kg K), dry air
+#define DRVCPV 1.86             // kJ/(kg K), water vapour
+#define DRVLV 2501.0            // kJ/kg, latent heat at 0 C
+#define DRVESBIT (1u << NDERIVED)   // valid bit of the shared es term
+
+// Function Prototypes
+///@cond INTERNAL
+void GhDerivedSample(derived_s * drv, reading_s rdata);
+double GhDerived(derived_s * drv, derived_e metric);
+double GhDerivedHumidityFor(derived_s * drv, double vpd, double humidity);
+alarm_s * GhDerivedAlarms(alarm_s * head, alarmlimit_s alarmpt, derived_s * drv);
+void GhDerivedDisplay(derived_s * drv);
+///@endcond
+
+#endif
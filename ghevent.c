@@ -0,0 +1,177 @@
+/** @brief Gh event loop functions
+*   @file ghevent.c
+*
+*   One epoll instance multiplexes the cycle timer (timerfd), termination
+*   and reload signals (signalfd) and any other descriptors the controller
+*   watches, so the process sleeps in the kernel between events.
+*/
+#include <errno.h>
+#include "ghevent.h"
+
+/** @brief Creates the epoll instance, cycle timer and signal descriptor
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @param milliseconds cycle period; the first expiry is immediate
+ *  @return int 1 on success, 0 on error
+*/
+int GhEventInit(ghevent_s * ev, int milliseconds)
+{
+    sigset_t mask;
+    struct itimerspec its = {0};
+
+    ev->epfd = -1;
+    ev->timerfd = -1;
+    ev->sigfd = -1;
+
+    // Block the signals before any thread starts so only signalfd sees them
+    sigemptyset(&mask);
+    sigaddset(&mask,SIGTERM);
+    sigaddset(&mask,SIGINT);
+    sigaddset(&mask,SIGHUP);
+    if(sigprocmask(SIG_BLOCK,&mask,NULL) == -1)
+    {
+        perror("Error (call to 'sigprocmask')");
+        return 0;
+    }
+
+    ev->epfd = epoll_create1(EPOLL_CLOEXEC);
+    ev->sigfd = signalfd(-1,&mask,SFD_NONBLOCK | SFD_CLOEXEC);
+    ev->timerfd = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+    if(ev->epfd == -1 || ev->sigfd == -1 || ev->timerfd == -1)
+    {
+        perror("Error (event loop descriptors)");
+        GhEventClose(ev);
+        return 0;
+    }
+
+    its.it_value.tv_nsec = 1;
+    its.it_interval.tv_sec = milliseconds / 1000;
+    its.it_interval.tv_nsec = (milliseconds % 1000) * 1000000L;
+    if(timerfd_settime(ev->timerfd,0,&its,NULL) == -1
+        || !GhEventAdd(ev,ev->timerfd,EVTIMER) || !GhEventAdd(ev,ev->sigfd,EVSIGNAL))
+    {
+        perror("Error (event loop setup)");
+        GhEventClose(ev);
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Adds a readable descriptor to the event loop
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @param fd descriptor to watch
+ *  @param source tag returned by GhEventWait
+ *  @return int 1 on success, 0 on error
+*/
+int GhEventAdd(ghevent_s * ev, int fd, evsource_e source)
+{
+    struct epoll_event ee = {0};
+    ee.events = EPOLLIN;
+    ee.data.u32 = source;
+    return epoll_ctl(ev->epfd,EPOLL_CTL_ADD,fd,&ee) == 0;
+}
+
+/** @brief Sleeps until at least one source is ready
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @param sources array filled with ready sources
+ *  @param max size of the sources array
+ *  @return int number of ready sources, 0 if interrupted
+*/
+int GhEventWait(ghevent_s * ev, evsource_e * sources, int max)
+{
+    int k;
+    int n;
+    struct epoll_event evs[EVTMAXEVENTS];
+    if(max > EVTMAXEVENTS)
+    {
+        max = EVTMAXEVENTS;
+    }
+    n = epoll_wait(ev->epfd,evs,max,-1);
+    if(n == -1)
+    {
+        return 0;
+    }
+    for(k=0; k<n; k++)
+    {
+        sources[k] = (evsource_e) evs[k].data.u32;
+    }
+    return n;
+}
+
+/** @brief Changes the cycle period, counting from now
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @param milliseconds new period
+ *  @return int 1 on success, 0 on error
+*/
+int GhEventPeriod(ghevent_s * ev, int milliseconds)
+{
+    struct itimerspec its = {0};
+    its.it_value.tv_sec = milliseconds / 1000;
+    its.it_value.tv_nsec = (milliseconds % 1000) * 1000000L;
+    its.it_interval = its.it_value;
+    return timerfd_settime(ev->timerfd,0,&its,NULL) == 0;
+}
+
+/** @brief Acknowledges the cycle timer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @return uint64_t number of expiries since the last call (more than 1 means missed cycles)
+*/
+uint64_t GhEventTimer(ghevent_s * ev)
+{
+    uint64_t expiries = 0;
+    if(read(ev->timerfd,&expiries,sizeof(expiries)) != sizeof(expiries))
+    {
+        return 0;
+    }
+    return expiries;
+}
+
+/** @brief Reads one pending signal
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @return int signal number, 0 if none is pending
+*/
+int GhEventSignal(ghevent_s * ev)
+{
+    struct signalfd_siginfo si;
+    if(read(ev->sigfd,&si,sizeof(si)) != sizeof(si))
+    {
+        return 0;
+    }
+    return (int) si.ssi_signo;
+}
+
+/** @brief Closes the event loop descriptors
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ev pointer to event loop
+ *  @return void
+*/
+void GhEventClose(ghevent_s * ev)
+{
+    if(ev->timerfd != -1)
+    {
+        close(ev->timerfd);
+        ev->timerfd = -1;
+    }
+    if(ev->sigfd != -1)
+    {
+        close(ev->sigfd);
+        ev->sigfd = -1;
+    }
+    if(ev->epfd != -1)
+    {
+        close(ev->epfd);
+        ev->epfd = -1;
+    }
+}
@@ -0,0 +1,39 @@
+/** @brief Gh event loop constants, structures, function prototypes
+*   @file ghevent.h
+*/
+#ifndef GHEVENT_H
+#define GHEVENT_H
+
+// Includes
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include "ghcontrol.h"
+
+// Event Loop Constants
+#define EVTMAXEVENTS 8
+
+//Enumerated Types
+typedef enum { EVTIMER, EVSIGNAL, EVSERVER, EVOUTPUT, EVACTUATOR, EVMATRIX } evsource_e;
+
+//Typedefs
+typedef struct ghevent
+{
+    int epfd;
+    int timerfd;
+    int sigfd;
+}ghevent_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhEventInit(ghevent_s * ev, int milliseconds);
+int GhEventAdd(ghevent_s * ev, int fd, evsource_e source);
+int GhEventWait(ghevent_s * ev, evsource_e * sources, int max);
+int GhEventPeriod(ghevent_s * ev, int milliseconds);
+uint64_t GhEventTimer(ghevent_s * ev);
+int GhEventSignal(ghevent_s * ev);
+void GhEventClose(ghevent_s * ev);
+///@endcond
+
+#endif
@@ -0,0 +1,387 @@
+/** @brief Gh reading filter functions
+*   @file ghfilter.c
+*/
+#include "ghfilter.h"
+#include "ghplant.h"
+
+/** @brief Sets up the default filter chain on every channel
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param flt pointer to filter bank
+ *  @return void
+*/
+void GhFilterInit(ghfilter_s * flt)
+{
+    int i;
+    flt->period = GHUPDATE / 1000.0;
+    for(i=0; i<SENSORS; i++)
+    {
+        GhFilterChannel(&flt->chan[i],FILTMEDIAN,FILTBIQUAD,FILTCUTOFF,flt->period);
+    }
+}
+
+/** @brief Computes a channel's low-pass coefficients for a sampling period
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel, kind and cutoff set
+ *  @param period s between samples
+ *  @return void
+*/
+static void GhFilterTune(filtchan_s * fc, double period)
+{
+    double w0 = 2.0 * M_PI * fc->cutoff * period;
+    double cs;
+    double alpha;
+    double a0;
+
+    fc->b0 = 1.0;
+    fc->b1 = fc->b2 = fc->a1 = fc->a2 = 0.0;
+    if(fc->cutoff * period >= FILTMAXFRACTION)
+    {
+        // Sampled too slowly to smooth at this cutoff: pass samples through
+        return;
+    }
+    if(fc->kind == FILTEMA)
+    {
+        fc->b0 = 1.0 - exp(-w0);
+    }
+    else if(fc->kind == FILTBIQUAD)
+    {
+        // Butterworth low-pass (Q = 1/sqrt(2)), unity gain at DC
+        cs = cos(w0);
+        alpha = sin(w0) / M_SQRT2;
+        a0 = 1.0 + alpha;
+        fc->b0 = (1.0 - cs) / 2.0 / a0;
+        fc->b1 = (1.0 - cs) / a0;
+        fc->b2 = fc->b0;
+        fc->a1 = -2.0 * cs / a0;
+        fc->a2 = (1.0 - alpha) / a0;
+    }
+}
+
+/** @brief Sets a channel's low-pass state to the steady state at a value
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel
+ *  @param x value
+ *  @return void
+*/
+static void GhFilterPrime(filtchan_s * fc, double x)
+{
+    fc->z1 = (fc->kind == FILTEMA) ? x : x * (1.0 - fc->b0);
+    fc->z2 = x * (fc->b2 - fc->a2);
+    fc->primed = 1;
+}
+
+/** @brief Configures one channel and clears its state
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel
+ *  @param median median window (odd, 1 disables, at most FILTMAXMEDIAN)
+ *  @param kind low-pass stage
+ *  @param cutoff low-pass cutoff in Hz
+ *  @param period s between samples
+ *  @return void
+*/
+void GhFilterChannel(filtchan_s * fc, int median, filtkind_e kind, double cutoff, double period)
+{
+    memset(fc,0,sizeof(filtchan_s));
+    fc->median = (median < 1) ? 1 : ((median > FILTMAXMEDIAN) ? FILTMAXMEDIAN : (median | 1));
+    fc->kind = kind;
+    fc->cutoff = cutoff;
+    GhFilterTune(fc,period);
+}
+
+/** @brief Retunes every channel to a new sampling period
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param flt pointer to filter bank
+ *  @param period s between samples from now on
+ *  @return void
+*/
+void GhFilterPeriod(ghfilter_s * flt, double period)
+{
+    int i;
+    if(period == flt->period)
+    {
+        return;
+    }
+    flt->period = period;
+    for(i=0; i<SENSORS; i++)
+    {
+        GhFilterTune(&flt->chan[i],period);
+        if(flt->chan[i].primed)
+        {
+            // The old state is in terms of the old coefficients; carry on from the last output
+            GhFilterPrime(&flt->chan[i],flt->chan[i].out);
+        }
+    }
+}
+
+/** @brief Median of the channel's window
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel
+ *  @return double median of the samples seen so far
+*/
+static double GhFilterMedian(const filtchan_s * fc)
+{
+    double v[FILTMAXMEDIAN];
+    double t;
+    int i;
+    int j;
+    // Insertion sort is the cheapest choice for a handful of samples
+    for(i=0; i<fc->count; i++)
+    {
+        t = fc->window[i];
+        for(j=i; j>0 && v[j-1] > t; j--)
+        {
+            v[j] = v[j-1];
+        }
+        v[j] = t;
+    }
+    return v[fc->count / 2];
+}
+
+/** @brief Runs one sample through a channel
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel
+ *  @param x new sample
+ *  @return double filtered value
+*/
+double GhFilterStep(filtchan_s * fc, double x)
+{
+    double y;
+    if(fc->median > 1)
+    {
+        fc->window[fc->head] = x;
+        fc->head = (fc->head + 1) % fc->median;
+        if(fc->count < fc->median)
+        {
+            fc->count++;
+        }
+        x = GhFilterMedian(fc);
+    }
+    if(!fc->primed)
+    {
+        // Start from steady state at the first sample instead of ramping up from zero
+        GhFilterPrime(fc,x);
+    }
+    switch(fc->kind)
+    {
+        case FILTEMA:
+            fc->z1 += fc->b0 * (x - fc->z1);
+            y = fc->z1;
+            break;
+        case FILTBIQUAD:
+            // Direct form II transposed
+            y = fc->b0 * x + fc->z1;
+            fc->z1 = fc->b1 * x - fc->a1 * y + fc->z2;
+            fc->z2 = fc->b2 * x - fc->a2 * y;
+            break;
+        default:
+            y = x;
+            break;
+    }
+    fc->out = y;
+    return y;
+}
+
+/** @brief Filters a set of readings
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param flt pointer to filter bank
+ *  @param rdata object of readings data
+ *  @return object of readings type, stale channels keep the last filtered value
+*/
+reading_s GhFilterApply(ghfilter_s * flt, reading_s rdata)
+{
+    double * v[SENSORS];
+    int i;
+    v[TEMPERATURE] = &rdata.temperature;
+    v[HUMIDITY] = &rdata.humidity;
+    v[PRESSURE] = &rdata.pressure;
+    for(i=0; i<SENSORS; i++)
+    {
+        if(rdata.stale & (1 << i))
+        {
+            if(flt->chan[i].primed)
+            {
+                *v[i] = flt->chan[i].out;
+            }
+        }
+        else
+        {
+            *v[i] = GhFilterStep(&flt->chan[i],*v[i]);
+        }
+    }
+    return rdata;
+}
+
+/** @brief Reads the monotonic clock in seconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return double seconds
+*/
+static double GhFilterNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/** @brief Evaluates a channel's low-pass gain at a frequency
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fc pointer to filter channel
+ *  @param freq Hz
+ *  @param period s between samples
+ *  @return double magnitude of the response
+*/
+static double GhFilterGain(const filtchan_s * fc, double freq, double period)
+{
+    double w = 2.0 * M_PI * freq * period;
+    double nr = fc->b0 + fc->b1 * cos(w) + fc->b2 * cos(2.0 * w);
+    double ni = -fc->b1 * sin(w) - fc->b2 * sin(2.0 * w);
+    double dr = 1.0 + fc->a1 * cos(w) + fc->a2 * cos(2.0 * w);
+    double di = -fc->a1 * sin(w) - fc->a2 * sin(2.0 * w);
+    return sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+/** @brief Times each filter chain on a day of noisy plant readings and scores it against the noiseless state
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if every chain gave finite output, the default chain cut the noise and retuning kept the cutoff, 0 otherwise
+*/
+int GhFilterReport(FILE * fp)
+{
+    static const double periods[] = {1.0,2.0,5.0,10.0,30.0};
+    static const struct
+    {
+        const char * name;
+        int median;
+        filtkind_e kind;
+        double param;
+    } chains[] =
+    {
+        {"none",1,FILTNONE,0.0},
+        {"median 5",5,FILTNONE,0.0},
+        {"EMA",1,FILTEMA,FILTCUTOFF},
+        {"biquad",1,FILTBIQUAD,FILTCUTOFF},
+        {"median 5 + biquad",FILTMEDIAN,FILTBIQUAD,FILTCUTOFF},
+        {"median 9 + biquad",FILTMAXMEDIAN,FILTBIQUAD,FILTCUTOFF},
+    };
+    int nchains = (int)(sizeof(chains) / sizeof(chains[0]));
+    int nperiods = (int)(sizeof(periods) / sizeof(periods[0]));
+    int c;
+    int i;
+    int j;
+    int rep;
+    int ok = 1;
+    int finite;
+    double t0;
+    double secs;
+    double err;
+    double rawrms = 0.0;
+    double rms;
+    double gain;
+    double want;
+    volatile double sink = 0.0;  // keeps the timed passes from being optimised away
+    plant_s pl;
+    ghfilter_s flt;
+    control_s ctrl = {0};
+    reading_s out;
+    reading_s * raw = (reading_s *) malloc(FILTBENCHN * sizeof(reading_s));
+    double * truth = (double *) malloc(FILTBENCHN * sizeof(double));
+
+    if(raw == NULL || truth == NULL)
+    {
+        fprintf(fp,"Cannot allocate memory\n");
+        free(raw);
+        free(truth);
+        return 0;
+    }
+    GhPlantInit(&pl,PLANTSEED);
+    for(i=0; i<FILTBENCHN; i++)
+    {
+        truth[i] = pl.temperature;
+        raw[i] = GhPlantRead(&pl);
+        err = raw[i].temperature - truth[i];
+        rawrms += err * err;
+        for(j=0; j<(int)(FILTBENCHSECS / PLANTDT); j++)
+        {
+            GhPlantStep(&pl,ctrl,PLANTDT);
+        }
+    }
+    rawrms = sqrt(rawrms / FILTBENCHN);
+
+    fprintf(fp,"Filter cost, %d plant readings every %.0lf s, %d passes, cutoff %.3lf Hz\n",FILTBENCHN,FILTBENCHSECS,FILTBENCHREPS,FILTCUTOFF);
+    fprintf(fp,"%-20s %14s %18s\n","Chain","ns/reading","Temp RMS err (C)");
+    for(c=0; c<nchains; c++)
+    {
+        t0 = GhFilterNow();
+        for(rep=0; rep<FILTBENCHREPS; rep++)
+        {
+            for(i=0; i<SENSORS; i++)
+            {
+                GhFilterChannel(&flt.chan[i],chains[c].median,chains[c].kind,chains[c].param,FILTBENCHSECS);
+            }
+            for(i=0; i<FILTBENCHN; i++)
+            {
+                out = GhFilterApply(&flt,raw[i]);
+                sink += out.pressure;
+            }
+        }
+        secs = GhFilterNow() - t0;
+
+        // One more pass, untimed, for the accuracy
+        rms = 0.0;
+        finite = 1;
+        for(i=0; i<SENSORS; i++)
+        {
+            GhFilterChannel(&flt.chan[i],chains[c].median,chains[c].kind,chains[c].param,FILTBENCHSECS);
+        }
+        for(i=0; i<FILTBENCHN; i++)
+        {
+            out = GhFilterApply(&flt,raw[i]);
+            finite = finite && isfinite(out.temperature) && isfinite(out.humidity) && isfinite(out.pressure);
+            err = out.temperature - truth[i];
+            rms += err * err;
+        }
+        rms = sqrt(rms / FILTBENCHN);
+        fprintf(fp,"%-20s %14.1lf %18.4lf%s\n",chains[c].name,secs * 1e9 / ((double) FILTBENCHN * FILTBENCHREPS),
+            rms,finite ? "" : "  non-finite output");
+        ok = ok && finite;
+        if(chains[c].median == FILTMEDIAN && chains[c].kind == FILTBIQUAD)
+        {
+            ok = ok && rms < rawrms;
+        }
+    }
+    fprintf(fp,"Raw sensor noise %.4lf C RMS\n",rawrms);
+
+    // The default bank, retuned as the scheduler would, keeps its cutoff in Hz
+    // and carries on from its last output without a step
+    fprintf(fp,"Default biquad gain at %.3lf Hz after retuning from %.0lf s:",FILTCUTOFF,FILTBENCHSECS);
+    for(c=0; c<nperiods; c++)
+    {
+        GhFilterInit(&flt);
+        GhFilterPeriod(&flt,FILTBENCHSECS);
+        for(i=0; i<FILTMAXMEDIAN; i++)
+        {
+            GhFilterApply(&flt,raw[0]);
+        }
+        GhFilterPeriod(&flt,periods[c]);
+        gain = GhFilterGain(&flt.chan[TEMPERATURE],FILTCUTOFF,periods[c]);
+        want = (FILTCUTOFF * periods[c] >= FILTMAXFRACTION) ? 1.0 : M_SQRT1_2;
+        out = GhFilterApply(&flt,raw[0]);
+        fprintf(fp," %.0lfs %.4lf",periods[c],gain);
+        ok = ok && fabs(gain - want) < FILTCHECKTOL && fabs(out.temperature - raw[0].temperature) < FILTCHECKTOL;
+    }
+    fprintf(fp,"\n");
+    free(raw);
+    free(truth);
+    return ok;
+}
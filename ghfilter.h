@@ -0,0 +1,62 @@
+/** @brief Gh reading filter constants, structures, function prototypes
+*   @file ghfilter.h
+*
+*   Each channel runs an optional median-of-N spike rejector followed by an
+*   optional low-pass stage (EMA or second-order Butterworth biquad). The
+*   cutoff is in Hz, not a fraction of the sample rate, and the bank keeps
+*   the sampling period its coefficients are for: GhFilterPeriod() redoes
+*   them when the scheduler changes it, so the smoothing stays the same
+*   length of time. All state is fixed size, so a filter bank can be copied
+*   into a checkpoint.
+*/
+#ifndef GHFILTER_H
+#define GHFILTER_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Filter Constants
+#define FILTMAXMEDIAN 9         // largest median window
+#define FILTMEDIAN 5            // default median window, 1 to disable
+#define FILTCUTOFF 0.025        // Hz, default low-pass cutoff (6.4 s time constant), 0.05 of the rate at GHUPDATE
+#define FILTMAXFRACTION 0.4     // a cutoff above this fraction of the sample rate passes samples through
+#define FILTBENCHN 86400        // plant readings GhFilterReport() filters, a day at FILTBENCHSECS
+#define FILTBENCHSECS 1.0       // s between them, the fastest scheduled period
+#define FILTBENCHREPS 5         // passes timed per chain
+#define FILTCHECKTOL 1e-6       // error allowed in the gain at the cutoff
+
+//Enumerated Types
+typedef enum { FILTNONE, FILTEMA, FILTBIQUAD } filtkind_e;
+
+//Typedefs
+typedef struct filtchan
+{
+    int median;
+    int count;
+    int head;
+    double window[FILTMAXMEDIAN];
+    filtkind_e kind;
+    double cutoff;              // Hz
+    int primed;
+    double b0,b1,b2,a1,a2;      // biquad coefficients, b0 is the EMA weight
+    double z1,z2;               // biquad state, z1 is the EMA output
+    double out;
+}filtchan_s;
+
+typedef struct ghfilter
+{
+    double period;              // s between samples, as the coefficients assume
+    filtchan_s chan[SENSORS];
+}ghfilter_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhFilterInit(ghfilter_s * flt);
+void GhFilterChannel(filtchan_s * fc, int median, filtkind_e kind, double cutoff, double period);
+void GhFilterPeriod(ghfilter_s * flt, double period);
+double GhFilterStep(filtchan_s * fc, double x);
+reading_s GhFilterApply(ghfilter_s * flt, reading_s rdata);
+int GhFilterReport(FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,207 @@
+/** @brief Gh in-memory history functions
+*   @file ghhistory.c
+*
+*   Keeps the most recent raw readings plus per-minute, per-hour and per-day
+*   min/max/mean rollups in fixed-size rings. Every sample updates the open
+*   bucket of each tier in constant time; a bucket is closed into its ring
+*   when a sample lands in the next local-time interval.
+*/
+#include "ghhistory.h"
+
+/** @brief Starts a new open bucket from one reading
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to rollup ring
+ *  @param key interval number of the reading
+ *  @param v array of SENSORS values
+ *  @param rtime reading time
+ *  @return void
+*/
+static void GhRollupStart(rollupring_s * ring, long key, const double * v, time_t rtime)
+{
+    int i;
+    ring->key = key;
+    ring->cur.start = rtime;
+    ring->cur.count = 1;
+    for(i=0; i<SENSORS; i++)
+    {
+        ring->cur.n[i] = !isnan(v[i]);
+        ring->cur.min[i] = v[i];
+        ring->cur.max[i] = v[i];
+        ring->cur.mean[i] = isnan(v[i]) ? 0.0 : v[i];   // running sum until the bucket closes
+    }
+}
+
+/** @brief Closes the open bucket into its ring
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to rollup ring
+ *  @return void
+*/
+static void GhRollupClose(rollupring_s * ring)
+{
+    int i;
+    rollup_s * slot;
+    if(ring->cur.count == 0)
+    {
+        return;
+    }
+    slot = &ring->buf[ring->head];
+    *slot = ring->cur;
+    for(i=0; i<SENSORS; i++)
+    {
+        slot->mean[i] = ring->cur.n[i] ? ring->cur.mean[i] / ring->cur.n[i] : NAN;
+    }
+    ring->head = (ring->head + 1) % ring->size;
+    if(ring->count < ring->size)
+    {
+        ring->count++;
+    }
+    ring->cur.count = 0;
+}
+
+/** @brief Adds one reading to a rollup ring
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ring pointer to rollup ring
+ *  @param local reading time shifted to local time
+ *  @param v array of SENSORS values
+ *  @param rtime reading time
+ *  @return void
+*/
+static void GhRollupAdd(rollupring_s * ring, long local, const double * v, time_t rtime)
+{
+    int i;
+    long key = local / ring->period;
+    if(ring->cur.count == 0 || key != ring->key)
+    {
+        GhRollupClose(ring);
+        GhRollupStart(ring,key,v,rtime);
+        return;
+    }
+    ring->cur.count++;
+    for(i=0; i<SENSORS; i++)
+    {
+        if(isnan(v[i]))
+        {
+            continue;
+        }
+        ring->cur.min[i] = (ring->cur.n[i] == 0 || v[i] < ring->cur.min[i]) ? v[i] : ring->cur.min[i];
+        ring->cur.max[i] = (ring->cur.n[i] == 0 || v[i] > ring->cur.max[i]) ? v[i] : ring->cur.max[i];
+        ring->cur.mean[i] += v[i];
+        ring->cur.n[i]++;
+    }
+}
+
+/** @brief Initialises an empty history store
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hist pointer to history store
+ *  @return void
+*/
+void GhHistoryInit(history_s * hist)
+{
+    memset(hist,0,sizeof(history_s));
+    hist->tier[HISTMINUTE].buf = hist->minutes;
+    hist->tier[HISTMINUTE].size = HISTMINSZ;
+    hist->tier[HISTMINUTE].period = 60;
+    hist->tier[HISTHOUR].buf = hist->hours;
+    hist->tier[HISTHOUR].size = HISTHOURSZ;
+    hist->tier[HISTHOUR].period = 3600;
+    hist->tier[HISTDAY].buf = hist->days;
+    hist->tier[HISTDAY].size = HISTDAYSZ;
+    hist->tier[HISTDAY].period = 86400;
+}
+
+/** @brief Adds one reading to the raw ring and all rollup tiers
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hist pointer to history store
+ *  @param rdata object of readings type
+ *  @return void
+*/
+void GhHistoryAdd(history_s * hist, reading_s rdata)
+{
+    int t;
+    struct tm lt;
+    long local;
+    double v[SENSORS];
+
+    hist->raw[hist->rawhead] = rdata;
+    hist->rawhead = (hist->rawhead + 1) % HISTRAWSZ;
+    if(hist->rawcount < HISTRAWSZ)
+    {
+        hist->rawcount++;
+    }
+
+    localtime_r(&rdata.rtime,&lt);
+    local = (long) rdata.rtime + lt.tm_gmtoff;
+    v[TEMPERATURE] = rdata.temperature;
+    v[HUMIDITY] = rdata.humidity;
+    v[PRESSURE] = rdata.pressure;
+    for(t=0; t<HISTTIERS; t++)
+    {
+        GhRollupAdd(&hist->tier[t],local,v,rdata.rtime);
+    }
+}
+
+/** @brief Copies the most recent raw readings, oldest first
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hist pointer to history store
+ *  @param count maximum number of readings wanted
+ *  @param out array of at least count readings
+ *  @return int number of readings copied
+*/
+int GhHistoryRaw(history_s * hist, int count, reading_s * out)
+{
+    int i;
+    int n = (count < hist->rawcount) ? count : hist->rawcount;
+    int first = (hist->rawhead - n + HISTRAWSZ) % HISTRAWSZ;
+    for(i=0; i<n; i++)
+    {
+        out[i] = hist->raw[(first + i) % HISTRAWSZ];
+    }
+    return n;
+}
+
+/** @brief Copies the most recent rollups of one tier, oldest first
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hist pointer to history store
+ *  @param tier minute, hour or day tier
+ *  @param count maximum number of rollups wanted
+ *  @param out array of at least count rollups
+ *  @return int number of rollups copied, the last one being the open bucket
+*/
+int GhHistoryQuery(history_s * hist, histtier_e tier, int count, rollup_s * out)
+{
+    int i;
+    int n;
+    int closed;
+    int first;
+    rollupring_s * ring = &hist->tier[tier];
+    int open = (ring->cur.count > 0);
+
+    n = ring->count + open;
+    n = (count < n) ? count : n;
+    closed = n - open;
+    if(closed < 0)
+    {
+        closed = 0;
+    }
+    first = (ring->head - closed + ring->size) % ring->size;
+    for(i=0; i<closed; i++)
+    {
+        out[i] = ring->buf[(first + i) % ring->size];
+    }
+    if(open && n > closed)
+    {
+        out[closed] = ring->cur;
+        for(i=0; i<SENSORS; i++)
+        {
+            out[closed].mean[i] = ring->cur.n[i] ? ring->cur.mean[i] / ring->cur.n[i] : NAN;
+        }
+    }
+    return n;
+}
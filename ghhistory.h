@@ -0,0 +1,61 @@
+/** @brief Gh in-memory history constants, structures, function prototypes
+*   @file ghhistory.h
+*/
+#ifndef GHHISTORY_H
+#define GHHISTORY_H
+
+// Includes
+#include "ghcontrol.h"
+
+// History Constants
+#define HISTRAWSZ 1800      // raw samples kept (1 h at GHUPDATE)
+#define HISTMINSZ 1440      // per-minute rollups kept (24 h)
+#define HISTHOURSZ 168      // per-hour rollups kept (7 days)
+#define HISTDAYSZ 366       // per-day rollups kept (1 year)
+#define HISTTIERS 3
+
+//Enumerated Types
+typedef enum { HISTMINUTE, HISTHOUR, HISTDAY } histtier_e;
+
+//Typedefs
+typedef struct rollup
+{
+    time_t start;
+    uint32_t count;
+    uint32_t n[SENSORS];        // samples per channel, without the NAN ones of a failed sensor
+    double min[SENSORS];
+    double max[SENSORS];
+    double mean[SENSORS];
+}rollup_s;
+
+typedef struct rollupring
+{
+    rollup_s * buf;
+    int size;
+    int head;
+    int count;
+    long period;
+    long key;
+    rollup_s cur;
+}rollupring_s;
+
+typedef struct history
+{
+    reading_s raw[HISTRAWSZ];
+    int rawhead;
+    int rawcount;
+    rollup_s minutes[HISTMINSZ];
+    rollup_s hours[HISTHOURSZ];
+    rollup_s days[HISTDAYSZ];
+    rollupring_s tier[HISTTIERS];
+}history_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhHistoryInit(history_s * hist);
+void GhHistoryAdd(history_s * hist, reading_s rdata);
+int GhHistoryRaw(history_s * hist, int count, reading_s * out);
+int GhHistoryQuery(history_s * hist, histtier_e tier, int count, rollup_s * out);
+///@endcond
+
+#endif
@@ -0,0 +1,551 @@
+/** @brief Gh log parser functions
+*   @file ghlog.c
+*
+*   GhLogData() writes "\nWed,Jun,30,21:49:08,1993, 23.4, 55.0,1013.2":
+*   ctime() with commas in place of the field separators, then three
+*   %5.1lf/%5.1lf/%6.1lf values. The date is fixed width, so it is decoded by
+*   position; the values are parsed by hand instead of with sscanf. A
+*   failed sensor's value is written, and read back, as "nan".
+*/
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ghlog.h"
+
+/** @brief Finds the start of the next line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p current position
+ *  @param end end of buffer
+ *  @return const char * first byte after the next newline, or end
+*/
+const char * GhLogNextLine(const char * p, const char * end)
+{
+    // glibc memchr compares 16 to 32 bytes per instruction
+    const char * nl = memchr(p,'\n',end - p);
+    return (nl == NULL) ? end : nl + 1;
+}
+
+/** @brief Decodes a two digit field that may be space padded
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p pointer to two characters
+ *  @return int value, or -1 if not a number
+*/
+static inline int GhLogTwoDigits(const char * p)
+{
+    int hi = (p[0] == ' ') ? 0 : p[0] - '0';
+    int lo = p[1] - '0';
+    if(hi < 0 || hi > 9 || lo < 0 || lo > 9)
+    {
+        return -1;
+    }
+    return hi * 10 + lo;
+}
+
+/** @brief Decodes a three letter month name
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p pointer to three characters
+ *  @return int month 1 to 12, or 0 if not a month
+*/
+static inline int GhLogMonth(const char * p)
+{
+    switch(p[0])
+    {
+        case 'J':
+            return (p[1] == 'a') ? 1 : ((p[2] == 'n') ? 6 : 7);
+        case 'F':
+            return 2;
+        case 'M':
+            return (p[2] == 'r') ? 3 : 5;
+        case 'A':
+            return (p[1] == 'p') ? 4 : 8;
+        case 'S':
+            return 9;
+        case 'O':
+            return 10;
+        case 'N':
+            return 11;
+        case 'D':
+            return 12;
+    }
+    return 0;
+}
+
+/** @brief Parses one comma terminated decimal value
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p start of the field
+ *  @param end end of the line
+ *  @param v pointer to the parsed value
+ *  @return const char * first byte after the field, or NULL on error
+*/
+static inline const char * GhLogNumber(const char * p, const char * end, double * v)
+{
+    int neg = 0;
+    int digits = 0;
+    int64_t mant = 0;
+    int64_t scale = 1;
+
+    while(p < end && *p == ' ')
+    {
+        p++;
+    }
+    if(p < end && *p == '-')
+    {
+        neg = 1;
+        p++;
+    }
+    if(end - p >= 3 && memcmp(p,"nan",3) == 0)
+    {
+        p += 3;
+        if(p < end && *p != ',' && *p != '\r' && *p != '\n')
+        {
+            return NULL;
+        }
+        *v = NAN;
+        return (p < end && *p == ',') ? p + 1 : p;
+    }
+    while(p < end && *p >= '0' && *p <= '9' && digits < 15)
+    {
+        mant = mant * 10 + (*p++ - '0');
+        digits++;
+    }
+    if(p < end && *p == '.')
+    {
+        p++;
+        while(p < end && *p >= '0' && *p <= '9' && digits < 15)
+        {
+            mant = mant * 10 + (*p++ - '0');
+            scale *= 10;
+            digits++;
+        }
+    }
+    if(digits == 0 || (p < end && *p != ',' && *p != '\r' && *p != '\n'))
+    {
+        return NULL;
+    }
+    // One correctly rounded division matches strtod() for these short values
+    *v = (double)(neg ? -mant : mant) / (double) scale;
+    return (p < end && *p == ',') ? p + 1 : p;
+}
+
+/** @brief Parses one GhLogData() line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p start of the line
+ *  @param end end of the line (its newline or the end of the buffer)
+ *  @param lt pointer to the parsed wall-clock time
+ *  @param v array of LOGVALUES parsed temperature, humidity and pressure
+ *  @return int 1 on success, 0 for blank or malformed lines
+*/
+int GhLogParseLine(const char * p, const char * end, logtime_s * lt, double * v)
+{
+    int i;
+    const char * d;
+
+    if(end - p < LOGDATESZ + 1 || p[3] != ',' || p[7] != ',' || p[10] != ',' || p[19] != ',' || p[LOGDATESZ] != ',')
+    {
+        return 0;
+    }
+    lt->month = GhLogMonth(p+4);
+    lt->day = GhLogTwoDigits(p+8);
+    lt->hour = GhLogTwoDigits(p+11);
+    lt->minute = GhLogTwoDigits(p+14);
+    lt->second = GhLogTwoDigits(p+17);
+    d = p + 20;
+    lt->year = 0;
+    for(i=0; i<4; i++)
+    {
+        if(d[i] < '0' || d[i] > '9')
+        {
+            return 0;
+        }
+        lt->year = lt->year * 10 + (d[i] - '0');
+    }
+    if(lt->month == 0 || lt->day < 1 || lt->hour < 0 || lt->minute < 0 || lt->second < 0)
+    {
+        return 0;
+    }
+    p += LOGDATESZ + 1;
+    for(i=0; i<LOGVALUES; i++)
+    {
+        p = GhLogNumber(p,end,&v[i]);
+        if(p == NULL)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief Counts days since 1970-01-01 for a civil date
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param year full year
+ *  @param month 1 to 12
+ *  @param day 1 to 31
+ *  @return int64_t days since the epoch
+*/
+int64_t GhLogDays(int year, int month, int day)
+{
+    int64_t era;
+    int64_t yoe;
+    int64_t doy;
+    year -= (month <= 2);
+    era = (year >= 0 ? year : year - 399) / 400;
+    yoe = year - era * 400;
+    doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    return era * 146097 + yoe * 365 + yoe / 4 - yoe / 100 + doy - 719468;
+}
+
+/** @brief Converts a parsed log time to seconds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param lt pointer to parsed wall-clock time
+ *  @return time_t seconds since the epoch, counting the wall clock as UTC
+*/
+time_t GhLogSeconds(const logtime_s * lt)
+{
+    return (time_t)(GhLogDays(lt->year,lt->month,lt->day) * 86400 + lt->hour * 3600 + lt->minute * 60 + lt->second);
+}
+
+/** @brief Converts days since 1970-01-01 back to a civil date
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param days days since the epoch
+ *  @param year pointer to full year
+ *  @param month pointer to month 1 to 12
+ *  @param day pointer to day 1 to 31
+ *  @return void
+*/
+void GhLogCivil(int64_t days, int * year, int * month, int * day)
+{
+    int64_t era;
+    int64_t doe;
+    int64_t yoe;
+    int64_t doy;
+    int64_t mp;
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    doe = days - era * 146097;
+    yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+/** @brief Opens a log for chunked streaming
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ls pointer to log stream
+ *  @param fname pointer to file name
+ *  @return int 1 on success, 0 on error
+*/
+int GhLogOpen(logstream_s * ls, const char * fname)
+{
+    ls->fd = open(fname,O_RDONLY);
+    ls->eof = 0;
+    ls->len = 0;
+    ls->pos = 0;
+    ls->bytes = 0;
+    if(ls->fd == -1)
+    {
+        return 0;
+    }
+    posix_fadvise(ls->fd,0,0,POSIX_FADV_SEQUENTIAL);
+    return 1;
+}
+
+/** @brief Parses the next batch of samples from a log stream
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ls pointer to log stream
+ *  @param batch pointer to batch filled with up to LOGBATCHSZ samples
+ *  @return int number of samples parsed, 0 at the end of the log
+*/
+int GhLogRead(logstream_s * ls, logbatch_s * batch)
+{
+    ssize_t got;
+    size_t keep;
+    char * start;
+    char * end;
+    char * nl;
+    logtime_s lt;
+    double v[LOGVALUES];
+
+    batch->n = 0;
+    while(batch->n < LOGBATCHSZ)
+    {
+        start = ls->buf + ls->pos;
+        end = ls->buf + ls->len;
+        nl = memchr(start,'\n',end - start);
+        if(nl == NULL)
+        {
+            if(ls->eof)
+            {
+                // Last line has no newline (GhLogData writes it first)
+                nl = end;
+                if(start == end)
+                {
+                    break;
+                }
+            }
+            else
+            {
+                // Move the partial line to the front and refill the chunk
+                keep = end - start;
+                memmove(ls->buf,start,keep);
+                if(keep == LOGCHUNKSZ)
+                {
+                    keep = 0;
+                }
+                ls->len = keep;
+                ls->pos = 0;
+                got = read(ls->fd,ls->buf + ls->len,LOGCHUNKSZ - ls->len);
+                if(got <= 0)
+                {
+                    ls->eof = 1;
+                }
+                else
+                {
+                    ls->len += got;
+                    ls->bytes += got;
+                }
+                continue;
+            }
+        }
+        if(GhLogParseLine(start,nl,&lt,v))
+        {
+            batch->rtime[batch->n] = GhLogSeconds(&lt);
+            batch->temperature[batch->n] = v[0];
+            batch->humidity[batch->n] = v[1];
+            batch->pressure[batch->n] = v[2];
+            batch->n++;
+        }
+        ls->pos = (nl < end) ? (size_t)(nl + 1 - ls->buf) : ls->len;
+    }
+    return batch->n;
+}
+
+/** @brief Closes a log stream
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param ls pointer to log stream
+ *  @return void
+*/
+void GhLogClose(logstream_s * ls)
+{
+    if(ls->fd != -1)
+    {
+        close(ls->fd);
+        ls->fd = -1;
+    }
+}
+
+/** @brief Parses the raw channel of a GhLogData() line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p start of the line
+ *  @param end end of the line
+ *  @param raw pointer to the parsed values, counts and calibration id
+ *  @return int 1 if the line has a raw channel, 0 otherwise
+*/
+int GhLogParseRaw(const char * p, const char * end, lograw_s * raw)
+{
+    int i;
+    int neg;
+    int64_t n;
+    uint32_t id = 0;
+
+    // The raw channel follows the third value's comma
+    p += LOGDATESZ + 1;
+    for(i=0; i<LOGVALUES && p != NULL; i++)
+    {
+        p = GhLogNumber(p,end,&raw->value[i]);
+    }
+    if(p == NULL || end - p < 2 || p[0] != 'r' || p[1] != ',')
+    {
+        return 0;
+    }
+    p += 2;
+    for(i=0; i<LOGVALUES; i++)
+    {
+        neg = (p < end && *p == '-');
+        p += neg;
+        if(p >= end || *p < '0' || *p > '9')
+        {
+            return 0;
+        }
+        for(n = 0; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            n = n * 10 + (*p - '0');
+        }
+        if(p >= end || *p != ',')
+        {
+            return 0;
+        }
+        p++;
+        raw->count[i] = (int32_t)(neg ? -n : n);
+    }
+    for(i=0; i<8; i++, p++)
+    {
+        if(p >= end)
+        {
+            return 0;
+        }
+        if(*p >= '0' && *p <= '9') id = id << 4 | (*p - '0');
+        else if(*p >= 'a' && *p <= 'f') id = id << 4 | (*p - 'a' + 10);
+        else return 0;
+    }
+    raw->calid = id;
+    return 1;
+}
+
+/** @brief Loads a calibration registry
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param cal array of calibration sets
+ *  @param max size of the array
+ *  @return int number of sets loaded, -1 if the file cannot be read
+*/
+int GhLogLoadCal(const char * fname, logcal_s * cal, int max)
+{
+    FILE * fp;
+    int n = 0;
+    unsigned int id;
+    char line[LOGCALLINESZ];
+    logcal_s * c;
+
+    fp = fopen(fname,"r");
+    if(fp == NULL)
+    {
+        return -1;
+    }
+    while(n < max && fgets(line,sizeof(line),fp) != NULL)
+    {
+        c = &cal[n];
+        if(line[0] != '#' && sscanf(line,"%x,%lf,%lf,%lf,%lf,%lf,%lf",&id,&c->gain[0],&c->offset[0],
+            &c->gain[1],&c->offset[1],&c->gain[2],&c->offset[2]) == 7)
+        {
+            c->id = id;
+            n++;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+/** @brief Appends a calibration set to a registry unless its id is already there
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to file name
+ *  @param cal pointer to calibration set
+ *  @return int 1 if the registry holds the set, 0 on error
+*/
+int GhLogSaveCal(const char * fname, const logcal_s * cal)
+{
+    FILE * fp;
+    unsigned int id;
+    char line[LOGCALLINESZ];
+
+    fp = fopen(fname,"a+");
+    if(fp == NULL)
+    {
+        return 0;
+    }
+    while(fgets(line,sizeof(line),fp) != NULL)
+    {
+        if(line[0] != '#' && sscanf(line,"%x,",&id) == 1 && id == cal->id)
+        {
+            fclose(fp);
+            return 1;
+        }
+    }
+    fprintf(fp,"%08x,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g\n",cal->id,cal->gain[0],cal->offset[0],
+        cal->gain[1],cal->offset[1],cal->gain[2],cal->offset[2]);
+    fclose(fp);
+    return 1;
+}
+
+/** @brief Looks up a calibration set by id
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param cal array of calibration sets
+ *  @param n number of sets
+ *  @param id calibration id
+ *  @return const logcal_s * matching set, NULL if unknown
+*/
+const logcal_s * GhLogFindCal(const logcal_s * cal, int n, uint32_t id)
+{
+    int i;
+    for(i=0; i<n; i++)
+    {
+        if(cal[i].id == id)
+        {
+            return &cal[i];
+        }
+    }
+    return NULL;
+}
+
+/** @brief Computes the CRC-32 (IEEE 802.3) of a buffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param buf pointer to data
+ *  @param len number of bytes
+ *  @return uint32_t checksum
+*/
+uint32_t GhCrc32(const void * buf, size_t len)
+{
+    // Reflected polynomial 0xedb88320; constant, as the control loop, the
+    // uploader and the checkpoint writer all call this from their own threads
+    static const uint32_t table[256] = {
+    0x00000000u,0x77073096u,0xee0e612cu,0x990951bau,0x076dc419u,0x706af48fu,0xe963a535u,0x9e6495a3u,
+    0x0edb8832u,0x79dcb8a4u,0xe0d5e91eu,0x97d2d988u,0x09b64c2bu,0x7eb17cbdu,0xe7b82d07u,0x90bf1d91u,
+    0x1db71064u,0x6ab020f2u,0xf3b97148u,0x84be41deu,0x1adad47du,0x6ddde4ebu,0xf4d4b551u,0x83d385c7u,
+    0x136c9856u,0x646ba8c0u,0xfd62f97au,0x8a65c9ecu,0x14015c4fu,0x63066cd9u,0xfa0f3d63u,0x8d080df5u,
+    0x3b6e20c8u,0x4c69105eu,0xd56041e4u,0xa2677172u,0x3c03e4d1u,0x4b04d447u,0xd20d85fdu,0xa50ab56bu,
+    0x35b5a8fau,0x42b2986cu,0xdbbbc9d6u,0xacbcf940u,0x32d86ce3u,0x45df5c75u,0xdcd60dcfu,0xabd13d59u,
+    0x26d930acu,0x51de003au,0xc8d75180u,0xbfd06116u,0x21b4f4b5u,0x56b3c423u,0xcfba9599u,0xb8bda50fu,
+    0x2802b89eu,0x5f058808u,0xc60cd9b2u,0xb10be924u,0x2f6f7c87u,0x58684c11u,0xc1611dabu,0xb6662d3du,
+    0x76dc4190u,0x01db7106u,0x98d220bcu,0xefd5102au,0x71b18589u,0x06b6b51fu,0x9fbfe4a5u,0xe8b8d433u,
+    0x7807c9a2u,0x0f00f934u,0x9609a88eu,0xe10e9818u,0x7f6a0dbbu,0x086d3d2du,0x91646c97u,0xe6635c01u,
+    0x6b6b51f4u,0x1c6c6162u,0x856530d8u,0xf262004eu,0x6c0695edu,0x1b01a57bu,0x8208f4c1u,0xf50fc457u,
+    0x65b0d9c6u,0x12b7e950u,0x8bbeb8eau,0xfcb9887cu,0x62dd1ddfu,0x15da2d49u,0x8cd37cf3u,0xfbd44c65u,
+    0x4db26158u,0x3ab551ceu,0xa3bc0074u,0xd4bb30e2u,0x4adfa541u,0x3dd895d7u,0xa4d1c46du,0xd3d6f4fbu,
+    0x4369e96au,0x346ed9fcu,0xad678846u,0xda60b8d0u,0x44042d73u,0x33031de5u,0xaa0a4c5fu,0xdd0d7cc9u,
+    0x5005713cu,0x270241aau,0xbe0b1010u,0xc90c2086u,0x5768b525u,0x206f85b3u,0xb966d409u,0xce61e49fu,
+    0x5edef90eu,0x29d9c998u,0xb0d09822u,0xc7d7a8b4u,0x59b33d17u,0x2eb40d81u,0xb7bd5c3bu,0xc0ba6cadu,
+    0xedb88320u,0x9abfb3b6u,0x03b6e20cu,0x74b1d29au,0xead54739u,0x9dd277afu,0x04db2615u,0x73dc1683u,
+    0xe3630b12u,0x94643b84u,0x0d6d6a3eu,0x7a6a5aa8u,0xe40ecf0bu,0x9309ff9du,0x0a00ae27u,0x7d079eb1u,
+    0xf00f9344u,0x8708a3d2u,0x1e01f268u,0x6906c2feu,0xf762575du,0x806567cbu,0x196c3671u,0x6e6b06e7u,
+    0xfed41b76u,0x89d32be0u,0x10da7a5au,0x67dd4accu,0xf9b9df6fu,0x8ebeeff9u,0x17b7be43u,0x60b08ed5u,
+    0xd6d6a3e8u,0xa1d1937eu,0x38d8c2c4u,0x4fdff252u,0xd1bb67f1u,0xa6bc5767u,0x3fb506ddu,0x48b2364bu,
+    0xd80d2bdau,0xaf0a1b4cu,0x36034af6u,0x41047a60u,0xdf60efc3u,0xa867df55u,0x316e8eefu,0x4669be79u,
+    0xcb61b38cu,0xbc66831au,0x256fd2a0u,0x5268e236u,0xcc0c7795u,0xbb0b4703u,0x220216b9u,0x5505262fu,
+    0xc5ba3bbeu,0xb2bd0b28u,0x2bb45a92u,0x5cb36a04u,0xc2d7ffa7u,0xb5d0cf31u,0x2cd99e8bu,0x5bdeae1du,
+    0x9b64c2b0u,0xec63f226u,0x756aa39cu,0x026d930au,0x9c0906a9u,0xeb0e363fu,0x72076785u,0x05005713u,
+    0x95bf4a82u,0xe2b87a14u,0x7bb12baeu,0x0cb61b38u,0x92d28e9bu,0xe5d5be0du,0x7cdcefb7u,0x0bdbdf21u,
+    0x86d3d2d4u,0xf1d4e242u,0x68ddb3f8u,0x1fda836eu,0x81be16cdu,0xf6b9265bu,0x6fb077e1u,0x18b74777u,
+    0x88085ae6u,0xff0f6a70u,0x66063bcau,0x11010b5cu,0x8f659effu,0xf862ae69u,0x616bffd3u,0x166ccf45u,
+    0xa00ae278u,0xd70dd2eeu,0x4e048354u,0x3903b3c2u,0xa7672661u,0xd06016f7u,0x4969474du,0x3e6e77dbu,
+    0xaed16a4au,0xd9d65adcu,0x40df0b66u,0x37d83bf0u,0xa9bcae53u,0xdebb9ec5u,0x47b2cf7fu,0x30b5ffe9u,
+    0xbdbdf21cu,0xcabac28au,0x53b39330u,0x24b4a3a6u,0xbad03605u,0xcdd70693u,0x54de5729u,0x23d967bfu,
+    0xb3667a2eu,0xc4614ab8u,0x5d681b02u,0x2a6f2b94u,0xb40bbe37u,0xc30c8ea1u,0x5a05df1bu,0x2d02ef8du
+    };
+    const uint8_t * p = buf;
+    uint32_t crc = 0xffffffffu;
+
+    while(len--)
+    {
+        crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
@@ -0,0 +1,100 @@
+/** @brief Gh log parser constants, structures, function prototypes
+*   @file ghlog.h
+*
+*   Parses the fixed-layout lines written by GhLogData() without the
+*   controller headers, so the log tools build on machines without the
+*   Sense Hat libraries.
+*
+*   With LOGRAW a line may carry a raw channel after the three values:
+*   ",r,<T counts>,<H counts>,<P counts>,<calibration id>". The counts are
+*   the unfiltered sample; the registry in LOGCALFILE maps each calibration
+*   id to the gain and offset that turn counts back into units. The logged
+*   values are filtered, so they are not those units: ghc-recal moves them
+*   by the change in calibration instead of converting the counts afresh.
+*
+*   With LOGDERIVED the line ends ",d,<dew point>,<VPD>". Readers that want
+*   only the values ignore it; ghc-recal drops it from the lines it
+*   recalibrates, since it follows from the values it replaces.
+*
+*   GhCrc32() is kept here with the other code the standalone tools share.
+*/
+#ifndef GHLOG_H
+#define GHLOG_H
+
+// Includes
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// Log Parser Constants
+#define LOGDATESZ 24        // "Wed,Jun,30,21:49:08,1993"
+#define LOGVALUES 3
+#define LOGBATCHSZ 4096     // samples per parsed batch
+#define LOGCHUNKSZ 262144   // bytes read per streaming chunk
+#define LOGRAW 1            // 1 appends the raw channel to logged lines
+#define LOGDERIVED 0        // 1 appends the dew point and VPD to logged lines
+#define LOGCALFILE "ghcal.txt"
+#define LOGCALLINESZ 256
+
+//Typedefs
+typedef struct logtime
+{
+    int year;
+    int month;          // 1 to 12
+    int day;
+    int hour;
+    int minute;
+    int second;
+}logtime_s;
+
+typedef struct lograw
+{
+    double value[LOGVALUES];    // as logged, after the filter
+    int32_t count[LOGVALUES];
+    uint32_t calid;
+}lograw_s;
+
+typedef struct logcal
+{
+    uint32_t id;
+    double gain[LOGVALUES];
+    double offset[LOGVALUES];
+}logcal_s;
+
+typedef struct logbatch
+{
+    int n;
+    time_t rtime[LOGBATCHSZ];
+    double temperature[LOGBATCHSZ];
+    double humidity[LOGBATCHSZ];
+    double pressure[LOGBATCHSZ];
+}logbatch_s;
+
+typedef struct logstream
+{
+    int fd;
+    int eof;
+    size_t len;
+    size_t pos;
+    uint64_t bytes;
+    char buf[LOGCHUNKSZ];
+}logstream_s;
+
+// Function Prototypes
+///@cond INTERNAL
+const char * GhLogNextLine(const char * p, const char * end);
+int GhLogParseLine(const char * p, const char * end, logtime_s * lt, double * v);
+int64_t GhLogDays(int year, int month, int day);
+time_t GhLogSeconds(const logtime_s * lt);
+void GhLogCivil(int64_t days, int * year, int * month, int * day);
+int GhLogOpen(logstream_s * ls, const char * fname);
+int GhLogRead(logstream_s * ls, logbatch_s * batch);
+void GhLogClose(logstream_s * ls);
+int GhLogParseRaw(const char * p, const char * end, lograw_s * raw);
+int GhLogLoadCal(const char * fname, logcal_s * cal, int max);
+int GhLogSaveCal(const char * fname, const logcal_s * cal);
+const logcal_s * GhLogFindCal(const logcal_s * cal, int n, uint32_t id);
+uint32_t GhCrc32(const void * buf, size_t len);
+///@endcond
+
+#endif
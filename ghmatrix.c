@@ -0,0 +1,587 @@
+/** @brief Gh LED matrix dashboard functions
+*   @file ghmatrix.c
+*/
+#include <ctype.h>
+#include "ghmatrix.h"
+#include "ghbatch.h"
+#include "ghplant.h"
+
+// 5x7 glyphs from ' ' to 'Z', one byte per column, bit 0 at the top
+static const uint8_t mxfont['Z' - ' ' + 1][MXGLYPHW] =
+{
+    {0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x5F,0x00,0x00},{0x00,0x07,0x00,0x07,0x00},{0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12},{0x23,0x13,0x08,0x64,0x62},{0x36,0x49,0x56,0x20,0x50},{0x00,0x08,0x07,0x03,0x00},
+    {0x00,0x1C,0x22,0x41,0x00},{0x00,0x41,0x22,0x1C,0x00},{0x2A,0x1C,0x7F,0x1C,0x2A},{0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x80,0x70,0x30,0x00},{0x08,0x08,0x08,0x08,0x08},{0x00,0x00,0x60,0x60,0x00},{0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E},{0x00,0x42,0x7F,0x40,0x00},{0x72,0x49,0x49,0x49,0x46},{0x21,0x41,0x49,0x4D,0x33},
+    {0x18,0x14,0x12,0x7F,0x10},{0x27,0x45,0x45,0x45,0x39},{0x3C,0x4A,0x49,0x49,0x31},{0x41,0x21,0x11,0x09,0x07},
+    {0x36,0x49,0x49,0x49,0x36},{0x46,0x49,0x49,0x29,0x1E},{0x00,0x00,0x14,0x00,0x00},{0x00,0x40,0x34,0x00,0x00},
+    {0x00,0x08,0x14,0x22,0x41},{0x14,0x14,0x14,0x14,0x14},{0x00,0x41,0x22,0x14,0x08},{0x02,0x01,0x59,0x09,0x06},
+    {0x3E,0x41,0x5D,0x59,0x4E},{0x7C,0x12,0x11,0x12,0x7C},{0x7F,0x49,0x49,0x49,0x36},{0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x41,0x3E},{0x7F,0x49,0x49,0x49,0x41},{0x7F,0x09,0x09,0x09,0x01},{0x3E,0x41,0x41,0x51,0x73},
+    {0x7F,0x08,0x08,0x08,0x7F},{0x00,0x41,0x7F,0x41,0x00},{0x20,0x40,0x41,0x3F,0x01},{0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40},{0x7F,0x02,0x1C,0x02,0x7F},{0x7F,0x04,0x08,0x10,0x7F},{0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06},{0x3E,0x41,0x51,0x21,0x5E},{0x7F,0x09,0x19,0x29,0x46},{0x26,0x49,0x49,0x49,0x32},
+    {0x03,0x01,0x7F,0x01,0x03},{0x3F,0x40,0x40,0x40,0x3F},{0x1F,0x20,0x40,0x20,0x1F},{0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63},{0x03,0x04,0x78,0x04,0x03},{0x61,0x59,0x49,0x4D,0x43}
+};
+
+static const char mxpagenames[MXPAGES][8] = {"bars","temp","humid","press","alarms"};
+
+/** @brief Reads the monotonic clock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t nanoseconds
+*/
+static int64_t GhMatrixNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Sets one pixel of the frame being composed
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param x column, 0 on the left
+ *  @param y row, 0 at the top
+ *  @param colour RGB565 colour
+ *  @return void
+*/
+static inline void GhMatrixSet(ghmatrix_s * mx, int x, int y, uint16_t colour)
+{
+    mx->frame[mx->index[y * MXSIZE + x]] = colour;
+}
+
+/** @brief Draws a column from the bottom row up
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param x column
+ *  @param height pixels lit, 0 to MXSIZE
+ *  @param colour RGB565 colour
+ *  @return void
+*/
+static void GhMatrixColumn(ghmatrix_s * mx, int x, int height, uint16_t colour)
+{
+    int y;
+    height = (height < 0) ? 0 : ((height > MXSIZE) ? MXSIZE : height);
+    for(y=MXSIZE-height; y<MXSIZE; y++)
+    {
+        GhMatrixSet(mx,x,y,colour);
+    }
+}
+
+/** @brief Scales a value onto the rows the way GhDisplayAll() does
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param v value
+ *  @param lo value of an empty bar
+ *  @param hi value of a full bar
+ *  @return int row count minus one, 0 to MXSIZE - 1
+*/
+static int GhMatrixLevel(double v, double lo, double hi)
+{
+    double rv = (8.0 * (((v - lo) / (hi - lo)) + 0.05)) - 1.0;
+    if(!(rv > 0))
+    {
+        return 0;
+    }
+    return (rv > MXSIZE - 1) ? MXSIZE - 1 : (int) rv;
+}
+
+/** @brief Composes the reading bars with the targets marked
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return void
+*/
+static void GhMatrixBars(ghmatrix_s * mx)
+{
+    const ghsnapshot_s * s = &mx->snap;
+    GhMatrixColumn(mx,TBAR,GhMatrixLevel(s->rdata.temperature,LSTEMP,USTEMP) + 1,MXGREEN);
+    GhMatrixColumn(mx,HBAR,GhMatrixLevel(s->rdata.humidity,LSHUMID,USHUMID) + 1,MXGREEN);
+    GhMatrixColumn(mx,PBAR,GhMatrixLevel(s->rdata.pressure,LSPRESS,USPRESS) + 1,MXGREEN);
+    GhMatrixSet(mx,TBAR,MXSIZE - 1 - GhMatrixLevel(s->spts.temperature,LSTEMP,USTEMP),MXMAGENTA);
+    GhMatrixSet(mx,HBAR,MXSIZE - 1 - GhMatrixLevel(s->spts.humidity,LSHUMID,USHUMID),MXMAGENTA);
+}
+
+/** @brief Composes the sparkline of one channel's minute means
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param k TEMPERATURE, HUMIDITY or PRESSURE
+ *  @return void
+*/
+static void GhMatrixSpark(ghmatrix_s * mx, int k)
+{
+    static const double span[SENSORS] = {MXTSPAN,MXHSPAN,MXPSPAN};
+    static const uint16_t colour[SENSORS] = {MXAMBER,MXCYAN,MXGREEN};
+    rollup_s spark[MXSPARKCOLS];
+    double low[SENSORS] = {mx->limits.lowt,mx->limits.lowh,mx->limits.lowp};
+    double high[SENSORS] = {mx->limits.hight,mx->limits.highh,mx->limits.highp};
+    double lo = INFINITY;
+    double hi = -INFINITY;
+    double mid;
+    int n;
+    int i;
+    int x;
+
+    n = (mx->hist == NULL) ? 0 : GhHistoryQuery(mx->hist,HISTMINUTE,MXSPARKCOLS,spark);
+    for(i=0; i<n; i++)
+    {
+        lo = fmin(lo,spark[i].mean[k]);
+        hi = fmax(hi,spark[i].mean[k]);
+    }
+    if(hi - lo < span[k])
+    {
+        mid = (hi + lo) / 2;
+        lo = mid - span[k] / 2;
+        hi = mid + span[k] / 2;
+    }
+
+    // A minute that touched an alarm limit is drawn red, one without a reading is left dark
+    for(i=0; i<n; i++)
+    {
+        x = MXSIZE - n + i;
+        if(isnan(spark[i].mean[k]))
+        {
+            continue;
+        }
+        GhMatrixColumn(mx,x,1 + (int)((spark[i].mean[k] - lo) / (hi - lo) * (MXSIZE - 1) + 0.5),
+            (spark[i].min[k] <= low[k] || spark[i].max[k] >= high[k]) ? MXRED : colour[k]);
+    }
+}
+
+/** @brief Turns the active and predicted alarm names into glyph columns
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param mask ALARMBIT(code) of active alarms, shifted up NALARMS for predicted ones
+ *  @return void
+*/
+static void GhMatrixText(ghmatrix_s * mx, uint32_t mask)
+{
+    int code;
+    int c;
+    int i;
+    int n = MXSIZE;
+    uint16_t colour;
+    const char * p;
+
+    memset(mx->text,0,sizeof(mx->text));
+    for(code=HTEMP; code<2*NALARMS; code++)
+    {
+        if(!(mask & (1u << code)) || code == NALARMS)
+        {
+            continue;
+        }
+        colour = (code < NALARMS) ? MXRED : MXAMBER;
+        for(p = alarmnames[code % NALARMS]; *p != '\0' && n + 2 * (MXGLYPHW + 1) + MXSIZE <= MXTEXTSZ; p++)
+        {
+            c = toupper((unsigned char) *p);
+            c = (c < ' ' || c > 'Z') ? '?' : c;
+            for(i=0; i<MXGLYPHW; i++, n++)
+            {
+                mx->text[n] = mxfont[c - ' '][i];
+                mx->textcolour[n] = colour;
+            }
+            n++;
+        }
+        n += 2 * (MXGLYPHW + 1);
+    }
+    mx->textmask = mask;
+    mx->textlen = (mask != 0) ? n - 2 * (MXGLYPHW + 1) + MXSIZE : 0;
+    mx->scroll = 0;
+}
+
+/** @brief Composes the text window at the scroll position
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return void
+*/
+static void GhMatrixScroll(ghmatrix_s * mx)
+{
+    int x;
+    int y;
+    int col;
+    for(x=0; x<MXSIZE; x++)
+    {
+        col = mx->scroll + x;
+        for(y=0; col < mx->textlen && y<MXSIZE; y++)
+        {
+            if(mx->text[col] & (1 << y))
+            {
+                GhMatrixSet(mx,x,y,mx->textcolour[col]);
+            }
+        }
+    }
+}
+
+/** @brief Composes the current page and copies it out if it changed
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return void
+*/
+static void GhMatrixRender(ghmatrix_s * mx)
+{
+    int64_t ns = GhMatrixNs();
+
+    memset(mx->frame,0,sizeof(mx->frame));
+    switch(mx->page)
+    {
+        case MXBARS:
+            GhMatrixBars(mx);
+            break;
+        case MXTEMP:
+            GhMatrixSpark(mx,TEMPERATURE);
+            break;
+        case MXHUMID:
+            GhMatrixSpark(mx,HUMIDITY);
+            break;
+        case MXPRESS:
+            GhMatrixSpark(mx,PRESSURE);
+            break;
+        default:
+            GhMatrixScroll(mx);
+            break;
+    }
+    if(memcmp(mx->frame,mx->shown,sizeof(mx->frame)) != 0)
+    {
+        memcpy(mx->fb,mx->frame,sizeof(mx->frame));
+        memcpy(mx->shown,mx->frame,sizeof(mx->frame));
+        mx->pushes++;
+    }
+    mx->frames++;
+    ns = GhMatrixNs() - ns;
+    mx->nssum += ns;
+    mx->nsmax = (ns > mx->nsmax) ? ns : mx->nsmax;
+}
+
+/** @brief Sets the timer for the next page change or scroll step
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param nowms monotonic milliseconds
+ *  @return void
+*/
+static void GhMatrixArm(ghmatrix_s * mx, int64_t nowms)
+{
+    struct itimerspec its = {0};
+    int64_t ms;
+
+    mx->nextms = (mx->page == MXALARMS) ? nowms + MXSCROLLMS : mx->pageend;
+    if(mx->timerfd != -1)
+    {
+        ms = (mx->nextms > nowms) ? mx->nextms - nowms : 1;
+        its.it_value.tv_sec = ms / 1000;
+        its.it_value.tv_nsec = (ms % 1000) * 1000000;
+        timerfd_settime(mx->timerfd,0,&its,NULL);
+    }
+}
+
+/** @brief Finds how long one pass of the alarm text takes
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return int64_t milliseconds
+*/
+static int64_t GhMatrixTextMs(const ghmatrix_s * mx)
+{
+    return (int64_t)((mx->textlen > MXSIZE) ? mx->textlen - MXSIZE + 1 : 1) * MXSCROLLMS;
+}
+
+/** @brief Moves to a page
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param page page to show
+ *  @param nowms monotonic milliseconds
+ *  @return void
+*/
+static void GhMatrixPage(ghmatrix_s * mx, mxpage_e page, int64_t nowms)
+{
+    mx->page = page;
+    mx->scroll = 0;
+    mx->pageend = nowms + ((page == MXALARMS) ? GhMatrixTextMs(mx) : MXPAGEMS);
+}
+
+/** @brief Opens the Sense Hat framebuffer or a file standing in for it
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param fname file-backed framebuffer, created if needed, or NULL for the Sense Hat
+ *  @return int 1 if the matrix is ready, 0 to fall back to GhDisplayAll()
+*/
+int GhMatrixOpen(ghmatrix_s * mx, const char * fname)
+{
+    int x;
+    int y;
+    int rx;
+    int ry;
+
+    memset(mx,0,sizeof(ghmatrix_s));
+    mx->fd = -1;
+    mx->timerfd = -1;
+    for(y=0; y<MXSIZE; y++)
+    {
+        for(x=0; x<MXSIZE; x++)
+        {
+            rx = (MXROTATE == 90) ? MXSIZE - 1 - y : ((MXROTATE == 180) ? MXSIZE - 1 - x : ((MXROTATE == 270) ? y : x));
+            ry = (MXROTATE == 90) ? x : ((MXROTATE == 180) ? MXSIZE - 1 - y : ((MXROTATE == 270) ? MXSIZE - 1 - x : y));
+            mx->index[y * MXSIZE + x] = ry * MXSIZE + rx;
+        }
+    }
+    if(!MXENABLE)
+    {
+        return 0;
+    }
+    if(fname == NULL)
+    {
+        mx->fb = ShFrameBuffer();
+        return mx->fb != NULL;
+    }
+    mx->fd = open(fname,O_RDWR | O_CREAT | O_CLOEXEC,0644);
+    if(mx->fd == -1 || ftruncate(mx->fd,FILESIZE) == -1)
+    {
+        GhMatrixClose(mx);
+        return 0;
+    }
+    mx->fb = mmap(NULL,FILESIZE,PROT_READ | PROT_WRITE,MAP_SHARED,mx->fd,0);
+    if(mx->fb == MAP_FAILED)
+    {
+        mx->fb = NULL;
+        GhMatrixClose(mx);
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Creates the timer that drives page changes and scrolling
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return int 1 on success, 0 on error
+*/
+int GhMatrixStart(ghmatrix_s * mx)
+{
+    mx->timerfd = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+    return mx->timerfd != -1;
+}
+
+/** @brief Takes a new sample, switching to the alarm text when an alarm appears
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param hist pointer to history store for the sparklines
+ *  @param snap pointer to the latest snapshot
+ *  @param limits alarm limits, marked on the sparklines
+ *  @param nowms monotonic milliseconds
+ *  @return void
+*/
+void GhMatrixUpdate(ghmatrix_s * mx, history_s * hist, const ghsnapshot_s * snap, alarmlimit_s limits, int64_t nowms)
+{
+    uint32_t mask = (snap->alarms & ~(1u << NOALARM)) | ((snap->predicted & ~snap->alarms) << NALARMS);
+    uint32_t appeared = mask & ~mx->textmask;
+
+    if(mx->fb == NULL)
+    {
+        return;
+    }
+    mx->hist = hist;
+    mx->snap = *snap;
+    mx->limits = limits;
+    if(mask != mx->textmask)
+    {
+        GhMatrixText(mx,mask);
+        if(appeared != 0)
+        {
+            GhMatrixPage(mx,MXALARMS,nowms);
+        }
+        else if(mx->page == MXALARMS)
+        {
+            mx->pageend = nowms + GhMatrixTextMs(mx);
+        }
+    }
+    if(mx->frames == 0)
+    {
+        GhMatrixPage(mx,(mask != 0) ? MXALARMS : MXBARS,nowms);
+    }
+    GhMatrixRender(mx);
+    GhMatrixArm(mx,nowms);
+}
+
+/** @brief Scrolls the text or rotates to the next page when the timer expires
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @param nowms monotonic milliseconds
+ *  @return void
+*/
+void GhMatrixTick(ghmatrix_s * mx, int64_t nowms)
+{
+    uint64_t expiries;
+    mxpage_e next;
+
+    if(mx->timerfd != -1 && read(mx->timerfd,&expiries,sizeof(expiries)) != sizeof(expiries))
+    {
+        return;
+    }
+    if(mx->fb == NULL || nowms < mx->nextms)
+    {
+        return;
+    }
+    if(nowms >= mx->pageend || (mx->page == MXALARMS && mx->textlen == 0))
+    {
+        // The alarm page joins the rotation only while there is text to show
+        next = (mx->page + 1) % MXPAGES;
+        next = (next == MXALARMS && mx->textlen == 0) ? MXBARS : next;
+        GhMatrixPage(mx,next,nowms);
+    }
+    else if(mx->page == MXALARMS)
+    {
+        mx->scroll = (mx->scroll + 1 + MXSIZE > mx->textlen) ? 0 : mx->scroll + 1;
+    }
+    GhMatrixRender(mx);
+    GhMatrixArm(mx,nowms);
+}
+
+/** @brief Prints the page shown and the cost of composing frames
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return void
+*/
+void GhMatrixDisplay(ghmatrix_s * mx)
+{
+    if(mx->fb == NULL || mx->frames == 0)
+    {
+        return;
+    }
+    fprintf(stdout,"Matrix\t\tPage: %s\tFrames: %llu (%llu copied)\t%.2lf us/frame\n",mxpagenames[mx->page],
+        (unsigned long long) mx->frames,(unsigned long long) mx->pushes,mx->nssum / 1e3 / mx->frames);
+}
+
+/** @brief Releases the timer and a file-backed framebuffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param mx pointer to matrix
+ *  @return void
+*/
+void GhMatrixClose(ghmatrix_s * mx)
+{
+    if(mx->fd != -1)
+    {
+        if(mx->fb != NULL)
+        {
+            munmap(mx->fb,FILESIZE);
+        }
+        close(mx->fd);
+        mx->fd = -1;
+    }
+    if(mx->timerfd != -1)
+    {
+        close(mx->timerfd);
+        mx->timerfd = -1;
+    }
+    mx->fb = NULL;
+}
+
+/** @brief Drives the dashboard from the plant simulator into a file-backed framebuffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname framebuffer file, left holding the last frame
+ *  @param hours simulated hours
+ *  @param spts object of setpoints type
+ *  @param limits alarm limits
+ *  @param fp report stream
+ *  @return int 1 on success, 0 if the file cannot be mapped
+*/
+int GhMatrixReport(const char * fname, double hours, setpoint_s spts, alarmlimit_s limits, FILE * fp)
+{
+    static const double eta[NALARMS] = {0};
+    static ghmatrix_s mx;
+    static history_s hist;
+    plant_s pl;
+    ghsnapshot_s snap = {0};
+    alarm_s * head;
+    alarm_s * next;
+    control_s ctrl = {0};
+    reading_s rd;
+    int64_t nowms = 0;
+    int64_t endms = (int64_t)(hours * 3600e3);
+    int64_t sample = 0;
+    double t0;
+    uint64_t visits[MXPAGES] = {0};
+    mxpage_e last = MXPAGES;
+    int x;
+    int y;
+
+    head = (alarm_s *) calloc(1,sizeof(alarm_s));
+    if(head == NULL || !GhMatrixOpen(&mx,fname))
+    {
+        free(head);
+        return 0;
+    }
+    GhHistoryInit(&hist);
+    GhPlantInit(&pl,PLANTSEED);
+    t0 = pl.t;
+    while(nowms < endms)
+    {
+        // Plant steps up to whichever comes first, the next sample or the next frame
+        if(nowms >= sample)
+        {
+            rd = GhPlantRead(&pl);
+            GhHistoryAdd(&hist,rd);
+            ctrl = GhSetControls(spts,rd);
+            head = GhSetAlarms(head,limits,rd);
+            GhShmSnapshot(&snap,rd,spts,ctrl,head,0,eta);
+            GhMatrixUpdate(&mx,&hist,&snap,limits,nowms);
+            sample += GHUPDATE;
+        }
+        else
+        {
+            GhMatrixTick(&mx,nowms);
+        }
+        if(mx.page != last)
+        {
+            visits[mx.page]++;
+            last = mx.page;
+        }
+        while((pl.t - t0) * 1000.0 < (double)((mx.nextms < sample) ? mx.nextms : sample))
+        {
+            GhPlantStep(&pl,ctrl,PLANTDT);
+        }
+        nowms = (mx.nextms < sample) ? mx.nextms : sample;
+    }
+
+    fprintf(fp,"Matrix dashboard, %.1lf hours into %s\n",hours,fname);
+    fprintf(fp,"frames %llu, copied %llu, %.2lf us/frame mean, %.2lf us max\n",(unsigned long long) mx.frames,
+        (unsigned long long) mx.pushes,mx.nssum / 1e3 / mx.frames,mx.nsmax / 1e3);
+    fprintf(fp,"page visits:");
+    for(x=0; x<MXPAGES; x++)
+    {
+        fprintf(fp," %s %llu",mxpagenames[x],(unsigned long long) visits[x]);
+    }
+    fprintf(fp,"\nlast frame (%s):\n",mxpagenames[mx.page]);
+    for(y=0; y<MXSIZE; y++)
+    {
+        for(x=0; x<MXSIZE; x++)
+        {
+            fputc(mx.fb[y * MXSIZE + x] == MXBLACK ? '.' : (mx.fb[y * MXSIZE + x] == MXRED ? 'R' : '#'),fp);
+        }
+        fputc('\n',fp);
+    }
+    GhMatrixClose(&mx);
+    while(head != NULL)
+    {
+        next = head->next;
+        free(head);
+        head = next;
+    }
+    return 1;
+}
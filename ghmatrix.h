@@ -0,0 +1,85 @@
+/** @brief Gh LED matrix dashboard constants, structures, function prototypes
+*   @file ghmatrix.h
+*
+*   Pages rotate on the 8x8 matrix: the reading bars of GhDisplayAll(), a
+*   sparkline of the last MXSPARKCOLS minutes for each channel, and, while
+*   any alarm is active or predicted, the alarm names scrolling past. Each
+*   frame is composed in RAM and copied to the framebuffer in one go, and
+*   only when it differs from the frame already shown. Alarm text is turned
+*   into glyph columns once, when the set of alarms changes; scrolling then
+*   only moves a window over those columns. The framebuffer is the Sense
+*   Hat's, or a plain file of the same size for tests.
+*/
+#ifndef GHMATRIX_H
+#define GHMATRIX_H
+
+// Includes
+#include <sys/timerfd.h>
+#include "ghcontrol.h"
+#include "ghhistory.h"
+#include "ghshm.h"
+
+// Matrix Constants
+#define MXENABLE 1              // 0 keeps the three bars of GhDisplayAll()
+#define MXSIZE 8
+#define MXPIXELS (MXSIZE * MXSIZE)
+#define MXROTATE 0              // degrees clockwise the matrix is mounted, 0, 90, 180 or 270
+#define MXPAGEMS 5000           // ms each static page is shown
+#define MXSCROLLMS 80           // ms per column of scrolling text
+#define MXSPARKCOLS MXSIZE      // minute rollups per sparkline, newest on the right
+#define MXTEXTSZ 1024           // columns of rendered alarm text
+#define MXGLYPHW 5              // glyph columns, followed by one blank
+#define MXTSPAN 1.0             // C, smallest sparkline range
+#define MXHSPAN 4.0             // %RH
+#define MXPSPAN 2.0             // mB
+
+// RGB565 Colours
+#define MXBLACK 0x0000
+#define MXRED 0xF800
+#define MXAMBER 0xFC00
+#define MXGREEN 0x07E0
+#define MXBLUE 0x001F
+#define MXCYAN 0x07FF
+#define MXMAGENTA 0xF81F
+
+//Enumerated Types
+typedef enum { MXBARS, MXTEMP, MXHUMID, MXPRESS, MXALARMS, MXPAGES } mxpage_e;
+
+//Typedefs
+typedef struct ghmatrix
+{
+    uint16_t frame[MXPIXELS];   // composed here
+    uint16_t shown[MXPIXELS];   // last frame copied out
+    uint8_t index[MXPIXELS];    // frame offset of each (x, y) after MXROTATE
+    uint16_t * fb;              // mapped framebuffer, NULL when closed
+    int fd;                     // file-backed framebuffer, -1 for the Sense Hat's
+    int timerfd;                // -1 in simulated time
+    mxpage_e page;
+    int64_t nextms;             // next page change or scroll step
+    int64_t pageend;
+    history_s * hist;
+    ghsnapshot_s snap;          // latest sample, targets and alarms
+    alarmlimit_s limits;
+    uint32_t textmask;          // active and predicted alarms the text was built for
+    int textlen;
+    int scroll;                 // first text column on screen
+    uint8_t text[MXTEXTSZ];     // glyph columns, bit 0 at the top
+    uint16_t textcolour[MXTEXTSZ];
+    uint64_t frames;            // frames composed
+    uint64_t pushes;            // frames that changed and were copied out
+    int64_t nssum;              // compose and copy time
+    int64_t nsmax;
+}ghmatrix_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhMatrixOpen(ghmatrix_s * mx, const char * fname);
+int GhMatrixStart(ghmatrix_s * mx);
+void GhMatrixUpdate(ghmatrix_s * mx, history_s * hist, const ghsnapshot_s * snap, alarmlimit_s limits, int64_t nowms);
+void GhMatrixTick(ghmatrix_s * mx, int64_t nowms);
+void GhMatrixDisplay(ghmatrix_s * mx);
+void GhMatrixClose(ghmatrix_s * mx);
+int GhMatrixReport(const char * fname, double hours, setpoint_s spts, alarmlimit_s limits, FILE * fp);
+///@endcond
+
+#endif
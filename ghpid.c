@@ -0,0 +1,258 @@
+/** @brief Gh PID control functions
+*   @file ghpid.c
+*/
+#include <unistd.h>
+#include "ghpid.h"
+
+/** @brief Sets up the loops with the default gains
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @param enabled 1 for PID, 0 for the bang-bang GhSetControls()
+ *  @return void
+*/
+void GhPidInit(ghpid_s * pid, int enabled)
+{
+    memset(pid,0,sizeof(ghpid_s));
+    pid->enabled = enabled;
+    pid->timerfd = -1;
+    pid->lastms = -1;
+    pid->wstart = -1;
+    pid->loop[TEMPERATURE].kp = PIDTKP;
+    pid->loop[TEMPERATURE].ti = PIDTTI;
+    pid->loop[TEMPERATURE].td = PIDTTD;
+    pid->loop[HUMIDITY].kp = PIDHKP;
+    pid->loop[HUMIDITY].ti = PIDHTI;
+    pid->loop[HUMIDITY].td = PIDHTD;
+}
+
+/** @brief Creates the timer that switches the relays between samples
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @return int 1 on success, 0 on error
+*/
+int GhPidStart(ghpid_s * pid)
+{
+    pid->timerfd = timerfd_create(CLOCK_MONOTONIC,TFD_NONBLOCK | TFD_CLOEXEC);
+    if(pid->timerfd == -1)
+    {
+        perror("Error (output timer)");
+        return 0;
+    }
+    return 1;
+}
+
+/** @brief Closes the output timer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @return void
+*/
+void GhPidStop(ghpid_s * pid)
+{
+    if(pid->timerfd != -1)
+    {
+        close(pid->timerfd);
+        pid->timerfd = -1;
+    }
+}
+
+/** @brief Advances one loop by a sample
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param lp pointer to loop
+ *  @param target setpoint
+ *  @param measured filtered reading, NAN holds the output for up to PIDSTALESECS
+ *  @param dt seconds since the previous sample, 0 (re)starts the loop
+ *  @return double duty cycle, 0 to 100
+*/
+double GhPidStep(pidloop_s * lp, double target, double measured, double dt)
+{
+    double e;
+    double v;
+    double u;
+    double tf;
+    double tt;
+
+    if(isnan(measured))
+    {
+        // A dead sensor must not hold a relay on indefinitely
+        lp->stale += dt;
+        if(lp->stale >= PIDSTALESECS)
+        {
+            lp->out = 0.0;
+            lp->integral = 0.0;
+            lp->dterm = 0.0;
+            lp->primed = 0;
+        }
+        return lp->out;
+    }
+    lp->stale = 0.0;
+    if(!lp->primed || dt <= 0)
+    {
+        lp->last = measured;
+        lp->primed = 1;
+        dt = 0;
+    }
+    e = target - measured;
+
+    // Derivative on the measurement, so a setpoint change does not kick the output
+    if(lp->td > 0 && dt > 0)
+    {
+        tf = lp->td / PIDDFILTER;
+        lp->dterm = (tf * lp->dterm - lp->kp * lp->td * (measured - lp->last)) / (tf + dt);
+    }
+    v = lp->kp * e + lp->integral + lp->dterm;
+    u = fmin(100.0,fmax(0.0,v));
+
+    // Back-calculation: while saturated, bleed the integral toward the limit
+    if(lp->ti > 0 && dt > 0)
+    {
+        tt = (lp->td > 0) ? sqrt(lp->ti * lp->td) : lp->ti;
+        lp->integral += lp->kp * dt / lp->ti * e + fmin(1.0,dt / tt) * (u - v);
+    }
+    lp->last = measured;
+    lp->out = u;
+    return u;
+}
+
+/** @brief Recomputes the duty cycles from a new sample
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @param target object of setpoints (targets) data
+ *  @param rdata object of readings data, stale channels hold their output, then switch off
+ *  @param nowms monotonic milliseconds
+ *  @return object of controls type
+*/
+control_s GhPidUpdate(ghpid_s * pid, setpoint_s target, reading_s rdata, int64_t nowms)
+{
+    int k;
+    control_s cset;
+    double dt = (pid->lastms < 0) ? 0.0 : (nowms - pid->lastms) / 1000.0;
+
+    pid->lastms = nowms;
+    if(!pid->enabled)
+    {
+        cset = GhSetControls(target,rdata);
+        for(k=0; k<PIDLOOPS; k++)
+        {
+            pid->loop[k].stale = (rdata.stale & (1 << k)) ? pid->loop[k].stale + dt : 0.0;
+        }
+        if(pid->loop[TEMPERATURE].stale >= PIDSTALESECS)
+        {
+            cset.heateron = OFF;
+            cset.heater = 0.0;
+        }
+        if(pid->loop[HUMIDITY].stale >= PIDSTALESECS)
+        {
+            cset.humidifieron = OFF;
+            cset.humidifier = 0.0;
+        }
+        pid->toggles[TEMPERATURE] += (cset.heateron != pid->ctrl.heateron);
+        pid->toggles[HUMIDITY] += (cset.humidifieron != pid->ctrl.humidifieron);
+        pid->ctrl = cset;
+        return cset;
+    }
+    GhPidStep(&pid->loop[TEMPERATURE],target.temperature,
+        (rdata.stale & (1 << TEMPERATURE)) ? NAN : rdata.temperature,dt);
+    GhPidStep(&pid->loop[HUMIDITY],target.humidity,
+        (rdata.stale & (1 << HUMIDITY)) ? NAN : rdata.humidity,dt);
+    return GhPidOutputs(pid,nowms);
+}
+
+/** @brief Switches the relays for the current point in the window
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @param nowms monotonic milliseconds
+ *  @return object of controls type
+*/
+control_s GhPidOutputs(ghpid_s * pid, int64_t nowms)
+{
+    int k;
+    int on[PIDLOOPS];
+    int newwindow = 0;
+    int64_t ontime;
+    int64_t edge;
+    int64_t next;
+    struct itimerspec its = {0};
+
+    if(!pid->enabled)
+    {
+        return pid->ctrl;
+    }
+    if(pid->wstart < 0 || nowms - pid->wstart >= PIDWINDOW)
+    {
+        pid->wstart = (pid->wstart < 0) ? nowms : pid->wstart + (nowms - pid->wstart) / PIDWINDOW * PIDWINDOW;
+        newwindow = 1;
+    }
+    on[TEMPERATURE] = pid->ctrl.heateron;
+    on[HUMIDITY] = pid->ctrl.humidifieron;
+    next = pid->wstart + PIDWINDOW;
+    for(k=0; k<PIDLOOPS; k++)
+    {
+        ontime = llround(pid->loop[k].out * PIDWINDOW / 100.0);
+        ontime = (ontime < PIDMINPULSE) ? 0 : ((PIDWINDOW - ontime < PIDMINPULSE) ? PIDWINDOW : ontime);
+
+        // On at the start of a window, off once its share is used; at most two switches a window
+        if(newwindow)
+        {
+            pid->toggles[k] += (on[k] != (ontime > 0));
+            on[k] = (ontime > 0);
+        }
+        else if(on[k] && nowms - pid->wstart >= ontime)
+        {
+            pid->toggles[k]++;
+            on[k] = 0;
+        }
+        edge = pid->wstart + ontime;
+        if(on[k] && ontime < PIDWINDOW && edge < next)
+        {
+            next = edge;
+        }
+    }
+    pid->ctrl.heater = pid->loop[TEMPERATURE].out;
+    pid->ctrl.humidifier = pid->loop[HUMIDITY].out;
+    pid->ctrl.heateron = on[TEMPERATURE];
+    pid->ctrl.humidifieron = on[HUMIDITY];
+
+    if(pid->timerfd != -1)
+    {
+        next = (next > nowms) ? next - nowms : 1;
+        its.it_value.tv_sec = next / 1000;
+        its.it_value.tv_nsec = (next % 1000) * 1000000L;
+        timerfd_settime(pid->timerfd,0,&its,NULL);
+    }
+    return pid->ctrl;
+}
+
+/** @brief Handles an output timer expiry
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pid pointer to controller
+ *  @return object of controls type
+*/
+control_s GhPidTick(ghpid_s * pid)
+{
+    uint64_t expiries;
+    if(read(pid->timerfd,&expiries,sizeof(expiries)) != sizeof(expiries))
+    {
+        return pid->ctrl;
+    }
+    return GhPidOutputs(pid,GhPidClock());
+}
+
+/** @brief Reads the monotonic clock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t milliseconds
+*/
+int64_t GhPidClock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
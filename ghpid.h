@@ -0,0 +1,70 @@
+/** @brief Gh PID control constants, structures, function prototypes
+*   @file ghpid.h
+*
+*   One PID loop per actuator turns the filtered reading into a 0 to 100%
+*   duty cycle: derivative on the measurement through a first-order filter,
+*   and back-calculation anti-windup so the integral stops growing while
+*   the output is saturated. A time-proportioning stage then switches each
+*   relay on for duty% of every PIDWINDOW, so the relays move a few times
+*   a window instead of on every sample. The loop state is fixed size, so
+*   it can be copied into a checkpoint.
+*/
+#ifndef GHPID_H
+#define GHPID_H
+
+// Includes
+#include <sys/timerfd.h>
+#include "ghcontrol.h"
+
+// PID Constants
+#define PIDENABLE 1             // 0 keeps the bang-bang GhSetControls()
+#define PIDLOOPS 2              // indexed by TEMPERATURE and HUMIDITY
+#define PIDWINDOW 180000        // ms time-proportioning window
+#define PIDMINPULSE 10000       // ms, shorter on or off pulses are not switched; at least ACTMINON and ACTMINOFF
+#define PIDTKP 50.0             // % duty per C
+#define PIDTTI 600.0            // s integral time
+#define PIDTTD 30.0             // s derivative time
+#define PIDHKP 20.0             // % duty per %RH
+#define PIDHTI 1200.0
+#define PIDHTD 0.0
+#define PIDDFILTER 8.0          // derivative filter time constant is Td / PIDDFILTER
+#define PIDSTALESECS 120.0      // s a loop holds its output without a reading, then drops to 0%
+
+//Typedefs
+typedef struct pidloop
+{
+    double kp;
+    double ti;                  // s, 0 disables the integral
+    double td;                  // s, 0 disables the derivative
+    double integral;            // % duty contributed by the integral
+    double dterm;               // filtered derivative, % duty
+    double last;                // previous measurement
+    double out;                 // % duty
+    double stale;               // s without a reading
+    int primed;
+}pidloop_s;
+
+typedef struct ghpid
+{
+    int enabled;
+    int timerfd;                // -1 in simulated time
+    int64_t lastms;             // time of the last GhPidUpdate(), -1 before the first
+    int64_t wstart;             // start of the current window
+    pidloop_s loop[PIDLOOPS];
+    control_s ctrl;
+    uint64_t toggles[PIDLOOPS];
+}ghpid_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhPidInit(ghpid_s * pid, int enabled);
+int GhPidStart(ghpid_s * pid);
+void GhPidStop(ghpid_s * pid);
+double GhPidStep(pidloop_s * lp, double target, double measured, double dt);
+control_s GhPidUpdate(ghpid_s * pid, setpoint_s target, reading_s rdata, int64_t nowms);
+control_s GhPidOutputs(ghpid_s * pid, int64_t nowms);
+control_s GhPidTick(ghpid_s * pid);
+int64_t GhPidClock(void);
+///@endcond
+
+#endif
@@ -0,0 +1,388 @@
+/** @brief Gh plant simulator functions
+*   @file ghplant.c
+*/
+#include "ghplant.h"
+#include "ghbatch.h"
+#include "ghfilter.h"
+#include "ghsched.h"
+#include "ghpredict.h"
+
+/** @brief Uniform random number in (0,1)
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param seed pointer to generator state
+ *  @return double
+*/
+static double GhPlantUniform(uint64_t * seed)
+{
+    // xorshift64*
+    *seed ^= *seed >> 12;
+    *seed ^= *seed << 25;
+    *seed ^= *seed >> 27;
+    return ((*seed * 2685821657736338717ull >> 11) + 0.5) / 9007199254740992.0;
+}
+
+/** @brief Standard normal random number
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param seed pointer to generator state
+ *  @return double
+*/
+static double GhPlantGauss(uint64_t * seed)
+{
+    double u = GhPlantUniform(seed);
+    double v = GhPlantUniform(seed);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/** @brief Starts the plant at midnight
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pl pointer to plant
+ *  @param seed random seed, the same seed replays the same weather
+ *  @return void
+*/
+void GhPlantInit(plant_s * pl, uint64_t seed)
+{
+    memset(pl,0,sizeof(plant_s));
+    pl->seed = seed ? seed : 1;
+    pl->noiseseed = pl->seed ^ 0x9e3779b97f4a7c15ull;
+    pl->temperature = 20.0;
+    pl->humidity = 60.0;
+    pl->pressure = PLANTPMEAN;
+}
+
+/** @brief Advances the plant
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pl pointer to plant
+ *  @param ctrl heater and humidifier outputs
+ *  @param dt seconds
+ *  @return void
+*/
+void GhPlantStep(plant_s * pl, control_s ctrl, double dt)
+{
+    double phase = 2.0 * M_PI * fmod(pl->t,PLANTDAY) / PLANTDAY;
+    double outside = 15.0 - 10.0 * cos(phase - M_PI / 4.0);     // coldest at 03:00
+    double sun = fmax(0.0,-cos(phase));                         // noon peak
+    double tau = PLANTTAU;
+    double teq;
+    double heq;
+
+    if(pl->doorleft > 0)
+    {
+        pl->doorleft -= dt;
+        tau = PLANTDOORTAU;
+    }
+    else if(GhPlantUniform(&pl->seed) < PLANTDOORRATE * dt)
+    {
+        pl->doorleft = PLANTDOORSECS;
+    }
+
+    teq = outside + PLANTSOLAR * sun;
+    heq = 65.0 + 10.0 * cos(phase) - PLANTDRYING * sun;
+    if(pl->doorleft > 0)
+    {
+        teq = outside;
+        heq -= 20.0;
+    }
+    pl->tpassive = teq;
+    pl->hpassive = fmin(100.0,fmax(0.0,heq));
+    pl->heat += ((ctrl.heateron ? 1.0 : 0.0) - pl->heat) * dt / PLANTHEATTAU;
+    pl->humid += ((ctrl.humidifieron ? 1.0 : 0.0) - pl->humid) * dt / PLANTHUMIDTAU;
+    if(pl->doorleft <= 0)
+    {
+        teq += PLANTHEAT * pl->heat;
+    }
+    heq = fmin(100.0,fmax(0.0,heq + PLANTHUMID * pl->humid));
+
+    pl->temperature += (teq - pl->temperature) * dt / tau;
+    pl->humidity += (heq - pl->humidity) * dt / ((pl->doorleft > 0) ? PLANTDOORTAU : PLANTHTAU);
+    pl->pressure += (PLANTPMEAN - pl->pressure) * dt / PLANTPTAU + PLANTPSIGMA * sqrt(dt) * GhPlantGauss(&pl->seed);
+    pl->t += dt;
+}
+
+/** @brief Samples the plant through noisy sensors
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pl pointer to plant
+ *  @return object of readings type
+*/
+reading_s GhPlantRead(plant_s * pl)
+{
+    reading_s rd = {0};
+    rd.rtime = (time_t) pl->t;
+    rd.temperature = pl->temperature + PLANTTNOISE * GhPlantGauss(&pl->noiseseed);
+    rd.humidity = pl->humidity + PLANTHNOISE * GhPlantGauss(&pl->noiseseed);
+    rd.pressure = pl->pressure + PLANTPNOISE * GhPlantGauss(&pl->noiseseed);
+    return rd;
+}
+
+/** @brief Records the filtered readings a bang-bang controller on the plant would log
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hours simulated duration
+ *  @param spts setpoints
+ *  @param limits alarm limits, which steer the adaptive sampling period
+ *  @param n pointer to the number of readings returned
+ *  @return reading_s pointer to n readings the caller frees, NULL if out of memory
+*/
+reading_s * GhPlantStream(double hours, setpoint_s spts, alarmlimit_s limits, size_t * n)
+{
+    plant_s pl;
+    ghfilter_s flt;
+    sched_s sc;
+    control_s ctrl = {0};
+    reading_s raw;
+    reading_s * out;
+    int ms;
+    double next = 0.0;
+    double end = hours * 3600.0;
+    size_t max = (size_t)(end * 1000.0 / SCHEDMINMS) + 1;
+
+    *n = 0;
+    out = (reading_s *) malloc(max * sizeof(reading_s));
+    if(out == NULL)
+    {
+        return NULL;
+    }
+    GhPlantInit(&pl,PLANTSEED);
+    GhFilterInit(&flt);
+    GhSchedInit(&sc,1);
+    while(pl.t < end && *n < max)
+    {
+        if(pl.t >= next)
+        {
+            raw = GhPlantRead(&pl);
+            out[*n] = GhFilterApply(&flt,raw);
+            ctrl = GhSetControls(spts,out[*n]);
+            ms = GhSchedNext(&sc,raw,limits);
+            GhFilterPeriod(&flt,ms / 1000.0);
+            next += ms / 1000.0;
+            (*n)++;
+        }
+        GhPlantStep(&pl,ctrl,PLANTDT);
+    }
+    return out;
+}
+
+/** @brief Runs the controller against the plant in simulated time
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hours simulated duration
+ *  @param adaptive 1 for the adaptive scheduler, 0 for a fixed GHUPDATE period
+ *  @param pidmode 1 for PID with time-proportioned outputs, 0 for bang-bang
+ *  @param trend 1 to control on the projected reading (GhPredictControl)
+ *  @param spts setpoints
+ *  @param limits alarm limits
+ *  @return plantmetrics_s sampling, alarm detection and control results
+*/
+plantmetrics_s GhPlantRun(double hours, int adaptive, int pidmode, int trend, setpoint_s spts, alarmlimit_s limits)
+{
+    plantmetrics_s m = {0};
+    plant_s pl;
+    ghfilter_s flt;
+    sched_s sc;
+    ghpid_s pid;
+    ghpredict_s pr;
+    control_s ctrl = {0};
+    reading_s truth = {0};
+    reading_s raw;
+    reading_s rd;
+    uint16_t truemask = 0;
+    uint16_t now;
+    uint16_t seen;
+    uint16_t predicted;
+    double onset[NALARMS] = {0};
+    double latency[NALARMS];
+    double warned[NALARMS];
+    double lead[NALARMS];
+    double next = 0.0;
+    double end = hours * 3600.0;
+    double theat = 0.0;
+    double thumid = 0.0;
+    int64_t nowms;
+    int tgate;
+    int hgate;
+    int tbelow = 0;
+    int hbelow = 0;
+    int tarmed = 0;
+    int harmed = 0;
+    int code;
+    int ms;
+    struct timespec t0,t1;
+
+    GhPlantInit(&pl,PLANTSEED);
+    GhFilterInit(&flt);
+    GhSchedInit(&sc,adaptive);
+    GhPidInit(&pid,pidmode);
+    GhPredictInit(&pr);
+    for(code = HTEMP; code <= LPRESS; code++)
+    {
+        warned[code] = -1.0;
+    }
+    while(pl.t < end)
+    {
+        // Regulation while only the actuator can hold the setpoint, scored from the
+        // moment the plant climbs to it (the climb itself is plant-limited)
+        tgate = pl.doorleft <= 0 && pl.tpassive < spts.temperature && pl.tpassive + PLANTHEAT > spts.temperature;
+        hgate = pl.hpassive < spts.humidity && pl.hpassive + PLANTHUMID > spts.humidity;
+        tbelow = tgate && (tbelow || pl.temperature < spts.temperature);
+        hbelow = hgate && (hbelow || pl.humidity < spts.humidity);
+        tarmed = tbelow && (tarmed || pl.temperature >= spts.temperature);
+        harmed = hbelow && (harmed || pl.humidity >= spts.humidity);
+        if(tarmed)
+        {
+            m.trms += (pl.temperature - spts.temperature) * (pl.temperature - spts.temperature) * PLANTDT;
+            m.tover = fmax(m.tover,pl.temperature - spts.temperature);
+            theat += PLANTDT;
+        }
+        if(harmed)
+        {
+            m.hrms += (pl.humidity - spts.humidity) * (pl.humidity - spts.humidity) * PLANTDT;
+            m.hover = fmax(m.hover,pl.humidity - spts.humidity);
+            thumid += PLANTDT;
+        }
+
+        // Alarm onsets in the noise-free plant state
+        truth.temperature = pl.temperature;
+        truth.humidity = pl.humidity;
+        truth.pressure = pl.pressure;
+        now = GhAlarmMask(limits,truth);
+        for(code = HTEMP; code <= LPRESS; code++)
+        {
+            if((now & ~truemask) & ALARMBIT(code))
+            {
+                onset[code] = pl.t;
+                latency[code] = -1.0;
+                lead[code] = (warned[code] >= 0) ? pl.t - warned[code] : -1.0;
+                warned[code] = -1.0;
+            }
+            else if((truemask & ~now) & ALARMBIT(code) && pl.t - onset[code] >= PLANTMINALARM)
+            {
+                // Score the episode once it is over
+                m.onsets++;
+                if(latency[code] < 0)
+                {
+                    m.missed++;
+                }
+                else
+                {
+                    m.detected++;
+                    m.meanlatency += latency[code];
+                    m.maxlatency = fmax(m.maxlatency,latency[code]);
+                }
+                if(lead[code] >= 0)
+                {
+                    m.warned++;
+                    m.meanlead += lead[code];
+                }
+            }
+        }
+        truemask = now;
+
+        nowms = llround(pl.t * 1000.0);
+        if(pl.t >= next)
+        {
+            clock_gettime(CLOCK_MONOTONIC,&t0);
+            raw = GhPlantRead(&pl);
+            rd = GhFilterApply(&flt,raw);
+            GhPredictUpdate(&pr,rd,nowms);
+            ctrl = GhPidUpdate(&pid,spts,trend ? GhPredictControl(&pr,rd) : rd,nowms);
+            seen = GhAlarmMask(limits,rd);
+            predicted = GhPredictAlarms(&pr,limits,rd,PREDHORIZON);
+            ms = GhSchedNext(&sc,raw,limits);
+            GhFilterPeriod(&flt,ms / 1000.0);
+            clock_gettime(CLOCK_MONOTONIC,&t1);
+            m.cpums += (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+            for(code = HTEMP; code <= LPRESS; code++)
+            {
+                if((seen & truemask & ALARMBIT(code)) && latency[code] < 0)
+                {
+                    latency[code] = pl.t - onset[code];
+                }
+
+                // A warning is false if it lapses without the alarm arriving
+                if((predicted & ALARMBIT(code)) && warned[code] < 0 && !(truemask & ALARMBIT(code)))
+                {
+                    warned[code] = pl.t;
+                }
+                else if(!(predicted & ALARMBIT(code)) && warned[code] >= 0 && !(seen & ALARMBIT(code)))
+                {
+                    m.falsewarn++;
+                    warned[code] = -1.0;
+                }
+            }
+            m.samples++;
+            next += ms / 1000.0;
+        }
+        else
+        {
+            // Time-proportioned relays switch between samples
+            ctrl = GhPidOutputs(&pid,nowms);
+        }
+        m.duty[TEMPERATURE] += ctrl.heateron * PLANTDT;
+        m.duty[HUMIDITY] += ctrl.humidifieron * PLANTDT;
+        GhPlantStep(&pl,ctrl,PLANTDT);
+    }
+    m.trms = (theat > 0) ? sqrt(m.trms / theat) : 0.0;
+    m.hrms = (thumid > 0) ? sqrt(m.hrms / thumid) : 0.0;
+    m.duty[TEMPERATURE] *= 100.0 / end;
+    m.duty[HUMIDITY] *= 100.0 / end;
+    m.toggles[TEMPERATURE] = pid.toggles[TEMPERATURE];
+    m.toggles[HUMIDITY] = pid.toggles[HUMIDITY];
+    if(m.detected > 0)
+    {
+        m.meanlatency /= m.detected;
+    }
+    if(m.warned > 0)
+    {
+        m.meanlead /= m.warned;
+    }
+    m.meanperiod = (m.samples > 0) ? end / m.samples : 0.0;
+    return m;
+}
+
+/** @brief Compares fixed and adaptive sampling, then bang-bang and PID control, on the plant
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param hours simulated duration
+ *  @param spts setpoints
+ *  @param limits alarm limits
+ *  @param fp output stream
+ *  @return int 1
+*/
+int GhPlantReport(double hours, setpoint_s spts, alarmlimit_s limits, FILE * fp)
+{
+    plantmetrics_s m[2];
+    int adaptive;
+    int pidmode;
+    int look;
+    fprintf(fp,"Plant simulation, %.1lf hours\n",hours);
+    fprintf(fp,"%-9s %9s %10s %7s %9s %7s %12s %12s %9s\n","mode","samples","period(s)","alarms","detected","missed","latency(s)","max(s)","cpu(ms)");
+    for(adaptive = 0; adaptive <= 1; adaptive++)
+    {
+        m[adaptive] = GhPlantRun(hours,adaptive,PIDENABLE,PREDCONTROL,spts,limits);
+        fprintf(fp,"%-9s %9llu %10.2lf %7d %9d %7d %12.2lf %12.2lf %9.2lf\n",adaptive ? "adaptive" : "fixed",
+            (unsigned long long) m[adaptive].samples,m[adaptive].meanperiod,m[adaptive].onsets,m[adaptive].detected,
+            m[adaptive].missed,m[adaptive].meanlatency,m[adaptive].maxlatency,m[adaptive].cpums);
+    }
+    fprintf(fp,"\n%-9s %7s %9s %9s %9s %12s\n","predict","alarms","warned","lead(s)","false","latency(s)");
+    for(adaptive = 0; adaptive <= 1; adaptive++)
+    {
+        fprintf(fp,"%-9s %7d %9d %9.2lf %9d %12.2lf\n",adaptive ? "adaptive" : "fixed",m[adaptive].onsets,m[adaptive].warned,
+            m[adaptive].meanlead,m[adaptive].falsewarn,m[adaptive].meanlatency);
+    }
+    fprintf(fp,"\n%-9s %7s %7s %7s %7s %9s %9s %7s %7s\n","control","T rms","T over","H rms","H over","heat sw","humid sw","heat%","humid%");
+    for(pidmode = 0; pidmode <= 1; pidmode++)
+    {
+        for(look = 0; look <= 1; look++)
+        {
+            m[0] = GhPlantRun(hours,0,pidmode,look,spts,limits);
+            fprintf(fp,"%-9s %7.2lf %7.2lf %7.2lf %7.2lf %9llu %9llu %7.1lf %7.1lf\n",pidmode ? (look ? "pid+trend" : "pid") : (look ? "bb+trend" : "bang-bang"),
+                m[0].trms,m[0].tover,m[0].hrms,m[0].hover,(unsigned long long) m[0].toggles[TEMPERATURE],(unsigned long long) m[0].toggles[HUMIDITY],
+                m[0].duty[TEMPERATURE],m[0].duty[HUMIDITY]);
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,91 @@
+/** @brief Gh plant simulator constants, structures, function prototypes
+*   @file ghplant.h
+*
+*   A lumped model of the greenhouse: first-order temperature and humidity
+*   responses to the outside air, the sun, the heater and the humidifier
+*   (whose outputs lag their relays),
+*   random door openings, and a mean-reverting random walk for pressure.
+*   It runs in simulated time, so days of operation take seconds. Tracking
+*   error and overshoot are scored only while the setpoint is reachable and
+*   the plant would fall below it on its own, so the result is down to the
+*   controller rather than the sun or a cold night.
+*/
+#ifndef GHPLANT_H
+#define GHPLANT_H
+
+// Includes
+#include "ghcontrol.h"
+#include "ghpid.h"
+
+// Plant Simulator Constants
+#define PLANTDT 0.1             // s integration step
+#define PLANTDAY 86400.0
+#define PLANTSEED 20261018u
+#define PLANTTAU 1800.0         // s thermal time constant, door closed
+#define PLANTDOORTAU 120.0      // s thermal time constant, door open
+#define PLANTHEAT 20.0          // C the heater holds above ambient
+#define PLANTSOLAR 14.0         // C of midday solar gain
+#define PLANTHTAU 1200.0        // s humidity time constant
+#define PLANTHUMID 40.0         // % the humidifier adds at equilibrium
+#define PLANTHEATTAU 90.0       // s for the heater to warm up or cool down
+#define PLANTHUMIDTAU 60.0      // s for the humidifier output to follow its relay
+#define PLANTDRYING 30.0        // % removed by midday ventilation
+#define PLANTPMEAN 1001.0
+#define PLANTPTAU 43200.0       // s pressure reversion time
+#define PLANTPSIGMA 0.06        // mB per root second
+#define PLANTDOORRATE (1.0 / 10800.0)  // door openings per second
+#define PLANTDOORSECS 300.0
+#define PLANTTNOISE 0.1         // sensor noise (standard deviation)
+#define PLANTHNOISE 0.5
+#define PLANTPNOISE 0.1
+#define PLANTMINALARM 30.0      // s, shorter true alarm episodes are not scored
+#define PLANTSTREAMHOURS 24.0   // default length of the stream the -t reports replay
+
+//Typedefs
+typedef struct plant
+{
+    double t;                   // simulated seconds since midnight of day 0
+    double temperature;
+    double humidity;
+    double pressure;
+    double doorleft;            // seconds the door stays open
+    double heat;                // heater output, 0 to 1, lagging the relay
+    double humid;
+    double tpassive;            // equilibria with the heater and humidifier off
+    double hpassive;
+    uint64_t seed;              // weather
+    uint64_t noiseseed;         // sensor noise, separate so sampling does not change the weather
+}plant_s;
+
+typedef struct plantmetrics
+{
+    uint64_t samples;
+    double meanperiod;          // s
+    int onsets;                 // alarm episodes in the true plant state
+    int detected;
+    int missed;                 // cleared again before a sample saw them
+    double meanlatency;         // s from onset to detection
+    double maxlatency;
+    double cpums;               // time spent in the sampling pipeline
+    int warned;                 // alarm episodes predicted before their onset
+    double meanlead;            // s from the prediction to the onset
+    int falsewarn;              // predictions that lapsed without an alarm
+    double trms;                // C from the setpoint, once reached, while only the heater can hold it
+    double tover;               // C, largest excursion above the setpoint then
+    double hrms;                // %RH, likewise for the humidifier
+    double hover;
+    uint64_t toggles[PIDLOOPS]; // relay switches
+    double duty[PIDLOOPS];      // % of the time each relay was on
+}plantmetrics_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhPlantInit(plant_s * pl, uint64_t seed);
+void GhPlantStep(plant_s * pl, control_s ctrl, double dt);
+reading_s GhPlantRead(plant_s * pl);
+reading_s * GhPlantStream(double hours, setpoint_s spts, alarmlimit_s limits, size_t * n);
+plantmetrics_s GhPlantRun(double hours, int adaptive, int pidmode, int trend, setpoint_s spts, alarmlimit_s limits);
+int GhPlantReport(double hours, setpoint_s spts, alarmlimit_s limits, FILE * fp);
+///@endcond
+
+#endif
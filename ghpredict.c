@@ -0,0 +1,236 @@
+/** @brief Gh trend predictor functions
+*   @file ghpredict.c
+*/
+#include "ghpredict.h"
+#include "ghbatch.h"
+
+/** @brief Maps an alarm to its channel and limit
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param limits alarm limits
+ *  @param code alarm code
+ *  @param chan pointer filled with the channel index
+ *  @return double limit value
+*/
+static double GhPredictLimit(alarmlimit_s limits, int code, int * chan)
+{
+    switch(code)
+    {
+        case HTEMP:
+            *chan = TEMPERATURE;
+            return limits.hight;
+        case LTEMP:
+            *chan = TEMPERATURE;
+            return limits.lowt;
+        case HHUMID:
+            *chan = HUMIDITY;
+            return limits.highh;
+        case LHUMID:
+            *chan = HUMIDITY;
+            return limits.lowh;
+        case HPRESS:
+            *chan = PRESSURE;
+            return limits.highp;
+        default:
+            *chan = PRESSURE;
+            return limits.lowp;
+    }
+}
+
+/** @brief Clears every channel fit
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor
+ *  @return void
+*/
+void GhPredictInit(ghpredict_s * pr)
+{
+    memset(pr,0,sizeof(ghpredict_s));
+}
+
+/** @brief Adds a sample to each channel fit
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor
+ *  @param rdata object of readings type, stale channels are skipped
+ *  @param nowms monotonic milliseconds
+ *  @return void
+*/
+void GhPredictUpdate(ghpredict_s * pr, reading_s rdata, int64_t nowms)
+{
+    int k;
+    double y[SENSORS] = {rdata.temperature,rdata.humidity,rdata.pressure};
+    double dt;
+    double lambda;
+    double p00,p01,p11;
+    double k0,k1;
+    double e;
+    predchan_s * c;
+
+    for(k=0; k<SENSORS; k++)
+    {
+        c = &pr->chan[k];
+        if((rdata.stale & (1 << k)) || isnan(y[k]))
+        {
+            continue;
+        }
+        // After a long gap the old fit says nothing, and exp() below would underflow
+        if(c->count > 0 && (nowms - c->tlast) / 1000.0 > PREDRESEED * PREDMEMORY)
+        {
+            c->count = 0;
+        }
+        if(c->count == 0)
+        {
+            c->level = y[k];
+            c->slope = 0.0;
+            c->p[0][0] = c->p[1][1] = PREDP0;
+            c->p[0][1] = c->p[1][0] = 0.0;
+            c->tlast = nowms;
+            c->count = 1;
+            continue;
+        }
+        dt = (nowms - c->tlast) / 1000.0;
+        if(dt <= 0)
+        {
+            continue;
+        }
+
+        // Move the fit to now: level += slope * dt, P = T P T' with T = [1 dt; 0 1],
+        // then forget old samples by their age rather than their count
+        lambda = exp(-dt / PREDMEMORY);
+        c->level += c->slope * dt;
+        p00 = (c->p[0][0] + 2.0 * dt * c->p[0][1] + dt * dt * c->p[1][1]) / lambda;
+        p01 = (c->p[0][1] + dt * c->p[1][1]) / lambda;
+        p11 = c->p[1][1] / lambda;
+
+        // Least-squares update with the regressor (1, 0) at the new origin
+        k0 = p00 / (1.0 + p00);
+        k1 = p01 / (1.0 + p00);
+        e = y[k] - c->level;
+        c->level += k0 * e;
+        c->slope += k1 * e;
+        c->p[0][0] = p00 - k0 * p00;
+        c->p[0][1] = c->p[1][0] = p01 - k0 * p01;
+        c->p[1][1] = p11 - k1 * p01;
+        c->tlast = nowms;
+        c->count++;
+    }
+}
+
+/** @brief Projects the readings ahead along each channel's trend
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor
+ *  @param rdata object of readings type, used for channels without a fit yet
+ *  @param seconds projection horizon
+ *  @return object of readings type
+*/
+reading_s GhPredictAhead(const ghpredict_s * pr, reading_s rdata, double seconds)
+{
+    const predchan_s * c = pr->chan;
+    rdata.rtime += (time_t) seconds;
+    if(c[TEMPERATURE].count >= PREDMINSAMPLES)
+    {
+        rdata.temperature = c[TEMPERATURE].level + c[TEMPERATURE].slope * seconds;
+    }
+    if(c[HUMIDITY].count >= PREDMINSAMPLES)
+    {
+        rdata.humidity = c[HUMIDITY].level + c[HUMIDITY].slope * seconds;
+    }
+    if(c[PRESSURE].count >= PREDMINSAMPLES)
+    {
+        rdata.pressure = c[PRESSURE].level + c[PRESSURE].slope * seconds;
+    }
+    return rdata;
+}
+
+/** @brief Projects each controlled channel ahead by its actuator look-ahead
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor
+ *  @param rdata object of readings type
+ *  @return object of readings type for the controller
+*/
+reading_s GhPredictControl(const ghpredict_s * pr, reading_s rdata)
+{
+    reading_s cdata = rdata;
+    if(PREDCTRLT > 0)
+    {
+        cdata.temperature = GhPredictAhead(pr,rdata,PREDCTRLT).temperature;
+    }
+    if(PREDCTRLH > 0)
+    {
+        cdata.humidity = GhPredictAhead(pr,rdata,PREDCTRLH).humidity;
+    }
+    return cdata;
+}
+
+/** @brief Finds alarms the trend will reach within a horizon
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor, predicted and eta are filled
+ *  @param limits alarm limits
+ *  @param rdata object of readings type
+ *  @param seconds horizon
+ *  @return uint16_t ALARMBIT(code) for each predicted alarm not already active
+*/
+uint16_t GhPredictAlarms(ghpredict_s * pr, alarmlimit_s limits, reading_s rdata, double seconds)
+{
+    int code;
+    int k;
+    int high;
+    double limit;
+    double ahead;
+    uint16_t active = GhAlarmMask(limits,rdata);
+    const predchan_s * c;
+
+    pr->predicted = 0;
+    for(code = HTEMP; code <= LPRESS; code++)
+    {
+        limit = GhPredictLimit(limits,code,&k);
+        c = &pr->chan[k];
+        high = (code == HTEMP || code == HHUMID || code == HPRESS);
+        pr->eta[code] = 0.0;
+        if(c->count < PREDMINSAMPLES || (active & ALARMBIT(code)))
+        {
+            pr->hits[code] = 0;
+            continue;
+        }
+
+        // PREDCONFIRM projections in a row past the limit, so one noisy
+        // sample does not raise a warning
+        ahead = c->level + c->slope * seconds;
+        if(high ? (ahead >= limit) : (ahead <= limit))
+        {
+            pr->hits[code]++;
+        }
+        else
+        {
+            pr->hits[code] = 0;
+        }
+        if(pr->hits[code] >= PREDCONFIRM)
+        {
+            pr->predicted |= ALARMBIT(code);
+            pr->eta[code] = (c->slope != 0.0) ? fmin(seconds,fmax(0.0,(limit - c->level) / c->slope)) : 0.0;
+        }
+    }
+    return pr->predicted;
+}
+
+/** @brief Prints predicted alarms
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to predictor
+ *  @return void
+*/
+void GhPredictDisplay(const ghpredict_s * pr)
+{
+    int code;
+    for(code = HTEMP; code <= LPRESS; code++)
+    {
+        if(pr->predicted & ALARMBIT(code))
+        {
+            fprintf(stdout,"Predicted\t%s in %.0lf s\n",alarmnames[code],pr->eta[code]);
+        }
+    }
+}
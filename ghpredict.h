@@ -0,0 +1,58 @@
+/** @brief Gh trend predictor constants, structures, function prototypes
+*   @file ghpredict.h
+*
+*   Each channel fits a local straight line (level and slope) by recursive
+*   least squares with exponential forgetting over PREDMEMORY seconds. The
+*   fit is kept centred on the latest sample, so it stays well conditioned
+*   however long the controller runs and whatever the sampling period. The
+*   projection PREDHORIZON seconds ahead raises predicted alarms before a
+*   limit is crossed, and with PREDCONTROL the controller acts on where the
+*   temperature is heading (PREDCTRLT ahead, about the heater's lag) rather
+*   than where it is.
+*/
+#ifndef GHPREDICT_H
+#define GHPREDICT_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Predictor Constants
+#define PREDMEMORY 120.0        // s, e-folding memory of the trend fit
+#define PREDHORIZON 120.0       // s ahead for predicted alarms
+#define PREDCONTROL 1           // 1 feeds the controller the projected reading
+#define PREDCTRLT 30.0          // s ahead for the heater
+#define PREDCTRLH 0.0           // s ahead for the humidifier (door openings step humidity)
+#define PREDCONFIRM 3           // consecutive projections before an alarm is predicted
+#define PREDMINSAMPLES 5        // samples before a channel projects
+#define PREDP0 1e4              // initial covariance
+#define PREDRESEED 5.0          // PREDMEMORY spans without a sample before a channel's fit starts over
+
+//Typedefs
+typedef struct predchan
+{
+    int count;
+    int64_t tlast;              // ms of the latest sample
+    double level;               // at tlast
+    double slope;               // per second
+    double p[2][2];             // covariance of (level, slope), per unit noise variance
+}predchan_s;
+
+typedef struct ghpredict
+{
+    predchan_s chan[SENSORS];
+    int hits[NALARMS];          // consecutive projections past each limit
+    uint16_t predicted;         // ALARMBIT(code) for alarms expected within the horizon
+    double eta[NALARMS];        // s until each predicted alarm
+}ghpredict_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhPredictInit(ghpredict_s * pr);
+void GhPredictUpdate(ghpredict_s * pr, reading_s rdata, int64_t nowms);
+reading_s GhPredictAhead(const ghpredict_s * pr, reading_s rdata, double seconds);
+reading_s GhPredictControl(const ghpredict_s * pr, reading_s rdata);
+uint16_t GhPredictAlarms(ghpredict_s * pr, alarmlimit_s limits, reading_s rdata, double seconds);
+void GhPredictDisplay(const ghpredict_s * pr);
+///@endcond
+
+#endif
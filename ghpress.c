@@ -0,0 +1,253 @@
+/** @brief Gh pressure batch functions
+*   @file ghpress.c
+*/
+#include "ghpress.h"
+
+/** @brief Clears the baseline and counters
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to pressure batch state
+ *  @return void
+*/
+void GhPressInit(ghpress_s * pr)
+{
+    memset(pr,0,sizeof(ghpress_s));
+}
+
+/** @brief Checks a batch of samples for pressure events
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to pressure batch state
+ *  @param fifo pointer to the batch, oldest sample first
+ *  @param rtime time of the reading, taken as that of the newest sample
+ *  @return int 1 if an event started in this batch
+*/
+int GhPressBatch(ghpress_s * pr, const lps25hFifo_s * fifo, time_t rtime)
+{
+    int i;
+    int k;
+    int started = 0;
+    double p;
+    double d;
+    double m;
+    double alpha = (fifo->hz > 0) ? 1.0 - exp(-1.0 / (fifo->hz * PRESSBASELINE)) : 0.0;
+
+    pr->count = fifo->count;
+    pr->overrun = fifo->overrun;
+    pr->hz = fifo->hz;
+    pr->low = INFINITY;
+    pr->high = -INFINITY;
+    if(fifo->count == 0)
+    {
+        return 0;
+    }
+    pr->batches++;
+    pr->overruns += fifo->overrun;
+    for(i=0; i<fifo->count; i++)
+    {
+        p = fifo->sample[i].pressure;
+        pr->low = fmin(pr->low,p);
+        pr->high = fmax(pr->high,p);
+        if(!pr->primed)
+        {
+            pr->baseline = p;
+            pr->primed = 1;
+            continue;
+        }
+        d = p - pr->baseline;
+        pr->window[pr->head] = d;
+        pr->head = (pr->head + 1) % PRESSWINDOW;
+        pr->filled += (pr->filled < PRESSWINDOW);
+        for(k=0,m=0.0; k<pr->filled; k++)
+        {
+            m += pr->window[k];
+        }
+        m /= pr->filled;
+        if(pr->active && fabs(m) > fabs(pr->step))
+        {
+            pr->step = m;
+        }
+        if(pr->filled == PRESSWINDOW && (pr->active ? (fabs(m) < PRESSCLEAR) : (fabs(m) >= PRESSEVENT)))
+        {
+            pr->active = !pr->active;
+            if(pr->active)
+            {
+                pr->events++;
+                pr->step = m;
+                pr->lastevent = rtime - ((fifo->hz > 0) ? (time_t)((fifo->count - i + PRESSWINDOW - 2) / fifo->hz) : 0);
+                started = 1;
+            }
+            else
+            {
+                // Whatever is left of a held step is the new level, not
+                // the start of another event once noise adds to it
+                for(k=0; k<PRESSWINDOW; k++)
+                {
+                    pr->window[k] -= m;
+                }
+                pr->baseline += m;
+                d -= m;
+            }
+        }
+        pr->baseline += alpha * d;
+    }
+    pr->samples += fifo->count;
+    return started;
+}
+
+/** @brief Prints the latest batch and the pressure events
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to pressure batch state
+ *  @return void
+*/
+void GhPressDisplay(const ghpress_s * pr)
+{
+    char ltime[CTIMESTRSZ];
+    if(pr->count == 0)
+    {
+        return;
+    }
+    fprintf(stdout,"Pressure\tFIFO: %d @ %.1lfHz\tRange: %.2lfmB\tEvents: %llu",pr->count,pr->hz,
+        pr->high - pr->low,(unsigned long long) pr->events);
+    if(pr->events > 0)
+    {
+        strcpy(ltime,ctime(&pr->lastevent));
+        fprintf(stdout," (%+.2lfmB at %.8s%s)",pr->step,ltime + 11,pr->active ? ", now" : "");
+    }
+    fprintf(stdout,"%s\n",pr->overrun ? "\t(overrun)" : "");
+}
+
+/** @brief Prints one report check
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @param what description of the check
+ *  @param ok 1 if it passed
+ *  @return int 1 for a failure, to be counted
+*/
+static int GhPressCheck(FILE * fp, const char * what, int ok)
+{
+    fprintf(fp,"%-60s %s\n",what,ok ? "ok" : "FAILED");
+    return !ok;
+}
+
+/** @brief Lets the simulated FIFO fill for one read period and checks the batch
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param pr pointer to pressure batch state
+ *  @param fifo pointer to the batch to drain into
+ *  @param rtime pointer to the simulated time of the reading, advanced
+ *  @return int 1 if an event started in this batch
+*/
+static int GhPressRead(ghpress_s * pr, lps25hFifo_s * fifo, time_t * rtime)
+{
+    ShSimBusAdvance((uint64_t) PRESSCHECKMS * 1000);
+    *rtime += PRESSCHECKMS / 1000;
+    ShGetLPS25HFifo(fifo);
+    return GhPressBatch(pr,fifo,*rtime);
+}
+
+/** @brief Drives event detection from the simulated LPS25H FIFO through steady, drifting and stepped pressure
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if every event was found once at its time and nothing else was, 0 otherwise
+*/
+int GhPressReport(FILE * fp)
+{
+    int i;
+    int bad = 0;
+    int started = 0;
+    int secs;
+    double level = 0.0;
+    double spike = PRESSEVENT * (PRESSWINDOW - 1);
+    char what[64];
+    time_t rtime = time(NULL);
+    uint64_t events;
+    ghpress_s pr;
+    lps25hFifo_s fifo;
+
+    ShSelect(&shsimsensors,&shnodisplay);
+    ShSimBusFaults(0,0);
+    ShSimBusPressure(0.0);
+    if(ShSensorInit() == EXIT_FAILURE)
+    {
+        fprintf(fp,"Cannot open the simulated sensors\n");
+        return 0;
+    }
+    ShLPS25HFifoPeriod(PRESSCHECKMS);
+    ShGetLPS25HFifo(&fifo);
+    GhPressInit(&pr);
+    fprintf(fp,"Pressure events: %.2lf mB to start, %.2lf mB to end, %d-sample mean, %.0lf s baseline\n",
+        PRESSEVENT,PRESSCLEAR,PRESSWINDOW,PRESSBASELINE);
+
+    // Nothing but sensor noise, then weather
+    for(i=0; i<PRESSCHECKQUIET; i++)
+    {
+        started += GhPressRead(&pr,&fifo,&rtime);
+    }
+    snprintf(what,sizeof(what),"steady, %llu samples at %.1lf Hz, no event",(unsigned long long) pr.samples,fifo.hz);
+    bad += GhPressCheck(fp,what,started == 0 && pr.events == 0 && fifo.hz > 0 && !fifo.overrun);
+    for(i=0; i<3600000 / PRESSCHECKMS; i++)
+    {
+        level += PRESSCHECKDRIFT * PRESSCHECKMS / 3600000.0;
+        ShSimBusPressure(level);
+        started += GhPressRead(&pr,&fifo,&rtime);
+    }
+    snprintf(what,sizeof(what),"drift of %.1lf mB in an hour, no event",PRESSCHECKDRIFT);
+    bad += GhPressCheck(fp,what,started == 0 && pr.events == 0);
+
+    // A door opens and stays open: one event, dated to its read, until the baseline takes it in
+    ShSimBusPressure(level + PRESSCHECKSTEP);
+    started = GhPressRead(&pr,&fifo,&rtime);
+    snprintf(what,sizeof(what),"%.1lf mB step starts an event in its read (%+.2lf mB)",PRESSCHECKSTEP,pr.step);
+    bad += GhPressCheck(fp,what,started && pr.events == 1 && pr.active && fabs(pr.step - PRESSCHECKSTEP) <= PRESSCHECKTOL
+        && pr.lastevent <= rtime && pr.lastevent >= rtime - PRESSCHECKMS / 1000);
+    for(secs=0; pr.active && secs<3*PRESSBASELINE; secs+=PRESSCHECKMS / 1000)
+    {
+        started += GhPressRead(&pr,&fifo,&rtime);
+    }
+    snprintf(what,sizeof(what),"held step ends after %d s as the baseline takes it in",secs);
+    bad += GhPressCheck(fp,what,!pr.active && started == 1 && pr.events == 1);
+
+    // A vent fan pulse one read long, then single noisy samples
+    level += PRESSCHECKSTEP;
+    for(i=0; i<PRESSCHECKQUIET; i++)
+    {
+        started += GhPressRead(&pr,&fifo,&rtime);
+    }
+    ShSimBusPressure(level - PRESSCHECKSTEP);
+    started += GhPressRead(&pr,&fifo,&rtime);
+    ShSimBusPressure(level);
+    started += GhPressRead(&pr,&fifo,&rtime);
+    snprintf(what,sizeof(what),"%d ms pulse is one event, ended on the next read (%+.2lf mB)",PRESSCHECKMS,pr.step);
+    bad += GhPressCheck(fp,what,started == 2 && pr.events == 2 && !pr.active && fabs(pr.step + PRESSCHECKSTEP) <= PRESSCHECKTOL);
+    for(i=0; i<PRESSWINDOW; i++)
+    {
+        started += GhPressRead(&pr,&fifo,&rtime);
+    }
+    for(i=PRESSWINDOW; i<fifo.count; i+=PRESSWINDOW)
+    {
+        fifo.sample[i].pressure += (i & 1) ? -spike : spike;
+    }
+    rtime += PRESSCHECKMS / 1000;
+    started += GhPressBatch(&pr,&fifo,rtime);
+    snprintf(what,sizeof(what),"lone samples %.2lf mB off are no event",spike);
+    bad += GhPressCheck(fp,what,started == 2 && pr.events == 2 && !pr.active);
+
+    // Missed reads: the full FIFO is counted as an overrun and still checked
+    events = pr.events;
+    ShSimBusAdvance((uint64_t) 10 * PRESSCHECKMS * 1000);
+    rtime += 10 * PRESSCHECKMS / 1000;
+    ShGetLPS25HFifo(&fifo);
+    started += GhPressBatch(&pr,&fifo,rtime);
+    snprintf(what,sizeof(what),"missed reads, %d samples checked as an overrun",pr.count);
+    bad += GhPressCheck(fp,what,pr.overruns == 1 && pr.count == LPS25HFIFOSIZE && pr.events == events && started == 2);
+
+    ShSimBusPressure(0.0);
+    ShSimBusFaults(SIMBUSERRPCT,SIMBUSHANGPCT);
+    ShExit();
+    fprintf(fp,"Failures: %d\n",bad);
+    return bad == 0;
+}
@@ -0,0 +1,60 @@
+/** @brief Gh pressure batch constants, structures, function prototypes
+*   @file ghpress.h
+*
+*   Each reading brings the batch of LPS25H FIFO samples behind it. The
+*   batch is checked against a slow baseline, sample by sample, for the
+*   short pressure steps a vent fan or an open door makes. An event starts
+*   when the mean departure of the last PRESSWINDOW samples reaches
+*   PRESSEVENT and ends when it falls inside PRESSCLEAR. The baseline
+*   forgets with time constant PRESSBASELINE, so weather drift is never an
+*   event, and moves to the window mean when an event ends, so a step that
+*   stays is counted once.
+*/
+#ifndef GHPRESS_H
+#define GHPRESS_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Pressure Batch Constants
+#define PRESSEVENT 0.2          // mB from the baseline that starts an event
+#define PRESSCLEAR 0.1          // mB from the baseline that ends it
+#define PRESSWINDOW 3           // samples averaged, so one noisy sample neither starts nor ends an event
+#define PRESSBASELINE 60.0      // s, baseline time constant
+#define PRESSCHECKMS 2000       // read period GhPressReport() drives the simulated FIFO at
+#define PRESSCHECKSTEP 0.5      // mB, a door opening
+#define PRESSCHECKDRIFT 2.0     // mB per hour, a fast weather front
+#define PRESSCHECKQUIET 60      // reads of each steady stretch
+#define PRESSCHECKTOL 0.15      // mB allowed in an event's step for the simulated noise and the baseline's lag behind drift
+
+//Typedefs
+typedef struct ghpress
+{
+    double baseline;            // mB
+    int primed;
+    double window[PRESSWINDOW]; // latest departures from the baseline, mB
+    int filled;
+    int head;
+    int active;                 // 1 during an event
+    double step;                // largest departure of the current or last event, mB
+    time_t lastevent;           // start of the current or last event
+    uint64_t samples;
+    uint64_t batches;
+    uint64_t overruns;          // batches drained from a full FIFO
+    uint64_t events;
+    int count;                  // latest batch
+    int overrun;
+    double hz;
+    double low;
+    double high;
+}ghpress_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhPressInit(ghpress_s * pr);
+int GhPressBatch(ghpress_s * pr, const lps25hFifo_s * fifo, time_t rtime);
+void GhPressDisplay(const ghpress_s * pr);
+int GhPressReport(FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,454 @@
+/** @brief ghc-query: range aggregates over GhLogData() logs
+*   @file ghquery.c
+*
+*   Usage: ghc-query [-i hour|day|month|year|all] [-s start] [-e end] [file]
+*
+*   The log is mapped read-only and split at line boundaries into one slice
+*   per core. Each thread parses its slice with the fixed-layout parser in
+*   ghlog.c and keeps min/max/mean/count per interval; the per-thread results
+*   are merged and printed as CSV. Scan throughput goes to stderr. A "nan"
+*   value from a failed sensor is left out of that column's aggregates, and
+*   a column with no values in an interval prints nan.
+*
+*   Bounds are inclusive; a date-only -e takes in the whole of that day.
+*   A slice whose thread cannot be started is scanned on the main thread,
+*   and a slice that runs out of memory fails the query rather than
+*   leaving a hole in the aggregates.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ghlog.h"
+
+// Query Constants
+#define QDEFAULTLOG "ghdata.txt"
+#define QMAXTHREADS 64
+#define QINITBUCKETS 64
+
+//Enumerated Types
+typedef enum { QHOUR, QDAY, QMONTH, QYEAR, QALL } qinterval_e;
+
+//Typedefs
+typedef struct qbucket
+{
+    int64_t key;
+    uint64_t count;
+    uint64_t n[LOGVALUES];      // values in count that are not nan
+    double min[LOGVALUES];
+    double max[LOGVALUES];
+    double sum[LOGVALUES];
+}qbucket_s;
+
+typedef struct qworker
+{
+    pthread_t tid;
+    const char * begin;
+    const char * end;
+    qinterval_e interval;
+    int64_t start;
+    int64_t stop;
+    qbucket_s * buckets;
+    size_t nbuckets;
+    size_t cap;
+    uint64_t lines;
+    int running;                // 1 while scanned on its own thread
+    int failed;                 // 1 if the slice could not be scanned in full
+}qworker_s;
+
+/** @brief Computes the interval key of a log time
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param lt pointer to parsed log time
+ *  @param interval interval type
+ *  @return int64_t interval key
+*/
+static inline int64_t GhQueryKey(const logtime_s * lt, qinterval_e interval)
+{
+    switch(interval)
+    {
+        case QHOUR:
+            return GhLogDays(lt->year,lt->month,lt->day) * 24 + lt->hour;
+        case QDAY:
+            return GhLogDays(lt->year,lt->month,lt->day);
+        case QMONTH:
+            return (int64_t) lt->year * 12 + lt->month - 1;
+        case QYEAR:
+            return lt->year;
+        default:
+            return 0;
+    }
+}
+
+/** @brief Adds one sample to a worker's current bucket
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param w pointer to worker
+ *  @param key interval key of the sample
+ *  @param v array of LOGVALUES values
+ *  @return int 1 on success, 0 if memory runs out
+*/
+static int GhQueryAdd(qworker_s * w, int64_t key, const double * v)
+{
+    int i;
+    qbucket_s * b;
+    // Logs are chronological, so a new key almost always means a new bucket
+    if(w->nbuckets == 0 || w->buckets[w->nbuckets-1].key != key)
+    {
+        if(w->nbuckets == w->cap)
+        {
+            w->cap = (w->cap == 0) ? QINITBUCKETS : w->cap * 2;
+            b = realloc(w->buckets,w->cap * sizeof(qbucket_s));
+            if(b == NULL)
+            {
+                return 0;
+            }
+            w->buckets = b;
+        }
+        b = &w->buckets[w->nbuckets++];
+        b->key = key;
+        b->count = 0;
+        for(i=0; i<LOGVALUES; i++)
+        {
+            b->n[i] = 0;
+            b->min[i] = INFINITY;
+            b->max[i] = -INFINITY;
+            b->sum[i] = 0.0;
+        }
+    }
+    b = &w->buckets[w->nbuckets-1];
+    b->count++;
+    for(i=0; i<LOGVALUES; i++)
+    {
+        if(isnan(v[i]))
+        {
+            continue;
+        }
+        b->n[i]++;
+        b->min[i] = (v[i] < b->min[i]) ? v[i] : b->min[i];
+        b->max[i] = (v[i] > b->max[i]) ? v[i] : b->max[i];
+        b->sum[i] += v[i];
+    }
+    return 1;
+}
+
+/** @brief Scans one slice of the log
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to worker
+ *  @return void * NULL
+*/
+static void * GhQueryWorker(void * arg)
+{
+    qworker_s * w = arg;
+    const char * p = w->begin;
+    const char * le;
+    logtime_s lt;
+    double v[LOGVALUES];
+    int64_t t;
+
+    while(p < w->end)
+    {
+        le = memchr(p,'\n',w->end - p);
+        if(le == NULL)
+        {
+            le = w->end;
+        }
+        if(GhLogParseLine(p,le,&lt,v))
+        {
+            w->lines++;
+            t = (int64_t) GhLogSeconds(&lt);
+            if(t >= w->start && t <= w->stop)
+            {
+                if(!GhQueryAdd(w,GhQueryKey(&lt,w->interval),v))
+                {
+                    w->failed = 1;
+                    break;
+                }
+            }
+        }
+        p = le + 1;
+    }
+    return NULL;
+}
+
+/** @brief Orders buckets by key for qsort
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param a pointer to bucket
+ *  @param b pointer to bucket
+ *  @return int comparison result
+*/
+static int GhQueryCompare(const void * a, const void * b)
+{
+    int64_t ka = ((const qbucket_s *) a)->key;
+    int64_t kb = ((const qbucket_s *) b)->key;
+    return (ka > kb) - (ka < kb);
+}
+
+/** @brief Parses a YYYY-MM-DD[ HH:MM:SS] bound
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param s bound string
+ *  @param t pointer to seconds, counting the wall clock as UTC
+ *  @param end 1 for an end bound, where a date alone means the last second of that day
+ *  @return int 1 on success, 0 on error
+*/
+static int GhQueryBound(const char * s, int64_t * t, int end)
+{
+    logtime_s lt = {0};
+    int n = sscanf(s,"%d-%d-%d%*[ T]%d:%d:%d",&lt.year,&lt.month,&lt.day,&lt.hour,&lt.minute,&lt.second);
+    if(n < 3 || lt.month < 1 || lt.month > 12)
+    {
+        return 0;
+    }
+    *t = (int64_t) GhLogSeconds(&lt);
+    if(end && n == 3)
+    {
+        *t += 86399;
+    }
+    return 1;
+}
+
+/** @brief Prints an interval label for a bucket key
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param key interval key
+ *  @param interval interval type
+ *  @return void
+*/
+static void GhQueryLabel(int64_t key, qinterval_e interval)
+{
+    int y,m,d;
+    switch(interval)
+    {
+        case QHOUR:
+            GhLogCivil(key / 24,&y,&m,&d);
+            fprintf(stdout,"%04d-%02d-%02d %02d:00",y,m,d,(int)(key % 24));
+            break;
+        case QDAY:
+            GhLogCivil(key,&y,&m,&d);
+            fprintf(stdout,"%04d-%02d-%02d",y,m,d);
+            break;
+        case QMONTH:
+            fprintf(stdout,"%04d-%02d",(int)(key / 12),(int)(key % 12) + 1);
+            break;
+        case QYEAR:
+            fprintf(stdout,"%04d",(int) key);
+            break;
+        default:
+            fprintf(stdout,"all");
+            break;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int opt;
+    int fd;
+    int i;
+    int nthreads;
+    long ncpu;
+    size_t k;
+    size_t total = 0;
+    size_t out = 0;
+    uint64_t lines = 0;
+    int failed = 0;
+    double secs;
+    char * base;
+    const char * cut;
+    const char * fname = QDEFAULTLOG;
+    struct stat sb;
+    struct timespec t0,t1;
+    qinterval_e interval = QMONTH;
+    int64_t start = INT64_MIN;
+    int64_t stop = INT64_MAX;
+    qworker_s workers[QMAXTHREADS];
+    qbucket_s * all;
+    qbucket_s * b;
+
+    while((opt = getopt(argc,argv,"i:s:e:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'i':
+                if(!strcmp(optarg,"hour")) interval = QHOUR;
+                else if(!strcmp(optarg,"day")) interval = QDAY;
+                else if(!strcmp(optarg,"month")) interval = QMONTH;
+                else if(!strcmp(optarg,"year")) interval = QYEAR;
+                else if(!strcmp(optarg,"all")) interval = QALL;
+                else
+                {
+                    fprintf(stderr,"ghc-query: unknown interval %s\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+            case 'e':
+                if(!GhQueryBound(optarg,(opt == 's') ? &start : &stop,opt == 'e'))
+                {
+                    fprintf(stderr,"ghc-query: bad date %s (use YYYY-MM-DD[ HH:MM:SS])\n",optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                fprintf(stderr,"Usage: %s [-i hour|day|month|year|all] [-s start] [-e end] [file]\n",argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(optind < argc)
+    {
+        fname = argv[optind];
+    }
+
+    fd = open(fname,O_RDONLY);
+    if(fd == -1 || fstat(fd,&sb) == -1)
+    {
+        perror(fname);
+        return EXIT_FAILURE;
+    }
+    if(sb.st_size == 0)
+    {
+        close(fd);
+        return EXIT_SUCCESS;
+    }
+    base = mmap(NULL,sb.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if(base == MAP_FAILED)
+    {
+        perror("Error mmapping the log");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    madvise(base,sb.st_size,MADV_SEQUENTIAL | MADV_WILLNEED);
+
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (ncpu < 1) ? 1 : ((ncpu > QMAXTHREADS) ? QMAXTHREADS : (int) ncpu);
+    if((size_t) nthreads > (size_t) sb.st_size / 4096 + 1)
+    {
+        nthreads = (int)((size_t) sb.st_size / 4096) + 1;
+    }
+
+    // Split at line boundaries and scan every slice in parallel
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    memset(workers,0,sizeof(workers));
+    cut = base;
+    for(i=0; i<nthreads; i++)
+    {
+        workers[i].begin = cut;
+        if(i == nthreads - 1)
+        {
+            cut = base + sb.st_size;
+        }
+        else
+        {
+            cut = base + ((size_t) sb.st_size / nthreads) * (i + 1);
+            cut = (cut < workers[i].begin) ? workers[i].begin : cut;
+            cut = GhLogNextLine(cut,base + sb.st_size);
+        }
+        workers[i].end = cut;
+        workers[i].interval = interval;
+        workers[i].start = start;
+        workers[i].stop = stop;
+        workers[i].running = (pthread_create(&workers[i].tid,NULL,GhQueryWorker,&workers[i]) == 0);
+        if(!workers[i].running)
+        {
+            // No thread for this slice; scan it here rather than skip it
+            GhQueryWorker(&workers[i]);
+        }
+    }
+    for(i=0; i<nthreads; i++)
+    {
+        if(workers[i].running)
+        {
+            pthread_join(workers[i].tid,NULL);
+        }
+        total += workers[i].nbuckets;
+        lines += workers[i].lines;
+        failed |= workers[i].failed;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    if(failed)
+    {
+        fprintf(stderr,"ghc-query: out of memory scanning %s\n",fname);
+        for(i=0; i<nthreads; i++)
+        {
+            free(workers[i].buckets);
+        }
+        munmap(base,sb.st_size);
+        close(fd);
+        return EXIT_FAILURE;
+    }
+
+    // Merge per-thread buckets
+    all = malloc((total ? total : 1) * sizeof(qbucket_s));
+    if(all == NULL)
+    {
+        fprintf(stderr,"ghc-query: cannot allocate memory\n");
+        return EXIT_FAILURE;
+    }
+    for(i=0; i<nthreads; i++)
+    {
+        if(workers[i].nbuckets > 0)
+        {
+            memcpy(all + out,workers[i].buckets,workers[i].nbuckets * sizeof(qbucket_s));
+            out += workers[i].nbuckets;
+        }
+        free(workers[i].buckets);
+    }
+    qsort(all,total,sizeof(qbucket_s),GhQueryCompare);
+    out = 0;
+    for(k=0; k<total; k++)
+    {
+        b = &all[out];
+        if(k > 0 && all[k].key == b->key)
+        {
+            b->count += all[k].count;
+            for(i=0; i<LOGVALUES; i++)
+            {
+                b->n[i] += all[k].n[i];
+                b->min[i] = (all[k].min[i] < b->min[i]) ? all[k].min[i] : b->min[i];
+                b->max[i] = (all[k].max[i] > b->max[i]) ? all[k].max[i] : b->max[i];
+                b->sum[i] += all[k].sum[i];
+            }
+        }
+        else
+        {
+            out = (k > 0) ? out + 1 : 0;
+            all[out] = all[k];
+        }
+    }
+    out = total ? out + 1 : 0;
+
+    fprintf(stdout,"interval,count,tmin,tmax,tmean,hmin,hmax,hmean,pmin,pmax,pmean\n");
+    for(k=0; k<out; k++)
+    {
+        b = &all[k];
+        GhQueryLabel(b->key,interval);
+        fprintf(stdout,",%llu",(unsigned long long) b->count);
+        for(i=0; i<LOGVALUES; i++)
+        {
+            if(b->n[i] == 0)
+            {
+                fprintf(stdout,",nan,nan,nan");
+                continue;
+            }
+            fprintf(stdout,",%.1lf,%.1lf,%.2lf",b->min[i],b->max[i],b->sum[i] / b->n[i]);
+        }
+        fprintf(stdout,"\n");
+    }
+
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr,"ghc-query: %llu lines, %lld bytes, %d threads, %.3f s (%.1f MB/s)\n",
+        (unsigned long long) lines,(long long) sb.st_size,nthreads,secs,
+        (secs > 0.0) ? sb.st_size / secs / 1e6 : 0.0);
+
+    free(all);
+    munmap(base,sb.st_size);
+    close(fd);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,481 @@
+/** @brief ghc-recal: re-applies calibration to the raw channel of GhLogData() logs
+*   @file ghrecal.c
+*
+*   Usage: ghc-recal [-b basefile] [-c calfile] [-o outfile] [file]
+*
+*   The log was written with the registry in -b (LOGCALFILE by default);
+*   to fix a bad calibration, copy it, correct the gain and offset, and
+*   pass the copy with -c. The logged values went through the filter and
+*   the counts did not, so a value is not rebuilt from its counts: it moves
+*   by the change the new calibration makes to those counts,
+*   value + (new gain - old gain) * counts + (new offset - old offset).
+*   A calibration that did not change, lines without raw counts, ids
+*   missing from either registry and "nan" values are copied unchanged,
+*   so an unchanged registry gives back the log byte for byte. The log is
+*   mapped and split into one slice per core; each thread parses into
+*   packed arrays and runs the kernel over runs of equal calibration id.
+*   Throughput goes to stderr.
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ghlog.h"
+
+// Recalibration Constants
+#define RDEFAULTLOG "ghdata.txt"
+#define RMAXTHREADS 64
+#define RMAXCAL 256
+#define RVALUESZ 24             // room for one formatted value
+
+//Typedefs
+typedef struct rbatch
+{
+    size_t n;
+    const char * line[LOGBATCHSZ];
+    const char * lineend[LOGBATCHSZ];
+    uint32_t calid[LOGBATCHSZ];
+    uint8_t keep[LOGBATCHSZ];   // 1 to copy the line as logged
+    int32_t count[LOGVALUES][LOGBATCHSZ];
+    double value[LOGVALUES][LOGBATCHSZ];
+}rbatch_s;
+
+typedef struct rworker
+{
+    pthread_t tid;
+    const char * begin;
+    const char * end;
+    const logcal_s * cal;
+    int ncal;
+    const logcal_s * base;
+    int nbase;
+    char * out;
+    size_t outlen;
+    size_t outcap;
+    uint64_t lines;
+    uint64_t recal;
+    uint64_t same;
+    uint64_t unknown;
+    int failed;
+    double kernelsecs;
+    rbatch_s * batch;
+}rworker_s;
+
+/** @brief Moves logged values by a change of calibration
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param count packed counts
+ *  @param value logged values, updated in place
+ *  @param n number of samples
+ *  @param gain new gain less the old, units per count
+ *  @param offset new offset less the old
+ *  @return void
+*/
+static void GhRecalKernel(const int32_t * restrict count, double * restrict value, size_t n, double gain, double offset)
+{
+    size_t i;
+    // Straight-line loop the compiler vectorizes (int to double convert and multiply-add)
+    for(i=0; i<n; i++)
+    {
+        value[i] += gain * (double) count[i] + offset;
+    }
+}
+
+/** @brief Makes room in a worker's output buffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param w pointer to worker
+ *  @param need bytes about to be appended
+ *  @return int 1 on success, 0 if out of memory
+*/
+static int GhRecalReserve(rworker_s * w, size_t need)
+{
+    size_t cap;
+    char * p;
+    if(w->outlen + need <= w->outcap)
+    {
+        return 1;
+    }
+    cap = (w->outcap ? w->outcap : 65536);
+    while(cap < w->outlen + need)
+    {
+        cap *= 2;
+    }
+    p = realloc(w->out,cap);
+    if(p == NULL)
+    {
+        return 0;
+    }
+    w->out = p;
+    w->outcap = cap;
+    return 1;
+}
+
+/** @brief Formats a value like printf("%*.1lf") without the printf cost
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param p output position
+ *  @param v value
+ *  @param width minimum field width
+ *  @return char * position after the field
+*/
+static char * GhRecalFormat(char * p, double v, int width)
+{
+    char tmp[RVALUESZ];
+    int n = 0;
+    int neg;
+    long long t;
+
+    // Huge values and near-ties go to printf so the rounding matches GhLogData()
+    if(!isfinite(v) || fabs(v) > 1e15)
+    {
+        return p + sprintf(p,"%*.1lf",width,v);
+    }
+    t = llround(v * 10.0);
+    if(fabs(fabs(v * 10.0 - (double) t) - 0.5) < 1e-6)
+    {
+        return p + sprintf(p,"%*.1lf",width,v);
+    }
+    neg = (t < 0);
+    t = neg ? -t : t;
+    tmp[n++] = '0' + (char)(t % 10);
+    tmp[n++] = '.';
+    t /= 10;
+    do
+    {
+        tmp[n++] = '0' + (char)(t % 10);
+        t /= 10;
+    }
+    while(t > 0);
+    if(neg)
+    {
+        tmp[n++] = '-';
+    }
+    while(n < width)
+    {
+        tmp[n++] = ' ';
+    }
+    while(n > 0)
+    {
+        *p++ = tmp[--n];
+    }
+    return p;
+}
+
+/** @brief Converts and writes out one parsed batch
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param w pointer to worker
+ *  @return int 1 on success, 0 if out of memory
+*/
+static int GhRecalFlush(rworker_s * w)
+{
+    rbatch_s * b = w->batch;
+    const logcal_s * c;
+    const logcal_s * o;
+    const char * tail;
+    const char * tailend;
+    size_t i;
+    size_t j;
+    int k;
+    char * p;
+    struct timespec t0,t1;
+
+    // Runs of equal calibration id share one kernel call per channel
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    for(i=0; i<b->n; i=j)
+    {
+        for(j=i+1; j<b->n && b->calid[j] == b->calid[i]; j++)
+        {
+        }
+        c = GhLogFindCal(w->cal,w->ncal,b->calid[i]);
+        o = GhLogFindCal(w->base,w->nbase,b->calid[i]);
+        if(c == NULL || o == NULL || (memcmp(c->gain,o->gain,sizeof(c->gain)) == 0 && memcmp(c->offset,o->offset,sizeof(c->offset)) == 0))
+        {
+            // Unknown or unchanged: the run is copied as logged
+            memset(&b->keep[i],(c == NULL || o == NULL) ? 2 : 1,j - i);
+            continue;
+        }
+        memset(&b->keep[i],0,j - i);
+        for(k=0; k<LOGVALUES; k++)
+        {
+            GhRecalKernel(&b->count[k][i],&b->value[k][i],j - i,c->gain[k] - o->gain[k],c->offset[k] - o->offset[k]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    w->kernelsecs += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    for(i=0; i<b->n; i++)
+    {
+        if(!GhRecalReserve(w,(b->lineend[i] - b->line[i]) + 3 * RVALUESZ + 2))
+        {
+            return 0;
+        }
+        p = w->out + w->outlen;
+        if(b->keep[i])
+        {
+            memcpy(p,b->line[i],b->lineend[i] - b->line[i]);
+            p += b->lineend[i] - b->line[i];
+            w->unknown += (b->keep[i] == 2);
+            w->same += (b->keep[i] == 1);
+        }
+        else
+        {
+            // Same layout as GhLogData(): date, %5.1lf, %5.1lf, %6.1lf, then the raw channel as it was,
+            // without derived columns computed from the old values
+            memcpy(p,b->line[i],LOGDATESZ + 1);
+            p += LOGDATESZ + 1;
+            p = GhRecalFormat(p,b->value[0][i],5);
+            *p++ = ',';
+            p = GhRecalFormat(p,b->value[1][i],5);
+            *p++ = ',';
+            p = GhRecalFormat(p,b->value[2][i],6);
+            tail = memchr(b->line[i] + LOGDATESZ + 1,'r',b->lineend[i] - b->line[i] - LOGDATESZ - 1);
+            tailend = memmem(tail,b->lineend[i] - tail,",d,",3);
+            tailend = (tailend == NULL) ? b->lineend[i] : tailend;
+            *p++ = ',';
+            memcpy(p,tail,tailend - tail);
+            p += tailend - tail;
+            w->recal++;
+        }
+        *p++ = '\n';
+        w->outlen = p - w->out;
+    }
+    b->n = 0;
+    return 1;
+}
+
+/** @brief Recalibrates one slice of the log
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to worker
+ *  @return void * NULL
+*/
+static void * GhRecalWorker(void * arg)
+{
+    rworker_s * w = arg;
+    rbatch_s * b = w->batch;
+    const char * p = w->begin;
+    const char * le;
+    lograw_s raw;
+    int k;
+
+    while(p < w->end)
+    {
+        le = memchr(p,'\n',w->end - p);
+        if(le == NULL)
+        {
+            le = w->end;
+        }
+        w->lines += (le > p);
+        if(le - p > LOGDATESZ && GhLogParseRaw(p,le,&raw))
+        {
+            b->line[b->n] = p;
+            b->lineend[b->n] = le;
+            b->calid[b->n] = raw.calid;
+            for(k=0; k<LOGVALUES; k++)
+            {
+                b->count[k][b->n] = raw.count[k];
+                b->value[k][b->n] = raw.value[k];
+            }
+            b->n++;
+            if(b->n == LOGBATCHSZ && !GhRecalFlush(w))
+            {
+                w->failed = 1;
+                return NULL;
+            }
+        }
+        else
+        {
+            // Lines without raw counts, and blank lines, pass through in order
+            if(!GhRecalFlush(w) || !GhRecalReserve(w,(le - p) + 1))
+            {
+                w->failed = 1;
+                return NULL;
+            }
+            memcpy(w->out + w->outlen,p,le - p);
+            w->outlen += le - p;
+            w->out[w->outlen++] = '\n';
+        }
+        p = le + 1;
+    }
+    w->failed = !GhRecalFlush(w);
+    return NULL;
+}
+
+int main(int argc, char * argv[])
+{
+    int opt;
+    int fd;
+    int i;
+    int nthreads;
+    int ncal;
+    int nbase;
+    long ncpu;
+    uint64_t lines = 0;
+    uint64_t recal = 0;
+    uint64_t same = 0;
+    uint64_t unknown = 0;
+    double kernel = 0.0;
+    double secs;
+    char * base;
+    const char * cut;
+    const char * fname = RDEFAULTLOG;
+    const char * calname = LOGCALFILE;
+    const char * basefile = LOGCALFILE;
+    const char * outname = NULL;
+    FILE * out = stdout;
+    struct stat sb;
+    struct timespec t0,t1;
+    static logcal_s cal[RMAXCAL];
+    static logcal_s basecal[RMAXCAL];
+    static rworker_s workers[RMAXTHREADS];
+
+    while((opt = getopt(argc,argv,"b:c:o:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b':
+                basefile = optarg;
+                break;
+            case 'c':
+                calname = optarg;
+                break;
+            case 'o':
+                outname = optarg;
+                break;
+            default:
+                fprintf(stderr,"Usage: %s [-b basefile] [-c calfile] [-o outfile] [file]\n",argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if(optind < argc)
+    {
+        fname = argv[optind];
+    }
+    ncal = GhLogLoadCal(calname,cal,RMAXCAL);
+    if(ncal < 0)
+    {
+        perror(calname);
+        return EXIT_FAILURE;
+    }
+    nbase = GhLogLoadCal(basefile,basecal,RMAXCAL);
+    if(nbase < 0)
+    {
+        perror(basefile);
+        return EXIT_FAILURE;
+    }
+
+    fd = open(fname,O_RDONLY);
+    if(fd == -1 || fstat(fd,&sb) == -1)
+    {
+        perror(fname);
+        return EXIT_FAILURE;
+    }
+    if(sb.st_size == 0)
+    {
+        close(fd);
+        return EXIT_SUCCESS;
+    }
+    base = mmap(NULL,sb.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if(base == MAP_FAILED)
+    {
+        perror("Error mmapping the log");
+        close(fd);
+        return EXIT_FAILURE;
+    }
+    madvise(base,sb.st_size,MADV_SEQUENTIAL | MADV_WILLNEED);
+    if(outname != NULL && (out = fopen(outname,"w")) == NULL)
+    {
+        perror(outname);
+        return EXIT_FAILURE;
+    }
+
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    nthreads = (ncpu < 1) ? 1 : ((ncpu > RMAXTHREADS) ? RMAXTHREADS : (int) ncpu);
+    if((size_t) nthreads > (size_t) sb.st_size / 4096 + 1)
+    {
+        nthreads = (int)((size_t) sb.st_size / 4096) + 1;
+    }
+
+    // Split at line boundaries and convert every slice in parallel
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    cut = base;
+    for(i=0; i<nthreads; i++)
+    {
+        workers[i].begin = cut;
+        if(i == nthreads - 1)
+        {
+            cut = base + sb.st_size;
+        }
+        else
+        {
+            cut = base + ((size_t) sb.st_size / nthreads) * (i + 1);
+            cut = (cut < workers[i].begin) ? workers[i].begin : cut;
+            cut = GhLogNextLine(cut,base + sb.st_size);
+        }
+        workers[i].end = cut;
+        workers[i].cal = cal;
+        workers[i].ncal = ncal;
+        workers[i].base = basecal;
+        workers[i].nbase = nbase;
+        workers[i].batch = malloc(sizeof(rbatch_s));
+        if(workers[i].batch == NULL)
+        {
+            fprintf(stderr,"ghc-recal: cannot allocate memory\n");
+            return EXIT_FAILURE;
+        }
+        workers[i].batch->n = 0;
+        pthread_create(&workers[i].tid,NULL,GhRecalWorker,&workers[i]);
+    }
+    for(i=0; i<nthreads; i++)
+    {
+        pthread_join(workers[i].tid,NULL);
+        lines += workers[i].lines;
+        recal += workers[i].recal;
+        same += workers[i].same;
+        unknown += workers[i].unknown;
+        kernel += workers[i].kernelsecs;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+
+    // Slices are written back in order, keeping a missing final newline missing
+    for(i=nthreads - 1; i>=0 && workers[i].outlen == 0; i--)
+    {
+    }
+    if(i >= 0 && base[sb.st_size - 1] != '\n')
+    {
+        workers[i].outlen--;
+    }
+    for(i=0; i<nthreads; i++)
+    {
+        if(workers[i].failed)
+        {
+            fprintf(stderr,"ghc-recal: out of memory\n");
+            return EXIT_FAILURE;
+        }
+        fwrite(workers[i].out,1,workers[i].outlen,out);
+        free(workers[i].out);
+        free(workers[i].batch);
+    }
+    if(out != stdout)
+    {
+        fclose(out);
+    }
+    munmap(base,sb.st_size);
+    close(fd);
+
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr,"%llu lines, %llu recalibrated, %llu unchanged calibration, %llu unknown calibration, %d threads\n",
+        (unsigned long long) lines,(unsigned long long) recal,(unsigned long long) same,(unsigned long long) unknown,nthreads);
+    // Kernel time is summed over the threads, so this is the per-thread rate
+    fprintf(stderr,"%.3lf s, %.1lf MB/s, %.1lf M lines/s; kernel %.0lf M samples/s per thread\n",secs,
+        sb.st_size / secs / 1e6,lines / secs / 1e6,(kernel > 0) ? recal * LOGVALUES / kernel / 1e6 : 0.0);
+    return EXIT_SUCCESS;
+}
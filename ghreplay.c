@@ -0,0 +1,144 @@
+/** @brief Gh log replay functions
+*   @file ghreplay.c
+*
+*   Streams a recorded GhLogData() log through the batch control and alarm
+*   kernels in place of sensor acquisition, with no delays and no display,
+*   and prints only the control and alarm transitions.
+*/
+#include <unistd.h>
+#include "ghreplay.h"
+#include "ghbatch.h"
+
+// Replay Constants
+#define REPLAYOUTBUFSZ 65536
+
+/** @brief Prints one replay event with its wall-clock log time
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param out output stream
+ *  @param rtime log time, counting the wall clock as UTC
+ *  @param name control or alarm name
+ *  @param state event state text
+ *  @param value reading that caused the event
+ *  @return void
+*/
+static void GhReplayEvent(FILE * out, time_t rtime, const char * name, const char * state, double value)
+{
+    struct tm tm;
+    char stamp[CTIMESTRSZ];
+    gmtime_r(&rtime,&tm);
+    strftime(stamp,sizeof(stamp),"%a %b %e %H:%M:%S %Y",&tm);
+    fprintf(out,"%s,%s,%s,%.1lf\n",stamp,name,state,value);
+}
+
+/** @brief Replays a recorded log through the control and alarm logic
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fname pointer to log file name
+ *  @param target object of setpoints (targets) data
+ *  @param alarmpt object of alarm limits type
+ *  @param out output stream for transitions
+ *  @return long number of samples replayed, -1 if the log cannot be opened
+*/
+long GhReplay(const char * fname, setpoint_s target, alarmlimit_s alarmpt, FILE * out)
+{
+    int i;
+    int code;
+    long samples = 0;
+    long events = 0;
+    uint8_t cprev = 0;
+    uint8_t cchange;
+    uint16_t aprev = 0;
+    uint16_t achange;
+    double secs;
+    double value;
+    struct timespec t0,t1;
+    logstream_s * ls;
+    logbatch_s * batch;
+    uint8_t * cbits;
+    uint16_t * abits;
+    char * outbuf;
+    int fd;
+    FILE * rout = NULL;
+
+    ls = (logstream_s *) malloc(sizeof(logstream_s));
+    batch = (logbatch_s *) malloc(sizeof(logbatch_s));
+    cbits = (uint8_t *) malloc(LOGBATCHSZ * sizeof(uint8_t));
+    abits = (uint16_t *) malloc(LOGBATCHSZ * sizeof(uint16_t));
+    outbuf = (char *) malloc(REPLAYOUTBUFSZ);
+
+    // A stream of its own over the same descriptor, so the caller's buffering is never touched
+    fflush(out);
+    fd = dup(fileno(out));
+    if(fd != -1 && (rout = fdopen(fd,"w")) == NULL)
+    {
+        close(fd);
+    }
+    if(ls == NULL || batch == NULL || cbits == NULL || abits == NULL || outbuf == NULL || rout == NULL || !GhLogOpen(ls,fname))
+    {
+        if(rout != NULL)
+        {
+            fclose(rout);
+        }
+        free(ls);
+        free(batch);
+        free(cbits);
+        free(abits);
+        free(outbuf);
+        return -1;
+    }
+    setvbuf(rout,outbuf,_IOFBF,REPLAYOUTBUFSZ);
+
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    fprintf(rout,"time,output,state,value\n");
+    while(GhLogRead(ls,batch) > 0)
+    {
+        GhSetControlsBatch(target,batch->temperature,batch->humidity,cbits,batch->n);
+        GhSetAlarmsBatch(alarmpt,batch->temperature,batch->humidity,batch->pressure,abits,batch->n);
+        for(i=0; i<batch->n; i++)
+        {
+            cchange = cbits[i] ^ cprev;
+            achange = abits[i] ^ aprev;
+            if((cchange | achange) == 0)
+            {
+                continue;
+            }
+            if(cchange & CTRLHEATER)
+            {
+                GhReplayEvent(rout,batch->rtime[i],"Heater",(cbits[i] & CTRLHEATER) ? "ON" : "OFF",batch->temperature[i]);
+                events++;
+            }
+            if(cchange & CTRLHUMIDIFIER)
+            {
+                GhReplayEvent(rout,batch->rtime[i],"Humidifier",(cbits[i] & CTRLHUMIDIFIER) ? "ON" : "OFF",batch->humidity[i]);
+                events++;
+            }
+            for(code=HTEMP; code<=LPRESS; code++)
+            {
+                if(achange & ALARMBIT(code))
+                {
+                    value = (code <= LTEMP) ? batch->temperature[i] : ((code <= LHUMID) ? batch->humidity[i] : batch->pressure[i]);
+                    GhReplayEvent(rout,batch->rtime[i],alarmnames[code],(abits[i] & ALARMBIT(code)) ? "SET" : "CLEAR",value);
+                    events++;
+                }
+            }
+            cprev = cbits[i];
+            aprev = abits[i];
+        }
+        samples += batch->n;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    fclose(rout);
+
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    fprintf(stderr,"Replayed %ld samples (%llu bytes), %ld events in %.3f s (%.0f samples/s)\n",
+        samples,(unsigned long long) ls->bytes,events,secs,(secs > 0.0) ? samples / secs : 0.0);
+
+    GhLogClose(ls);
+    free(ls);
+    free(batch);
+    free(cbits);
+    free(abits);
+    free(outbuf);
+    return samples;
+}
@@ -0,0 +1,16 @@
+/** @brief Gh log replay function prototypes
+*   @file ghreplay.h
+*/
+#ifndef GHREPLAY_H
+#define GHREPLAY_H
+
+// Includes
+#include "ghcontrol.h"
+#include "ghlog.h"
+
+// Function Prototypes
+///@cond INTERNAL
+long GhReplay(const char * fname, setpoint_s target, alarmlimit_s alarmpt, FILE * out);
+///@endcond
+
+#endif
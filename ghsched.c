@@ -0,0 +1,119 @@
+/** @brief Gh adaptive sampling functions
+*   @file ghsched.c
+*/
+#include "ghsched.h"
+
+/** @brief Starts the scheduler at the nominal period
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param sc pointer to scheduler
+ *  @param adaptive 0 for a fixed GHUPDATE period
+ *  @return void
+*/
+void GhSchedInit(sched_s * sc, int adaptive)
+{
+    memset(sc,0,sizeof(sched_s));
+    sc->adaptive = adaptive;
+    sc->period = GHUPDATE;
+}
+
+/** @brief Period one channel needs
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param x current value
+ *  @param slope rate of change per second
+ *  @param low lower alarm limit
+ *  @param high upper alarm limit
+ *  @param step change per sample counted as activity
+ *  @param margin distance from a limit that forces the fastest rate
+ *  @return double seconds
+*/
+static double GhSchedChannel(double x, double slope, double low, double high, double step, double margin)
+{
+    double rate = fabs(slope);
+    double limit[2];
+    double dist;
+    double p = SCHEDMAXMS / 1000.0;
+    int i;
+
+    if(rate > 0)
+    {
+        p = fmin(p,step / rate);
+    }
+    // Either limit, approached from inside (onset) or outside (clearing)
+    limit[0] = low;
+    limit[1] = high;
+    for(i=0; i<2; i++)
+    {
+        dist = fabs(limit[i] - x);
+        if(dist <= margin)
+        {
+            return 0.0;
+        }
+        if((limit[i] - x) * slope > 0)
+        {
+            p = fmin(p,(dist - margin) / rate / SCHEDSAMPLES);
+        }
+    }
+    return p;
+}
+
+/** @brief Chooses the period until the next sample
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param sc pointer to scheduler
+ *  @param rdata readings just taken
+ *  @param limits alarm limits in force
+ *  @return int milliseconds
+*/
+int GhSchedNext(sched_s * sc, reading_s rdata, alarmlimit_s limits)
+{
+    double x[SENSORS];
+    double p;
+    double dt;
+    int i;
+    int ms;
+
+    if(!sc->adaptive)
+    {
+        return GHUPDATE;
+    }
+    x[TEMPERATURE] = rdata.temperature;
+    x[HUMIDITY] = rdata.humidity;
+    x[PRESSURE] = rdata.pressure;
+    dt = sc->period / 1000.0;
+    for(i=0; i<SENSORS; i++)
+    {
+        if(sc->primed && !(rdata.stale & (1 << i)))
+        {
+            sc->slope[i] += SCHEDALPHA * ((x[i] - sc->last[i]) / dt - sc->slope[i]);
+        }
+        sc->last[i] = x[i];
+    }
+    if(!sc->primed)
+    {
+        sc->primed = 1;
+        return sc->period;
+    }
+
+    p = GhSchedChannel(x[TEMPERATURE],sc->slope[TEMPERATURE],limits.lowt,limits.hight,SCHEDTSTEP,SCHEDTMARGIN);
+    p = fmin(p,GhSchedChannel(x[HUMIDITY],sc->slope[HUMIDITY],limits.lowh,limits.highh,SCHEDHSTEP,SCHEDHMARGIN));
+    p = fmin(p,GhSchedChannel(x[PRESSURE],sc->slope[PRESSURE],limits.lowp,limits.highp,SCHEDPSTEP,SCHEDPMARGIN));
+
+    // Shorten at once, lengthen gradually
+    ms = (int)(p * 1000.0);
+    if(ms > sc->period * SCHEDGROWTH)
+    {
+        ms = (int)(sc->period * SCHEDGROWTH);
+    }
+    if(ms < SCHEDMINMS)
+    {
+        ms = SCHEDMINMS;
+    }
+    if(ms > SCHEDMAXMS)
+    {
+        ms = SCHEDMAXMS;
+    }
+    sc->period = ms;
+    return ms;
+}
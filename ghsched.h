@@ -0,0 +1,44 @@
+/** @brief Gh adaptive sampling constants, structures, function prototypes
+*   @file ghsched.h
+*
+*   The sampling period stretches while readings are flat and far from the
+*   alarm limits, and shrinks when a trend would reach a limit within
+*   SCHEDSAMPLES periods or a reading moves more than its step per period.
+*/
+#ifndef GHSCHED_H
+#define GHSCHED_H
+
+// Includes
+#include "ghcontrol.h"
+
+// Scheduler Constants
+#define SCHEDADAPTIVE 1         // 0 samples every GHUPDATE ms
+#define SCHEDMINMS 1000
+#define SCHEDMAXMS 30000
+#define SCHEDGROWTH 1.5         // largest stretch of the period per cycle
+#define SCHEDSAMPLES 8          // samples wanted before a trend reaches a limit
+#define SCHEDALPHA 0.3          // EMA weight of a new rate of change
+#define SCHEDTSTEP 0.25         // C per sample counted as activity
+#define SCHEDHSTEP 1.0          // % per sample
+#define SCHEDPSTEP 0.5          // mB per sample
+#define SCHEDTMARGIN 1.0        // C from a limit that forces the fastest rate
+#define SCHEDHMARGIN 3.0        // %
+#define SCHEDPMARGIN 2.0        // mB
+
+//Typedefs
+typedef struct sched
+{
+    int adaptive;
+    int period;                 // ms, the period chosen last
+    int primed;
+    double last[SENSORS];
+    double slope[SENSORS];      // smoothed rate of change per second
+}sched_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhSchedInit(sched_s * sc, int adaptive);
+int GhSchedNext(sched_s * sc, reading_s rdata, alarmlimit_s limits);
+///@endcond
+
+#endif
@@ -0,0 +1,475 @@
+/** @brief Gh telemetry socket server functions
+*   @file ghserver.c
+*
+*   All sockets are non-blocking and multiplexed on one epoll instance.
+*   Replies and pushed samples go into a bounded per-client send buffer that
+*   is drained when the socket is writable; a client whose buffer is still
+*   full after a flush attempt is evicted, so no client can stall the loop.
+*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdarg.h>
+#include "ghserver.h"
+#include "ghbatch.h"
+#include "ghderive.h"
+
+/** @brief Registers a descriptor with the server's epoll instance
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param fd descriptor
+ *  @param tag client index or listener tag
+ *  @param events epoll event mask
+ *  @param op EPOLL_CTL_ADD or EPOLL_CTL_MOD
+ *  @return int 0 on success, -1 on error
+*/
+static int GhServerWatch(ghserver_s * srv, int fd, uint32_t tag, uint32_t events, int op)
+{
+    struct epoll_event ev = {0};
+    ev.events = events;
+    ev.data.u32 = tag;
+    return epoll_ctl(srv->epfd,op,fd,&ev);
+}
+
+/** @brief Closes a client connection
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param i client index
+ *  @return void
+*/
+static void GhServerDrop(ghserver_s * srv, int i)
+{
+    srvclient_s * c = &srv->clients[i];
+    if(c->fd == -1)
+    {
+        return;
+    }
+    epoll_ctl(srv->epfd,EPOLL_CTL_DEL,c->fd,NULL);
+    close(c->fd);
+    c->fd = -1;
+    c->subscribed = 0;
+    c->writing = 0;
+    c->sendlen = 0;
+    c->recvlen = 0;
+    srv->nclients--;
+}
+
+/** @brief Writes as much queued output as the socket accepts
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param i client index
+ *  @return int 1 if the client is still connected, 0 if it was dropped
+*/
+static int GhServerFlush(ghserver_s * srv, int i)
+{
+    ssize_t n;
+    srvclient_s * c = &srv->clients[i];
+    while(c->sendlen > 0)
+    {
+        n = send(c->fd,c->sendbuf,c->sendlen,MSG_NOSIGNAL | MSG_DONTWAIT);
+        if(n > 0)
+        {
+            memmove(c->sendbuf,c->sendbuf + n,c->sendlen - n);
+            c->sendlen -= n;
+        }
+        else if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else if(n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            GhServerDrop(srv,i);
+            return 0;
+        }
+    }
+    // Only ask for EPOLLOUT while output is pending
+    if((c->sendlen > 0) != c->writing)
+    {
+        c->writing = (c->sendlen > 0);
+        GhServerWatch(srv,c->fd,i,EPOLLIN | (c->writing ? EPOLLOUT : 0),EPOLL_CTL_MOD);
+    }
+    return 1;
+}
+
+/** @brief Formats a line into a client's send buffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param i client index
+ *  @param fmt printf format
+ *  @return int 1 if queued, 0 if the client was dropped
+*/
+static int GhServerPrintf(ghserver_s * srv, int i, const char * fmt, ...)
+{
+    int len;
+    va_list ap;
+    char line[SRVLINESZ];
+    srvclient_s * c = &srv->clients[i];
+
+    va_start(ap,fmt);
+    len = vsnprintf(line,sizeof(line),fmt,ap);
+    va_end(ap);
+    if(len < 0)
+    {
+        return 1;
+    }
+    if(len >= (int) sizeof(line))
+    {
+        len = sizeof(line) - 1;
+    }
+    if(c->sendlen + len > SRVSENDBUFSZ)
+    {
+        if(!GhServerFlush(srv,i))
+        {
+            return 0;
+        }
+        if(c->sendlen + len > SRVSENDBUFSZ)
+        {
+            // Slow client: evict rather than block or grow
+            srv->evicted++;
+            GhServerDrop(srv,i);
+            return 0;
+        }
+    }
+    memcpy(c->sendbuf + c->sendlen,line,len);
+    c->sendlen += len;
+    return 1;
+}
+
+/** @brief Handles one command line from a client
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param i client index
+ *  @param line command without its newline
+ *  @return int 1 if the client is still connected, 0 if it was dropped
+*/
+static int GhServerCommand(ghserver_s * srv, int i, char * line)
+{
+    static rollup_s rollups[HISTMINSZ];
+    static reading_s raws[HISTRAWSZ];
+    int k;
+    int n;
+    int code;
+    int ok = 1;
+    char tier[16];
+    histtier_e t;
+    ghsnapshot_s * s = &srv->snap;
+
+    if(strcmp(line,"READ") == 0)
+    {
+        ok = GhServerPrintf(srv,i,"READING %ld %.1lf %.1lf %.1lf\n",(long) s->rdata.rtime,s->rdata.temperature,s->rdata.humidity,s->rdata.pressure)
+            && GhServerPrintf(srv,i,"TARGET %.1lf %.1lf\n",s->spts.temperature,s->spts.humidity)
+            && GhServerPrintf(srv,i,"CONTROL %d %d %.0lf %.0lf\n",s->ctrl.heateron,s->ctrl.humidifieron,s->ctrl.heater,s->ctrl.humidifier);
+    }
+    else if(strcmp(line,"ALARMS") == 0)
+    {
+        for(code=HTEMP; code<NALARMS && ok; code++)
+        {
+            if(s->alarms & ALARMBIT(code))
+            {
+                ok = GhServerPrintf(srv,i,"ALARM %d %ld %.1lf %s\n",code,(long) s->atime[code],s->avalue[code],alarmnames[code]);
+            }
+            else if(s->predicted & ALARMBIT(code))
+            {
+                ok = GhServerPrintf(srv,i,"PREDICTED %d %.0lf %s\n",code,s->peta[code],alarmnames[code]);
+            }
+        }
+    }
+    else if(strcmp(line,"DERIVED") == 0)
+    {
+        GhDerivedSample(&srv->drv,s->rdata);
+        ok = GhServerPrintf(srv,i,"DERIVED %.1lf %.2lf %.1lf %.1lf\n",GhDerived(&srv->drv,DEWPOINT),GhDerived(&srv->drv,VPD),
+            GhDerived(&srv->drv,ABSHUMID),GhDerived(&srv->drv,ENTHALPY));
+    }
+    else if(sscanf(line,"RAW %d",&n) == 1)
+    {
+        n = GhHistoryRaw(srv->hist,(n < 0) ? 0 : n,raws);
+        for(k=0; k<n && ok; k++)
+        {
+            ok = GhServerPrintf(srv,i,"RAW %ld %.1lf %.1lf %.1lf\n",(long) raws[k].rtime,raws[k].temperature,raws[k].humidity,raws[k].pressure);
+        }
+    }
+    else if(sscanf(line,"HIST %15s %d",tier,&n) == 2)
+    {
+        t = (strcmp(tier,"day") == 0) ? HISTDAY : ((strcmp(tier,"hour") == 0) ? HISTHOUR : HISTMINUTE);
+        n = GhHistoryQuery(srv->hist,t,(n < 0) ? 0 : ((n > HISTMINSZ) ? HISTMINSZ : n),rollups);
+        for(k=0; k<n && ok; k++)
+        {
+            ok = GhServerPrintf(srv,i,"ROLLUP %ld %u %.1lf %.1lf %.2lf %.1lf %.1lf %.2lf %.1lf %.1lf %.2lf\n",
+                (long) rollups[k].start,rollups[k].count,
+                rollups[k].min[TEMPERATURE],rollups[k].max[TEMPERATURE],rollups[k].mean[TEMPERATURE],
+                rollups[k].min[HUMIDITY],rollups[k].max[HUMIDITY],rollups[k].mean[HUMIDITY],
+                rollups[k].min[PRESSURE],rollups[k].max[PRESSURE],rollups[k].mean[PRESSURE]);
+        }
+    }
+    else if(strcmp(line,"SUB") == 0)
+    {
+        srv->clients[i].subscribed = 1;
+    }
+    else if(strcmp(line,"UNSUB") == 0)
+    {
+        srv->clients[i].subscribed = 0;
+    }
+    else
+    {
+        ok = GhServerPrintf(srv,i,"ERR unknown command\n");
+    }
+    return ok && GhServerPrintf(srv,i,"END\n");
+}
+
+/** @brief Reads and handles pending commands from a client
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param i client index
+ *  @return void
+*/
+static void GhServerRead(ghserver_s * srv, int i)
+{
+    ssize_t n;
+    char * nl;
+    char * start;
+    srvclient_s * c = &srv->clients[i];
+
+    for(;;)
+    {
+        n = recv(c->fd,c->recvbuf + c->recvlen,SRVRECVBUFSZ - c->recvlen - 1,MSG_DONTWAIT);
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if(n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n <= 0)
+        {
+            GhServerDrop(srv,i);
+            return;
+        }
+        c->recvlen += n;
+        c->recvbuf[c->recvlen] = '\0';
+        start = c->recvbuf;
+        while((nl = strchr(start,'\n')) != NULL)
+        {
+            *nl = '\0';
+            if(nl > start && nl[-1] == '\r')
+            {
+                nl[-1] = '\0';
+            }
+            if(!GhServerCommand(srv,i,start))
+            {
+                return;
+            }
+            start = nl + 1;
+        }
+        c->recvlen -= start - c->recvbuf;
+        memmove(c->recvbuf,start,c->recvlen);
+        if(c->recvlen >= SRVRECVBUFSZ - 1)
+        {
+            // Line too long for the protocol
+            GhServerDrop(srv,i);
+            return;
+        }
+    }
+    GhServerFlush(srv,i);
+}
+
+/** @brief Accepts all pending connections on a listener
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param lfd listening descriptor
+ *  @return void
+*/
+static void GhServerAccept(ghserver_s * srv, int lfd)
+{
+    int i;
+    int fd;
+    while((fd = accept4(lfd,NULL,NULL,SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1)
+    {
+        for(i=0; i<SRVMAXCLIENTS && srv->clients[i].fd != -1; i++)
+        {
+        }
+        if(i == SRVMAXCLIENTS || GhServerWatch(srv,fd,i,EPOLLIN,EPOLL_CTL_ADD) == -1)
+        {
+            close(fd);
+            continue;
+        }
+        srv->clients[i].fd = fd;
+        srv->nclients++;
+    }
+}
+
+/** @brief Creates the listening sockets and the epoll instance
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param hist pointer to history store served by RAW and HIST
+ *  @return int 1 on success, 0 on error
+*/
+int GhServerInit(ghserver_s * srv, history_s * hist)
+{
+    int i;
+    int one = 1;
+    struct sockaddr_un ua = {0};
+    struct sockaddr_in ia = {0};
+
+    srv->hist = hist;
+    srv->nclients = 0;
+    srv->evicted = 0;
+    srv->tcpfd = -1;
+    memset(&srv->snap,0,sizeof(srv->snap));
+    for(i=0; i<SRVMAXCLIENTS; i++)
+    {
+        srv->clients[i].fd = -1;
+    }
+    srv->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if(srv->epfd == -1)
+    {
+        perror("Error (call to 'epoll_create1')");
+        return 0;
+    }
+
+    srv->unixfd = socket(AF_UNIX,SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,0);
+    ua.sun_family = AF_UNIX;
+    strncpy(ua.sun_path,SRVSOCKPATH,sizeof(ua.sun_path) - 1);
+    unlink(SRVSOCKPATH);
+    if(srv->unixfd == -1 || bind(srv->unixfd,(struct sockaddr *) &ua,sizeof(ua)) == -1
+        || listen(srv->unixfd,SRVMAXCLIENTS) == -1 || GhServerWatch(srv,srv->unixfd,SRVUNIXTAG,EPOLLIN,EPOLL_CTL_ADD) == -1)
+    {
+        perror("Error (telemetry socket)");
+        GhServerClose(srv);
+        return 0;
+    }
+
+#if SRVTCPPORT
+    srv->tcpfd = socket(AF_INET,SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,0);
+    ia.sin_family = AF_INET;
+    ia.sin_port = htons(SRVTCPPORT);
+    ia.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if(srv->tcpfd != -1)
+    {
+        setsockopt(srv->tcpfd,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+    }
+    if(srv->tcpfd == -1 || bind(srv->tcpfd,(struct sockaddr *) &ia,sizeof(ia)) == -1
+        || listen(srv->tcpfd,SRVMAXCLIENTS) == -1 || GhServerWatch(srv,srv->tcpfd,SRVTCPTAG,EPOLLIN,EPOLL_CTL_ADD) == -1)
+    {
+        perror("Error (telemetry TCP socket)");
+        GhServerClose(srv);
+        return 0;
+    }
+#else
+    (void) ia;
+    (void) one;
+#endif
+    return 1;
+}
+
+/** @brief Services ready sockets without blocking longer than asked
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param milliseconds longest wait for the first event, 0 to only poll
+ *  @return void
+*/
+void GhServerPoll(ghserver_s * srv, int milliseconds)
+{
+    int k;
+    int n;
+    uint32_t tag;
+    struct epoll_event evs[SRVMAXEVENTS];
+
+    n = epoll_wait(srv->epfd,evs,SRVMAXEVENTS,milliseconds);
+    for(k=0; k<n; k++)
+    {
+        tag = evs[k].data.u32;
+        if(tag == SRVUNIXTAG)
+        {
+            GhServerAccept(srv,srv->unixfd);
+        }
+        else if(tag == SRVTCPTAG)
+        {
+            GhServerAccept(srv,srv->tcpfd);
+        }
+        else if(srv->clients[tag].fd != -1)
+        {
+            if(evs[k].events & (EPOLLERR | EPOLLHUP))
+            {
+                GhServerDrop(srv,tag);
+                continue;
+            }
+            if((evs[k].events & EPOLLOUT) && !GhServerFlush(srv,tag))
+            {
+                continue;
+            }
+            if(evs[k].events & EPOLLIN)
+            {
+                GhServerRead(srv,tag);
+            }
+        }
+    }
+}
+
+/** @brief Stores the latest snapshot and pushes it to subscribers
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @param snap pointer to snapshot of the new sample
+ *  @return void
+*/
+void GhServerPublish(ghserver_s * srv, const ghsnapshot_s * snap)
+{
+    int i;
+    srv->snap = *snap;
+    for(i=0; i<SRVMAXCLIENTS; i++)
+    {
+        if(srv->clients[i].fd != -1 && srv->clients[i].subscribed)
+        {
+            if(GhServerPrintf(srv,i,"SAMPLE %ld %.1lf %.1lf %.1lf %d %d %u %.0lf %.0lf\n",
+                (long) snap->rdata.rtime,snap->rdata.temperature,snap->rdata.humidity,snap->rdata.pressure,
+                snap->ctrl.heateron,snap->ctrl.humidifieron,snap->alarms,snap->ctrl.heater,snap->ctrl.humidifier))
+            {
+                GhServerFlush(srv,i);
+            }
+        }
+    }
+}
+
+/** @brief Closes every connection and listener
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param srv pointer to server
+ *  @return void
+*/
+void GhServerClose(ghserver_s * srv)
+{
+    int i;
+    for(i=0; i<SRVMAXCLIENTS; i++)
+    {
+        GhServerDrop(srv,i);
+    }
+    if(srv->unixfd != -1)
+    {
+        close(srv->unixfd);
+        unlink(SRVSOCKPATH);
+        srv->unixfd = -1;
+    }
+    if(srv->tcpfd != -1)
+    {
+        close(srv->tcpfd);
+        srv->tcpfd = -1;
+    }
+    if(srv->epfd != -1)
+    {
+        close(srv->epfd);
+        srv->epfd = -1;
+    }
+}
@@ -0,0 +1,72 @@
+/** @brief Gh telemetry socket server constants, structures, function prototypes
+*   @file ghserver.h
+*
+*   Line protocol, one command per line:
+*     READ                      latest sample, setpoints and controls
+*                               (relay states, then duty cycles in %)
+*     ALARMS                    active alarms, then predicted ones
+*     DERIVED                   dew point (C), VPD (kPa), absolute
+*                               humidity (g/m3), enthalpy (kJ/kg)
+*     RAW <n>                   last n raw samples
+*     HIST minute|hour|day <n>  last n rollups of a history tier
+*     SUB / UNSUB               start or stop the per-sample push stream
+*   Every reply ends with "END".
+*/
+#ifndef GHSERVER_H
+#define GHSERVER_H
+
+// Includes
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "ghcontrol.h"
+#include "ghhistory.h"
+#include "ghshm.h"
+
+// Server Constants
+#define SRVSOCKPATH "/tmp/ghc.sock"
+#define SRVTCPPORT 0            // localhost TCP port, 0 to disable
+#define SRVMAXCLIENTS 32
+#define SRVSENDBUFSZ 65536      // per-client bound; a client that falls further behind is evicted
+#define SRVRECVBUFSZ 256
+#define SRVMAXEVENTS 16
+#define SRVLINESZ 256
+#define SRVUNIXTAG SRVMAXCLIENTS
+#define SRVTCPTAG (SRVMAXCLIENTS + 1)
+
+//Typedefs
+typedef struct srvclient
+{
+    int fd;
+    int subscribed;
+    int writing;
+    size_t sendlen;
+    size_t recvlen;
+    char sendbuf[SRVSENDBUFSZ];
+    char recvbuf[SRVRECVBUFSZ];
+}srvclient_s;
+
+typedef struct ghserver
+{
+    int epfd;
+    int unixfd;
+    int tcpfd;
+    int nclients;
+    uint64_t evicted;
+    history_s * hist;
+    ghsnapshot_s snap;
+    derived_s drv;              // computed from snap only when asked
+    srvclient_s clients[SRVMAXCLIENTS];
+}ghserver_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhServerInit(ghserver_s * srv, history_s * hist);
+void GhServerPoll(ghserver_s * srv, int milliseconds);
+void GhServerPublish(ghserver_s * srv, const ghsnapshot_s * snap);
+void GhServerClose(ghserver_s * srv);
+///@endcond
+
+#endif
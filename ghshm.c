@@ -0,0 +1,232 @@
+/** @brief Gh shared-memory snapshot functions
+*   @file ghshm.c
+*/
+#include "ghshm.h"
+#include "ghbatch.h"
+
+/** @brief Creates and maps the shared-memory segment for writing
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return pointer to the mapped segment, NULL on error
+*/
+ghshm_s * GhShmCreate(void)
+{
+    int fd;
+    ghshm_s * shm;
+    fd = shm_open(SHMNAME,O_CREAT | O_RDWR,0644);
+    if(fd == -1)
+    {
+        perror("Error (call to 'shm_open')");
+        return NULL;
+    }
+    if(ftruncate(fd,sizeof(ghshm_s)) == -1)
+    {
+        perror("Error (call to 'ftruncate')");
+        close(fd);
+        return NULL;
+    }
+    shm = mmap(NULL,sizeof(ghshm_s),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if(shm == MAP_FAILED)
+    {
+        perror("Error mmapping the snapshot");
+        return NULL;
+    }
+    memset(shm,0,sizeof(ghshm_s));
+    shm->size = sizeof(ghshm_s);
+    __atomic_store_n(&shm->magic,SHMMAGIC,__ATOMIC_RELEASE);
+    return shm;
+}
+
+/** @brief Publishes a snapshot under the sequence lock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param shm pointer to the mapped segment
+ *  @param snap pointer to the snapshot to publish
+ *  @return void
+*/
+void GhShmPublish(ghshm_s * shm, const ghsnapshot_s * snap)
+{
+    uint32_t seq = __atomic_load_n(&shm->seq,__ATOMIC_RELAXED);
+    __atomic_store_n(&shm->seq,seq + 1,__ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&shm->snap,snap,sizeof(ghsnapshot_s));
+    __atomic_store_n(&shm->seq,seq + 2,__ATOMIC_RELEASE);
+}
+
+/** @brief Fills a snapshot from the current controller state
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param snap pointer to the snapshot to fill; its cycle is incremented
+ *  @param rdata object of readings type
+ *  @param spts object of setpoints type
+ *  @param ctrl object of controls type
+ *  @param head pointer to alarm_s list
+ *  @param predicted ALARMBIT(code) for each predicted alarm
+ *  @param eta NALARMS seconds until each predicted alarm
+ *  @return void
+*/
+void GhShmSnapshot(ghsnapshot_s * snap, reading_s rdata, setpoint_s spts, control_s ctrl, alarm_s * head, uint32_t predicted, const double * eta)
+{
+    alarm_s * cur;
+    snap->cycle++;
+    snap->rdata = rdata;
+    snap->spts = spts;
+    snap->ctrl = ctrl;
+    snap->alarms = GhAlarmBits(head);
+    memset(snap->atime,0,sizeof(snap->atime));
+    memset(snap->avalue,0,sizeof(snap->avalue));
+    for(cur = head; cur != NULL; cur = cur->next)
+    {
+        if(cur->code != NOALARM)
+        {
+            snap->atime[cur->code] = cur->atime;
+            snap->avalue[cur->code] = cur->value;
+        }
+    }
+    snap->predicted = predicted;
+    memcpy(snap->peta,eta,sizeof(snap->peta));
+}
+
+/** @brief Fills every field of a benchmark snapshot from its cycle number
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param snap pointer to the snapshot to fill
+ *  @param cycle cycle number
+ *  @return void
+*/
+static void GhShmBenchFill(ghsnapshot_s * snap, uint64_t cycle)
+{
+    int i;
+    snap->cycle = cycle;
+    snap->rdata.rtime = (time_t) cycle;
+    snap->rdata.temperature = (double) cycle;
+    snap->rdata.humidity = (double) cycle;
+    snap->rdata.pressure = (double) cycle;
+    snap->alarms = (uint32_t) cycle;
+    snap->predicted = (uint32_t) cycle;
+    for(i=0; i<NALARMS; i++)
+    {
+        snap->atime[i] = (time_t) cycle;
+        snap->avalue[i] = (double) cycle;
+        snap->peta[i] = (double) cycle;
+    }
+}
+
+/** @brief Tells whether a benchmark snapshot came from a single publish
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param snap pointer to the snapshot read
+ *  @return int 1 if every field matches its cycle number
+*/
+static int GhShmBenchCheck(const ghsnapshot_s * snap)
+{
+    int i;
+    int ok = snap->rdata.rtime == (time_t) snap->cycle && snap->rdata.temperature == (double) snap->cycle
+        && snap->rdata.humidity == (double) snap->cycle && snap->rdata.pressure == (double) snap->cycle
+        && snap->alarms == (uint32_t) snap->cycle && snap->predicted == (uint32_t) snap->cycle;
+    for(i=0; i<NALARMS && ok; i++)
+    {
+        ok = snap->atime[i] == (time_t) snap->cycle && snap->avalue[i] == (double) snap->cycle && snap->peta[i] == (double) snap->cycle;
+    }
+    return ok;
+}
+
+/** @brief Publishes benchmark snapshots back to back until stopped
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to benchmark state
+ *  @return void * always NULL
+*/
+static void * GhShmBenchWriter(void * arg)
+{
+    shmbench_s * b = (shmbench_s *) arg;
+    ghsnapshot_s snap = {0};
+    uint64_t cycle = 1;
+    while(!__atomic_load_n(&b->stop,__ATOMIC_RELAXED))
+    {
+        GhShmBenchFill(&snap,cycle++);
+        GhShmPublish(b->shm,&snap);
+    }
+    __atomic_store_n(&b->published,cycle - 1,__ATOMIC_RELEASE);
+    return NULL;
+}
+
+/** @brief Races a reader against a writer publishing back to back, checking every copy
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param fp output stream
+ *  @return int 1 if no torn or out-of-order snapshot was read, 0 otherwise
+*/
+int GhShmReport(FILE * fp)
+{
+    uint64_t i;
+    uint64_t reads = 0;
+    uint64_t misses = 0;
+    uint64_t torn = 0;
+    uint64_t backwards = 0;
+    uint64_t last = 0;
+    double idlens;
+    double secs;
+    ghsnapshot_s snap;
+    shmbench_s b = {0};
+    pthread_t tid;
+    struct timespec t0,t1;
+
+    // A private mapping, so a running controller's segment is left alone
+    b.shm = mmap(NULL,sizeof(ghshm_s),PROT_READ | PROT_WRITE,MAP_SHARED | MAP_ANONYMOUS,-1,0);
+    if(b.shm == MAP_FAILED)
+    {
+        perror("Error mmapping the snapshot");
+        return 0;
+    }
+    b.shm->size = sizeof(ghshm_s);
+    b.shm->magic = SHMMAGIC;
+    GhShmBenchFill(&snap,0);
+    GhShmPublish(b.shm,&snap);
+
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    for(i=0; i<SHMBENCHIDLE; i++)
+    {
+        torn += !GhShmRead(b.shm,&snap) || !GhShmBenchCheck(&snap);
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    idlens = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / SHMBENCHIDLE;
+
+    if(pthread_create(&tid,NULL,GhShmBenchWriter,&b) != 0)
+    {
+        perror("Error (snapshot writer)");
+        munmap(b.shm,sizeof(ghshm_s));
+        return 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    do
+    {
+        if(!GhShmRead(b.shm,&snap))
+        {
+            misses++;
+        }
+        else
+        {
+            reads++;
+            torn += !GhShmBenchCheck(&snap);
+            backwards += snap.cycle < last;
+            last = snap.cycle;
+        }
+        clock_gettime(CLOCK_MONOTONIC,&t1);
+    }
+    while((t1.tv_sec - t0.tv_sec) * 1000 + (t1.tv_nsec - t0.tv_nsec) / 1000000 < SHMBENCHMS);
+    __atomic_store_n(&b.stop,1,__ATOMIC_RELAXED);
+    pthread_join(tid,NULL);
+    secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    munmap(b.shm,sizeof(ghshm_s));
+
+    fprintf(fp,"Snapshot seqlock, %zu byte snapshot\n",sizeof(ghsnapshot_s));
+    fprintf(fp,"Uncontended read: %.0lf ns\n",idlens);
+    fprintf(fp,"Against a writer: %llu publishes, %llu reads in %.1lf s, %.0lf ns per read (clock included)\n",
+        (unsigned long long) b.published,(unsigned long long) reads,secs,secs * 1e9 / (reads + misses));
+    fprintf(fp,"Reads out of tries: %llu, torn: %llu, out of order: %llu\n",
+        (unsigned long long) misses,(unsigned long long) torn,(unsigned long long) backwards);
+    return torn == 0 && backwards == 0 && reads > 0;
+}
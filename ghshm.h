@@ -0,0 +1,67 @@
+/** @brief Gh shared-memory snapshot constants, structures, function prototypes
+*   @file ghshm.h
+*
+*   The controller publishes its latest state into a POSIX shared-memory
+*   segment guarded by a sequence lock. Local readers link ghshmread.o
+*   alone (ghc-snap is the smallest), call GhShmAttach() once and
+*   GhShmRead() whenever they need a consistent copy; they never block the
+*   control loop. The writer side in ghshm.o pulls in the controller.
+*/
+#ifndef GHSHM_H
+#define GHSHM_H
+
+// Includes
+#include <pthread.h>
+#include "ghcontrol.h"
+
+// Shared Memory Constants
+#define SHMNAME "/ghc"
+#define SHMMAGIC 0x47484331     // "GHC1"
+#define SHMREADTRIES 1000
+#define SHMBENCHMS 2000         // ms the reader races the writer in GhShmReport()
+#define SHMBENCHIDLE 1000000    // uncontended reads timed first
+
+//Typedefs
+typedef struct ghsnapshot
+{
+    uint64_t cycle;
+    reading_s rdata;
+    setpoint_s spts;
+    control_s ctrl;
+    uint32_t alarms;            // ALARMBIT(code) for each active alarm
+    time_t atime[NALARMS];
+    double avalue[NALARMS];
+    uint32_t predicted;         // ALARMBIT(code) for each alarm the trend will reach
+    double peta[NALARMS];       // s until each predicted alarm
+}ghsnapshot_s;
+
+typedef struct ghshm
+{
+    uint32_t magic;
+    uint32_t size;
+    uint32_t seq;               // odd while the controller is writing
+    uint32_t pad;
+    ghsnapshot_s snap;
+}ghshm_s;
+
+typedef struct shmbench
+{
+    ghshm_s * shm;
+    int stop;
+    uint64_t published;
+}shmbench_s;
+
+// Function Prototypes
+///@cond INTERNAL
+// ghshm.c, the writer
+ghshm_s * GhShmCreate(void);
+void GhShmPublish(ghshm_s * shm, const ghsnapshot_s * snap);
+void GhShmSnapshot(ghsnapshot_s * snap, reading_s rdata, setpoint_s spts, control_s ctrl, alarm_s * head, uint32_t predicted, const double * eta);
+int GhShmReport(FILE * fp);
+// ghshmread.c, the reader
+ghshm_s * GhShmAttach(void);
+int GhShmRead(const ghshm_s * shm, ghsnapshot_s * snap);
+void GhShmDetach(ghshm_s * shm);
+///@endcond
+
+#endif
@@ -0,0 +1,80 @@
+/** @brief Gh shared-memory snapshot reader functions
+*   @file ghshmread.c
+*
+*   The reader side of ghshm.c, kept apart so a client links this object
+*   alone, without the controller objects behind GhShmSnapshot().
+*/
+#include "ghshm.h"
+
+/** @brief Maps the controller's segment read-only
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return pointer to the mapped segment, NULL if the controller is not running
+*/
+ghshm_s * GhShmAttach(void)
+{
+    int fd;
+    ghshm_s * shm;
+    fd = shm_open(SHMNAME,O_RDONLY,0);
+    if(fd == -1)
+    {
+        return NULL;
+    }
+    shm = mmap(NULL,sizeof(ghshm_s),PROT_READ,MAP_SHARED,fd,0);
+    close(fd);
+    if(shm == MAP_FAILED)
+    {
+        return NULL;
+    }
+    if(__atomic_load_n(&shm->magic,__ATOMIC_ACQUIRE) != SHMMAGIC || shm->size != sizeof(ghshm_s))
+    {
+        munmap(shm,sizeof(ghshm_s));
+        return NULL;
+    }
+    return shm;
+}
+
+/** @brief Copies a consistent snapshot, retrying while a write is in progress
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param shm pointer to the mapped segment
+ *  @param snap pointer to the snapshot copy
+ *  @return int 1 on success, 0 if no consistent copy was seen in SHMREADTRIES attempts
+*/
+int GhShmRead(const ghshm_s * shm, ghsnapshot_s * snap)
+{
+    int tries;
+    uint32_t before;
+    uint32_t after;
+    for(tries=0; tries<SHMREADTRIES; tries++)
+    {
+        before = __atomic_load_n(&shm->seq,__ATOMIC_ACQUIRE);
+        if(before & 1)
+        {
+            continue;
+        }
+        memcpy(snap,&shm->snap,sizeof(ghsnapshot_s));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&shm->seq,__ATOMIC_RELAXED);
+        if(before == after)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** @brief Unmaps a segment returned by GhShmAttach() or GhShmCreate()
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param shm pointer to the mapped segment
+ *  @return void
+*/
+void GhShmDetach(ghshm_s * shm)
+{
+    if(shm != NULL)
+    {
+        munmap(shm,sizeof(ghshm_s));
+    }
+}
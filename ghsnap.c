@@ -0,0 +1,66 @@
+/** @brief ghc-snap: prints the controller's latest snapshot
+*   @file ghsnap.c
+*
+*   Usage: ghc-snap [-n count] [-i ms]
+*
+*   The smallest shared-memory client: it links ghshmread.o and nothing of
+*   the controller, attaches to the segment ghc publishes and prints one
+*   line per read:
+*     <cycle>,<time>,<temperature>,<humidity>,<pressure>,<heater>,<humidifier>,<alarm bits>
+*   The alarm bits are ALARMBIT(code) in hex. Exits 1 if the controller is
+*   not running or no consistent copy could be read.
+*/
+#include <unistd.h>
+#include "ghshm.h"
+
+// Client Constants
+#define SNAPINTERVAL 1000       // ms between reads with -n
+
+int main(int argc, char * argv[])
+{
+    int opt;
+    int i;
+    int count = 1;
+    int ms = SNAPINTERVAL;
+    ghshm_s * shm;
+    ghsnapshot_s snap;
+
+    while((opt = getopt(argc,argv,"n:i:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                count = atoi(optarg);
+                break;
+            case 'i':
+                ms = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr,"Usage: %s [-n count] [-i ms]\n",argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    shm = GhShmAttach();
+    if(shm == NULL)
+    {
+        fprintf(stderr,"ghc-snap: no snapshot at %s, is ghc running?\n",SHMNAME);
+        return EXIT_FAILURE;
+    }
+    for(i=0; i<count; i++)
+    {
+        if(i > 0)
+        {
+            usleep((useconds_t) ms * 1000);
+        }
+        if(!GhShmRead(shm,&snap))
+        {
+            fprintf(stderr,"ghc-snap: no consistent copy in %d tries\n",SHMREADTRIES);
+            GhShmDetach(shm);
+            return EXIT_FAILURE;
+        }
+        fprintf(stdout,"%llu,%lld,%.1lf,%.1lf,%.1lf,%d,%d,%x\n",(unsigned long long) snap.cycle,(long long) snap.rdata.rtime,
+            snap.rdata.temperature,snap.rdata.humidity,snap.rdata.pressure,snap.ctrl.heateron,snap.ctrl.humidifieron,snap.alarms);
+    }
+    GhShmDetach(shm);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,251 @@
+/** @brief Gh startup sequencing functions
+*   @file ghstartup.c
+*/
+#include "ghstartup.h"
+
+/** @brief Reads the monotonic clock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t nanoseconds
+*/
+static int64_t GhStartupNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Opens the sensors and takes the first reading
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to startup state
+ *  @return void pointer, NULL
+*/
+static void * GhStartupSensorJob(void * arg)
+{
+    ghstartup_s * st = (ghstartup_s *) arg;
+    int ph;
+
+    ph = GhStartupBegin(st,"sensors",STSENSORS);
+    st->ok[STSENSORS] = (ShSensorInit() == EXIT_SUCCESS);
+    if(!st->ok[STSENSORS])
+    {
+        fprintf(stderr,"Warning: sensors not found, readings will be stale\n");
+    }
+    GhStartupEnd(st,ph);
+
+    ph = GhStartupBegin(st,"first reading",STSENSORS);
+    st->first = GhGetReadings();
+    st->primed = 1;
+    GhStartupEnd(st,ph);
+    return NULL;
+}
+
+/** @brief Opens the display, mapping the LED framebuffer on the Sense Hat
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to startup state
+ *  @return void pointer, NULL
+*/
+static void * GhStartupDisplayJob(void * arg)
+{
+    ghstartup_s * st = (ghstartup_s *) arg;
+    int ph;
+
+    ph = GhStartupBegin(st,"framebuffer",STDISPLAY);
+    st->ok[STDISPLAY] = (ShDisplayInit() == EXIT_SUCCESS);
+    ShClearMatrix();
+    GhStartupEnd(st,ph);
+    return NULL;
+}
+
+/** @brief Runs a job on its own thread, or inline when that is not possible
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @param job STSENSORS or STDISPLAY
+ *  @param fn job function
+ *  @return void
+*/
+static void GhStartupSpawn(ghstartup_s * st, startjob_e job, void * (* fn)(void *))
+{
+#if STARTPARALLEL
+    // Python is not safe to start on one thread and use from another
+    if(!ShPinned() && pthread_create(&st->tid[job],NULL,fn,st) == 0)
+    {
+        st->running[job] = 1;
+        return;
+    }
+#endif
+    fn(st);
+}
+
+/** @brief Starts the startup clock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return void
+*/
+void GhStartupInit(ghstartup_s * st)
+{
+    memset(st,0,sizeof(ghstartup_s));
+    st->t0 = GhStartupNs();
+}
+
+/** @brief Starts timing a phase
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @param name phase name, truncated to STARTNAMESZ - 1 characters
+ *  @param job thread the phase runs on
+ *  @return int phase index for GhStartupEnd(), -1 when the table is full
+*/
+int GhStartupBegin(ghstartup_s * st, const char * name, startjob_e job)
+{
+    int ph = __atomic_fetch_add(&st->count,1,__ATOMIC_RELAXED);
+    if(ph >= STARTMAXPHASES)
+    {
+        return -1;
+    }
+    strncpy(st->phase[ph].name,name,STARTNAMESZ - 1);
+    st->phase[ph].job = job;
+    st->phase[ph].begin = GhStartupNs() - st->t0;
+    st->phase[ph].end = st->phase[ph].begin;
+    return ph;
+}
+
+/** @brief Stops timing a phase
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @param ph phase index from GhStartupBegin()
+ *  @return void
+*/
+void GhStartupEnd(ghstartup_s * st, int ph)
+{
+    if(ph >= 0)
+    {
+        st->phase[ph].end = GhStartupNs() - st->t0;
+    }
+}
+
+/** @brief Opens the sensors and starts the first conversion in the background
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return void
+*/
+void GhStartupSensors(ghstartup_s * st)
+{
+    GhStartupSpawn(st,STSENSORS,GhStartupSensorJob);
+}
+
+/** @brief Maps the LED framebuffer in the background
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return void
+*/
+void GhStartupDisplay(ghstartup_s * st)
+{
+    GhStartupSpawn(st,STDISPLAY,GhStartupDisplayJob);
+}
+
+/** @brief Waits for a job to finish
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @param job STSENSORS or STDISPLAY
+ *  @return int 1 if the job's hardware came up
+*/
+int GhStartupJoin(ghstartup_s * st, startjob_e job)
+{
+    int ph;
+    if(st->running[job])
+    {
+        ph = GhStartupBegin(st,(job == STSENSORS) ? "wait sensors" : "wait display",STMAIN);
+        pthread_join(st->tid[job],NULL);
+        st->running[job] = 0;
+        GhStartupEnd(st,ph);
+    }
+    return st->ok[job];
+}
+
+/** @brief Gets a reading, the first one from the sensor job
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return object of readings type
+*/
+reading_s GhStartupReading(ghstartup_s * st)
+{
+    GhStartupJoin(st,STSENSORS);
+    if(st->primed)
+    {
+        st->primed = 0;
+        return st->first;
+    }
+    return GhGetReadings();
+}
+
+/** @brief Records the first control decision
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return void
+*/
+void GhStartupDecision(ghstartup_s * st)
+{
+    if(st->decision == 0)
+    {
+        st->decision = GhStartupNs() - st->t0;
+    }
+}
+
+/** @brief Prints each phase in the order it started
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @param fp report stream
+ *  @return void
+*/
+void GhStartupReport(const ghstartup_s * st, FILE * fp)
+{
+    static const char jobnames[STJOBS][8] = {"main","sensors","display"};
+    int order[STARTMAXPHASES];
+    int n = (st->count < STARTMAXPHASES) ? st->count : STARTMAXPHASES;
+    int i;
+    int j;
+    int k;
+
+    for(i=0; i<n; i++)
+    {
+        k = i;
+        for(j=i; j>0 && st->phase[order[j - 1]].begin > st->phase[k].begin; j--)
+        {
+            order[j] = order[j - 1];
+        }
+        order[j] = k;
+    }
+    fprintf(fp,"Startup phase\t   start ms\t    time ms\tthread\n");
+    for(i=0; i<n; i++)
+    {
+        k = order[i];
+        fprintf(fp,"  %-15s %10.2lf\t %10.2lf\t%s\n",st->phase[k].name,st->phase[k].begin / 1e6,
+            (st->phase[k].end - st->phase[k].begin) / 1e6,jobnames[st->phase[k].job]);
+    }
+    fprintf(fp,"First control decision at %.2lf ms\n",st->decision / 1e6);
+}
+
+/** @brief Waits for any job still running, so shutdown does not race it
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to startup state
+ *  @return void
+*/
+void GhStartupClose(ghstartup_s * st)
+{
+    GhStartupJoin(st,STSENSORS);
+    GhStartupJoin(st,STDISPLAY);
+}
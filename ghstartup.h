@@ -0,0 +1,64 @@
+/** @brief Gh startup sequencing constants, structures, function prototypes
+*   @file ghstartup.h
+*
+*   Startup is arranged around the first control decision. The sensors are
+*   opened and the first one-shot conversion run on one thread while the
+*   LED framebuffer is opened and mapped on another; the main thread loads
+*   the targets, checkpoint and configuration and opens the relays in the
+*   meantime. Everything that only reports on the controller (the matrix,
+*   the shared snapshot, the query server and the data log) comes up after
+*   the first decision has reached the relays. Each phase is timed from the
+*   start of main() and GhStartupReport() prints them once that is done.
+*/
+#ifndef GHSTARTUP_H
+#define GHSTARTUP_H
+
+// Includes
+#include <pthread.h>
+#include "ghcontrol.h"
+
+// Startup Constants
+#define STARTPARALLEL 1         // 0 runs the sensor and display jobs inline, in order
+#define STARTMAXPHASES 24
+#define STARTNAMESZ 16
+
+//Enumerated Types
+typedef enum { STMAIN, STSENSORS, STDISPLAY, STJOBS } startjob_e;
+
+//Typedefs
+typedef struct startphase
+{
+    char name[STARTNAMESZ];
+    startjob_e job;             // thread the phase ran on
+    int64_t begin;              // ns since GhStartupInit()
+    int64_t end;
+}startphase_s;
+
+typedef struct ghstartup
+{
+    int64_t t0;                 // monotonic ns
+    int count;                  // phases claimed, shared by the jobs
+    startphase_s phase[STARTMAXPHASES];
+    pthread_t tid[STJOBS];
+    int running[STJOBS];        // 1 while a job thread is not yet joined
+    int ok[STJOBS];             // 1 when the job's hardware came up
+    int primed;                 // 1 while first holds an unused reading
+    reading_s first;
+    int64_t decision;           // ns at the first control decision, 0 before
+}ghstartup_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhStartupInit(ghstartup_s * st);
+int GhStartupBegin(ghstartup_s * st, const char * name, startjob_e job);
+void GhStartupEnd(ghstartup_s * st, int ph);
+void GhStartupSensors(ghstartup_s * st);
+void GhStartupDisplay(ghstartup_s * st);
+int GhStartupJoin(ghstartup_s * st, startjob_e job);
+reading_s GhStartupReading(ghstartup_s * st);
+void GhStartupDecision(ghstartup_s * st);
+void GhStartupReport(const ghstartup_s * st, FILE * fp);
+void GhStartupClose(ghstartup_s * st);
+///@endcond
+
+#endif
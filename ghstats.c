@@ -0,0 +1,470 @@
+/** @brief Gh sliding-window statistics functions
+*   @file ghstats.c
+*
+*   Rolling mean and variance use Welford running moments, updated as a
+*   sample enters a window and again, in reverse, as it ages out; rolling
+*   min and max use monotonic deques. Every sample costs amortised constant
+*   time whatever the window length, and all storage is inside stats_s so
+*   nothing is allocated after init. The moments are recomputed from the
+*   ring once per STATMAXWIN samples so rounding cannot build up over a
+*   long run.
+*/
+#include "ghstats.h"
+
+/** @brief Pushes a sample onto the back of a monotonic deque
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param q deque storage of sample sequence numbers
+ *  @param head pointer to deque front index
+ *  @param count pointer to deque length
+ *  @param ring sample ring of the channel
+ *  @param seq sequence number of the new sample
+ *  @param sign 1 to keep the maximum at the front, -1 for the minimum
+ *  @return void
+*/
+static void GhDequePush(uint32_t * q, int * head, int * count, const double * ring, uint32_t seq, double sign)
+{
+    double x = sign * ring[seq % STATMAXWIN];
+    int back;
+    // Drop dominated samples from the back
+    while(*count > 0)
+    {
+        back = (*head + *count - 1) % STATMAXWIN;
+        if(sign * ring[q[back] % STATMAXWIN] > x)
+        {
+            break;
+        }
+        (*count)--;
+    }
+    q[(*head + *count) % STATMAXWIN] = seq;
+    (*count)++;
+}
+
+/** @brief Drops a sample leaving the window from the front of a deque
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param q deque storage of sample sequence numbers
+ *  @param head pointer to deque front index
+ *  @param count pointer to deque length
+ *  @param seq sequence number of the sample leaving, the oldest in the window
+ *  @return void
+*/
+static void GhDequeEvict(const uint32_t * q, int * head, int * count, uint32_t seq)
+{
+    if(*count > 0 && q[*head] == seq)
+    {
+        *head = (*head + 1) % STATMAXWIN;
+        (*count)--;
+    }
+}
+
+/** @brief Recomputes a window's moments from the samples it holds
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to statistics store
+ *  @param ws pointer to window
+ *  @return void
+*/
+static void GhStatsResync(stats_s * st, winstats_s * ws)
+{
+    int s;
+    int i;
+    double x;
+    double oldmean;
+    chanstats_s * cs;
+    for(s=0; s<SENSORS; s++)
+    {
+        cs = &ws->chan[s];
+        cs->n = 0;
+        cs->mean = 0.0;
+        cs->m2 = 0.0;
+        for(i=0; i<ws->count; i++)
+        {
+            x = st->ring[s][(ws->first + i) % STATMAXWIN];
+            if(isnan(x))
+            {
+                continue;
+            }
+            oldmean = cs->mean;
+            cs->mean += (x - oldmean) / (++cs->n);
+            cs->m2 += (x - oldmean) * (x - cs->mean);
+        }
+    }
+}
+
+/** @brief Initialises the statistics windows
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to statistics store
+ *  @param winsecs window lengths in seconds, NULL for the defaults
+ *  @return void
+*/
+void GhStatsInit(stats_s * st, const int winsecs[STATWINDOWS])
+{
+    int w;
+    memset(st,0,sizeof(stats_s));
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        st->win[w].secs = (winsecs != NULL) ? winsecs[w] : ((w == 0) ? STATWIN0SECS : STATWIN1SECS);
+        if(st->win[w].secs < 1)
+        {
+            st->win[w].secs = 1;
+        }
+    }
+}
+
+/** @brief Adds one reading to every window, ageing out what has passed
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to statistics store
+ *  @param rdata object of readings type, rtime orders the samples
+ *  @return void
+*/
+void GhStatsAdd(stats_s * st, reading_s rdata)
+{
+    int w;
+    int s;
+    uint32_t seq = st->seq;
+    uint32_t slot = seq % STATMAXWIN;
+    double x;
+    double oldmean;
+    winstats_s * ws;
+    chanstats_s * cs;
+
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        // Evict by age, or by room when the period has run below SCHEDMINMS
+        ws = &st->win[w];
+        while(ws->count > 0 && (rdata.rtime - st->rtime[ws->first % STATMAXWIN] >= ws->secs || ws->count == STATMAXWIN))
+        {
+            for(s=0; s<SENSORS; s++)
+            {
+                cs = &ws->chan[s];
+                x = st->ring[s][ws->first % STATMAXWIN];
+                if(isnan(x))
+                {
+                    continue;
+                }
+                if(cs->n == 1)
+                {
+                    cs->mean = 0.0;
+                    cs->m2 = 0.0;
+                }
+                else
+                {
+                    oldmean = cs->mean;
+                    cs->mean -= (x - oldmean) / (cs->n - 1);
+                    cs->m2 -= (x - oldmean) * (x - cs->mean);
+                    cs->m2 = (cs->m2 < 0.0) ? 0.0 : cs->m2;
+                }
+                cs->n--;
+                GhDequeEvict(cs->maxq,&cs->maxhead,&cs->maxcount,ws->first);
+                GhDequeEvict(cs->minq,&cs->minhead,&cs->mincount,ws->first);
+            }
+            ws->first++;
+            ws->count--;
+        }
+    }
+
+    st->rtime[slot] = rdata.rtime;
+    st->ring[TEMPERATURE][slot] = rdata.temperature;
+    st->ring[HUMIDITY][slot] = rdata.humidity;
+    st->ring[PRESSURE][slot] = rdata.pressure;
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        ws = &st->win[w];
+        if(ws->count == 0)
+        {
+            ws->first = seq;
+        }
+        for(s=0; s<SENSORS; s++)
+        {
+            cs = &ws->chan[s];
+            x = st->ring[s][slot];
+            if(isnan(x))
+            {
+                continue;
+            }
+            oldmean = cs->mean;
+            cs->mean += (x - oldmean) / (++cs->n);
+            cs->m2 += (x - oldmean) * (x - cs->mean);
+            GhDequePush(cs->maxq,&cs->maxhead,&cs->maxcount,st->ring[s],seq,1.0);
+            GhDequePush(cs->minq,&cs->minhead,&cs->mincount,st->ring[s],seq,-1.0);
+        }
+        ws->count++;
+        if(slot == STATMAXWIN - 1)
+        {
+            GhStatsResync(st,ws);
+        }
+    }
+    st->seq++;
+}
+
+/** @brief Gets the rolling statistics of one sensor over one window
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to statistics store
+ *  @param win window index
+ *  @param sensor TEMPERATURE, HUMIDITY or PRESSURE
+ *  @return object of statistics summary type
+*/
+statsummary_s GhStatsGet(stats_s * st, int win, int sensor)
+{
+    statsummary_s sum = {0};
+    winstats_s * ws = &st->win[win];
+    chanstats_s * cs = &ws->chan[sensor];
+    if(cs->n == 0)
+    {
+        // Nothing in the window, or only a failed sensor's NAN samples
+        sum.mean = sum.variance = sum.min = sum.max = (ws->count == 0) ? 0.0 : NAN;
+        return sum;
+    }
+    sum.count = cs->n;
+    sum.mean = cs->mean;
+    sum.variance = (cs->n > 1) ? cs->m2 / (cs->n - 1) : 0.0;
+    sum.max = st->ring[sensor][cs->maxq[cs->maxhead] % STATMAXWIN];
+    sum.min = st->ring[sensor][cs->minq[cs->minhead] % STATMAXWIN];
+    return sum;
+}
+
+/** @brief Refills the windows from the tail of the data log after a restart
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to initialised, empty statistics store
+ *  @param logname pointer to data log file name
+ *  @param now current time, samples older than the longest window are skipped
+ *  @return int number of samples added, 0 when the log is missing or stale
+*/
+int GhStatsRebuild(stats_s * st, const char * logname, time_t now)
+{
+    int i;
+    int w;
+    int added = 0;
+    int secs = 0;
+    off_t size;
+    struct tm lt;
+    reading_s rd = {0};
+    logstream_s * ls = (logstream_s *) malloc(sizeof(logstream_s));
+    logbatch_s * lb = (logbatch_s *) malloc(sizeof(logbatch_s));
+
+    if(ls == NULL || lb == NULL || !GhLogOpen(ls,logname))
+    {
+        free(ls);
+        free(lb);
+        return 0;
+    }
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        secs = (st->win[w].secs > secs) ? st->win[w].secs : secs;
+    }
+
+    // Only the tail can be in a window; the cut line it starts in does not parse
+    size = lseek(ls->fd,0,SEEK_END);
+    size = (size > (off_t) STATMAXWIN * STATLOGLINESZ) ? size - (off_t) STATMAXWIN * STATLOGLINESZ : 0;
+    lseek(ls->fd,size,SEEK_SET);
+
+    // The log holds local time, read back as if it were UTC
+    localtime_r(&now,&lt);
+    while(GhLogRead(ls,lb) > 0)
+    {
+        for(i=0; i<lb->n; i++)
+        {
+            rd.rtime = lb->rtime[i] - lt.tm_gmtoff;
+            if(rd.rtime > now - secs && rd.rtime <= now)
+            {
+                rd.temperature = lb->temperature[i];
+                rd.humidity = lb->humidity[i];
+                rd.pressure = lb->pressure[i];
+                GhStatsAdd(st,rd);
+                added++;
+            }
+        }
+    }
+    GhLogClose(ls);
+    free(ls);
+    free(lb);
+    return added;
+}
+
+/** @brief Prints one window of statistics summaries
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param sum summaries indexed by sensor
+ *  @param secs window length in seconds
+ *  @return void
+*/
+void GhDisplaySummary(const statsummary_s sum[SENSORS], int secs)
+{
+    fprintf(stdout,"Stats %4dmin\tT: %4.1lf/%4.1lf/%4.1lfC\tH: %4.1lf/%4.1lf/%4.1lf%%\tP: %6.1lf/%6.1lf/%6.1lfmB\n",
+        secs / 60,
+        sum[TEMPERATURE].min,sum[TEMPERATURE].mean,sum[TEMPERATURE].max,
+        sum[HUMIDITY].min,sum[HUMIDITY].mean,sum[HUMIDITY].max,
+        sum[PRESSURE].min,sum[PRESSURE].mean,sum[PRESSURE].max);
+}
+
+/** @brief Prints rolling statistics for each window
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param st pointer to statistics store
+ *  @return void
+*/
+void GhDisplayStats(stats_s * st)
+{
+    int w;
+    int s;
+    statsummary_s sum[SENSORS];
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        for(s=0; s<SENSORS; s++)
+        {
+            sum[s] = GhStatsGet(st,w,s);
+        }
+        GhDisplaySummary(sum,st->win[w].secs);
+    }
+}
+
+/** @brief Gets one sensor's value of a check reading, failing each sensor in turn for a spell
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param rd array of readings
+ *  @param j reading index
+ *  @param s TEMPERATURE, HUMIDITY or PRESSURE
+ *  @return double value, NAN while the sensor is failed
+*/
+static double GhStatsCheckValue(const reading_s * rd, size_t j, int s)
+{
+    if(j % STATCHECKDEAD < STATCHECKDEADLEN && (j / STATCHECKDEAD) % (SENSORS + 1) == (size_t) s + 1)
+    {
+        return NAN;
+    }
+    return (s == TEMPERATURE) ? rd[j].temperature : ((s == HUMIDITY) ? rd[j].humidity : rd[j].pressure);
+}
+
+/** @brief Checks the rolling windows against a brute-force recomputation over the same span
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param rd array of readings, oldest first
+ *  @param n number of readings
+ *  @param fp output stream
+ *  @return int 1 if every check agreed, 0 otherwise
+*/
+int GhStatsReport(const reading_s * rd, size_t n, FILE * fp)
+{
+    size_t i;
+    size_t j;
+    size_t checks = 0;
+    size_t bad = 0;
+    size_t dead = 0;
+    int w;
+    int s;
+    int count;
+    int len;
+    double x;
+    double sum;
+    double var;
+    double lo;
+    double hi;
+    double err;
+    double worstmean = 0.0;
+    double worstvar = 0.0;
+    double addsecs;
+    double brutesecs = 0.0;
+    statsummary_s got;
+    reading_s r;
+    struct timespec t0,t1;
+    stats_s * st = (stats_s *) malloc(sizeof(stats_s));
+
+    if(st == NULL)
+    {
+        fprintf(fp,"Cannot allocate memory\n");
+        return 0;
+    }
+    GhStatsInit(st,NULL);
+    clock_gettime(CLOCK_MONOTONIC,&t0);
+    for(i=0; i<n; i++)
+    {
+        GhStatsAdd(st,rd[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC,&t1);
+    addsecs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    GhStatsInit(st,NULL);
+    for(i=0; i<n; i++)
+    {
+        r = rd[i];
+        r.temperature = GhStatsCheckValue(rd,i,TEMPERATURE);
+        r.humidity = GhStatsCheckValue(rd,i,HUMIDITY);
+        r.pressure = GhStatsCheckValue(rd,i,PRESSURE);
+        dead += isnan(r.temperature) || isnan(r.humidity) || isnan(r.pressure);
+        GhStatsAdd(st,r);
+        if(i % STATCHECKSTRIDE != 0)
+        {
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC,&t0);
+        for(w=0; w<STATWINDOWS; w++)
+        {
+            for(s=0; s<SENSORS; s++)
+            {
+                // The window is every sample younger than its span, up to what the ring holds
+                len = 0;
+                count = 0;
+                sum = 0.0;
+                lo = INFINITY;
+                hi = -INFINITY;
+                for(j=i+1; j-- > 0 && rd[i].rtime - rd[j].rtime < st->win[w].secs && len < STATMAXWIN; len++)
+                {
+                    x = GhStatsCheckValue(rd,j,s);
+                    if(!isnan(x))
+                    {
+                        sum += x;
+                        lo = fmin(lo,x);
+                        hi = fmax(hi,x);
+                        count++;
+                    }
+                }
+                got = GhStatsGet(st,w,s);
+                checks++;
+                if(count == 0)
+                {
+                    // A window holding only a failed sensor has no statistics
+                    bad += (got.count != 0) || !isnan(got.mean) || !isnan(got.min) || !isnan(got.max);
+                    continue;
+                }
+                var = 0.0;
+                for(j=i+1-len; j<=i; j++)
+                {
+                    x = GhStatsCheckValue(rd,j,s);
+                    if(!isnan(x))
+                    {
+                        var += (x - sum / count) * (x - sum / count);
+                    }
+                }
+                var = (count > 1) ? var / (count - 1) : 0.0;
+                err = fabs(got.mean - sum / count) / (1.0 + fabs(sum / count));
+                worstmean = fmax(worstmean,err);
+                bad += !(err <= STATCHECKTOL);
+                // Removing a sample cancels terms the size of the mean square, so scale by that
+                err = fabs(got.variance - var) / (1.0 + var + sum / count * sum / count);
+                worstvar = fmax(worstvar,err);
+                bad += !(err <= STATCHECKTOL);
+                bad += (got.count != count) || (got.min != lo) || (got.max != hi);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC,&t1);
+        brutesecs += (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    }
+
+    fprintf(fp,"Rolling statistics, %zu readings over %.1lf hours, windows",n,(n > 0) ? (rd[n - 1].rtime - rd[0].rtime) / 3600.0 : 0.0);
+    for(w=0; w<STATWINDOWS; w++)
+    {
+        fprintf(fp," %ds",st->win[w].secs);
+    }
+    fprintf(fp,"\nGhStatsAdd: %.0lf ns per reading, brute force: %.0lf ns per window and sensor\n",
+        addsecs * 1e9 / n,(checks > 0) ? brutesecs * 1e9 / checks : 0.0);
+    fprintf(fp,"Readings with a failed sensor: %zu, each left out of that sensor's windows\n",dead);
+    fprintf(fp,"Checks: %zu, largest relative error: mean %.3g, variance %.3g (limit %.0e), failures: %zu\n",
+        checks,worstmean,worstvar,STATCHECKTOL,bad);
+    free(st);
+    return bad == 0;
+}
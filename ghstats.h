@@ -0,0 +1,79 @@
+/** @brief Gh sliding-window statistics constants, structures, function prototypes
+*   @file ghstats.h
+*
+*   Windows are durations, not sample counts, so they keep their length
+*   while the scheduler stretches and shrinks the sampling period. All
+*   windows share one ring of timestamped samples sized for the longest
+*   window at SCHEDMINMS; each evicts from its own front by age. A failed
+*   sensor's samples are NAN in the ring and are left out of its channel's
+*   count, mean and extremes.
+*/
+#ifndef GHSTATS_H
+#define GHSTATS_H
+
+// Includes
+#include "ghcontrol.h"
+#include "ghsched.h"
+
+// Statistics Constants
+#define STATWINDOWS 2
+#define STATWIN0SECS 300
+#define STATWIN1SECS 3600
+#define STATMAXWIN (STATWIN1SECS * 1000 / SCHEDMINMS)  // samples held, the longest window at the fastest period
+#define STATLOGLINESZ 128       // bytes of data log read back per sample held, see GhStatsRebuild()
+#define STATCHECKSTRIDE 7       // readings between brute-force checks in GhStatsReport()
+#define STATCHECKTOL 1e-9       // error allowed in the running mean and variance, relative to the mean and mean square
+#define STATCHECKDEAD 5000      // GhStatsReport() fails one sensor every this many readings
+#define STATCHECKDEADLEN 400    // for this many
+
+//Typedefs
+typedef struct chanstats
+{
+    uint32_t maxq[STATMAXWIN];  // sample sequence numbers, decreasing values
+    uint32_t minq[STATMAXWIN];
+    int maxhead;
+    int maxcount;
+    int minhead;
+    int mincount;
+    int n;                      // samples in the window with a value
+    double mean;
+    double m2;
+}chanstats_s;
+
+typedef struct winstats
+{
+    int secs;
+    int count;
+    uint32_t first;             // sequence number of the oldest sample in the window
+    chanstats_s chan[SENSORS];
+}winstats_s;
+
+typedef struct stats
+{
+    uint32_t seq;               // samples added
+    time_t rtime[STATMAXWIN];   // sample ring, slot seq % STATMAXWIN
+    double ring[SENSORS][STATMAXWIN];
+    winstats_s win[STATWINDOWS];
+}stats_s;
+
+typedef struct statsummary
+{
+    int count;
+    double mean;
+    double variance;
+    double min;
+    double max;
+}statsummary_s;
+
+// Function Prototypes
+///@cond INTERNAL
+void GhStatsInit(stats_s * st, const int winsecs[STATWINDOWS]);
+void GhStatsAdd(stats_s * st, reading_s rdata);
+statsummary_s GhStatsGet(stats_s * st, int win, int sensor);
+int GhStatsRebuild(stats_s * st, const char * logname, time_t now);
+void GhDisplaySummary(const statsummary_s sum[SENSORS], int secs);
+void GhDisplayStats(stats_s * st);
+int GhStatsReport(const reading_s * rd, size_t n, FILE * fp);
+///@endcond
+
+#endif
@@ -0,0 +1,1069 @@
+/** @brief Gh store-and-forward uploader functions
+*   @file ghupload.c
+*
+*   Everything that can wait (disk, name lookups, the network) happens on
+*   the uploader thread. getaddrinfo() cannot be interrupted, so each
+*   lookup runs on a detached thread of its own that the uploader waits
+*   for like a socket: a stop request or UPTIMEOUT abandons it, and
+*   whichever side finishes last frees it. The control loop's share is encoding each sample
+*   into the open block, plus a CRC and one copy under the queue lock each
+*   time a frame is sealed.
+*/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <netdb.h>
+#include <dirent.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "ghupload.h"
+#include "ghbatch.h"
+
+/** @brief Reads the monotonic clock
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param void
+ *  @return int64_t milliseconds
+*/
+static int64_t GhUploadNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/** @brief Wakes the uploader thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+static void GhUploadWake(ghupload_s * up)
+{
+    uint64_t one = 1;
+    if(write(up->wakefd,&one,sizeof(one)) != sizeof(one))
+    {
+        perror("Error (uploader wake)");
+    }
+}
+
+/** @brief Builds the outbox file name of a frame
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param seq frame sequence number
+ *  @param path buffer of FILEPATHSZ characters
+ *  @return void
+*/
+static void GhUploadPath(const ghupload_s * up, uint64_t seq, char * path)
+{
+    snprintf(path,FILEPATHSZ,"%s/%016llx.ghf",up->dir,(unsigned long long) seq);
+}
+
+/** @brief Closes the open frame and hands it to the uploader thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+static void GhUploadSeal(ghupload_s * up)
+{
+    size_t blen = UPBLOCKHDRSZ + ((up->blk.nbits + 63) / 64) * sizeof(uint64_t);
+    size_t elen = up->nevents * sizeof(upevent_s);
+    upframe_s * f = &up->seal;
+
+    f->hdr.magic = UPMAGIC;
+    f->hdr.version = UPVERSION;
+    f->hdr.nevents = up->nevents;
+    f->hdr.node = 0;            // node and number filled in by the thread as it is written out
+    f->hdr.seq = 0;
+    f->hdr.size = blen + elen;
+    memcpy(f->payload,&up->blk,blen);
+    memcpy(f->payload + blen,up->event,elen);
+    f->hdr.crc = GhCrc32(f->payload,f->hdr.size);
+
+    pthread_mutex_lock(&up->lock);
+    if(up->qcount == UPQUEUE)
+    {
+        // The thread is stuck on the disk; keep the newest frames
+        up->qhead = (up->qhead + 1) % UPQUEUE;
+        up->qcount--;
+        __atomic_add_fetch(&up->dropped,1,__ATOMIC_RELAXED);
+    }
+    memcpy(&up->queue[(up->qhead + up->qcount) % UPQUEUE],f,sizeof(upheader_s) + f->hdr.size);
+    up->qcount++;
+    pthread_mutex_unlock(&up->lock);
+    GhUploadWake(up);
+
+    memset(&up->blk,0,sizeof(cblock_s));
+    up->nevents = 0;
+    up->opened = 0;
+    up->sealed++;
+}
+
+/** @brief Reserves the next UPSEQBLOCK sequence numbers on disk
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return int 1 on success, 0 on error
+*/
+static int GhUploadReserve(ghupload_s * up)
+{
+    uint64_t limit = up->seqnext + UPSEQBLOCK;
+    char path[FILEPATHSZ];
+
+    // A restart skips the rest of the block, so numbers are never reused
+    snprintf(path,sizeof(path),"%s/seq",up->dir);
+    if(!GhWriteAtomic(path,&limit,sizeof(limit)))
+    {
+        return 0;
+    }
+    up->seqlimit = limit;
+    return 1;
+}
+
+/** @brief Orders sequence numbers for qsort()
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param a pointer to first sequence number
+ *  @param b pointer to second sequence number
+ *  @return int negative, zero or positive
+*/
+static int GhUploadCompare(const void * a, const void * b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+/** @brief Indexes the frames left in the outbox by an earlier run
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+static void GhUploadScan(ghupload_s * up)
+{
+    int fd;
+    size_t i;
+    size_t n = 0;
+    size_t cap = 0;
+    size_t len;
+    uint64_t seq;
+    uint64_t * found = NULL;
+    uint64_t * grown;
+    char * end;
+    char path[FILEPATHSZ];
+    DIR * d;
+    struct dirent * de;
+
+    up->seqnext = 1;
+    snprintf(path,sizeof(path),"%s/seq",up->dir);
+    fd = open(path,O_RDONLY | O_CLOEXEC);
+    if(fd != -1)
+    {
+        if(read(fd,&seq,sizeof(seq)) == sizeof(seq))
+        {
+            up->seqnext = seq;
+        }
+        close(fd);
+    }
+
+    d = opendir(up->dir);
+    while(d != NULL && (de = readdir(d)) != NULL)
+    {
+        len = strlen(de->d_name);
+        if(len > 4 && strcmp(de->d_name + len - 4,".tmp") == 0)
+        {
+            // Left by a write that never finished
+            if(snprintf(path,sizeof(path),"%s/%s",up->dir,de->d_name) < (int) sizeof(path))
+            {
+                unlink(path);
+            }
+            continue;
+        }
+        seq = strtoull(de->d_name,&end,16);
+        if(end != de->d_name + 16 || strcmp(end,".ghf") != 0)
+        {
+            continue;
+        }
+        if(n == cap)
+        {
+            cap = (cap == 0) ? 256 : cap * 2;
+            grown = realloc(found,cap * sizeof(uint64_t));
+            if(grown == NULL)
+            {
+                break;
+            }
+            found = grown;
+        }
+        found[n++] = seq;
+    }
+    if(d != NULL)
+    {
+        closedir(d);
+    }
+
+    qsort(found,n,sizeof(uint64_t),GhUploadCompare);
+    for(i=0; i<n; i++)
+    {
+        if(n - i > UPOUTBOXMAX)
+        {
+            GhUploadPath(up,found[i],path);
+            unlink(path);
+            __atomic_add_fetch(&up->dropped,1,__ATOMIC_RELAXED);
+            continue;
+        }
+        up->outbox[up->ocount++] = found[i];
+        if(found[i] >= up->seqnext)
+        {
+            up->seqnext = found[i] + 1;
+        }
+    }
+    free(found);
+    if(up->ocount > 0)
+    {
+        fprintf(stdout,"Upload outbox holds %d frame(s) from an earlier run\n",up->ocount);
+    }
+    __atomic_store_n(&up->pending,up->ocount,__ATOMIC_RELAXED);
+    if(!GhUploadReserve(up))
+    {
+        perror("Error (upload sequence)");
+    }
+}
+
+/** @brief Writes every queued frame to the outbox
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+static void GhUploadPersist(ghupload_s * up)
+{
+    char path[FILEPATHSZ];
+    upframe_s * f = &up->work;
+
+    pthread_mutex_lock(&up->lock);
+    while(up->qcount > 0)
+    {
+        memcpy(f,&up->queue[up->qhead],sizeof(upheader_s) + up->queue[up->qhead].hdr.size);
+        up->qhead = (up->qhead + 1) % UPQUEUE;
+        up->qcount--;
+        pthread_mutex_unlock(&up->lock);
+
+        if(up->seqnext >= up->seqlimit && !GhUploadReserve(up))
+        {
+            perror("Error (upload sequence)");
+        }
+        f->hdr.node = up->node;
+        f->hdr.seq = up->seqnext++;
+        GhUploadPath(up,f->hdr.seq,path);
+        if(!GhWriteAtomic(path,f,sizeof(upheader_s) + f->hdr.size))
+        {
+            fprintf(stderr,"Upload: cannot write %s, frame dropped\n",path);
+            __atomic_add_fetch(&up->dropped,1,__ATOMIC_RELAXED);
+        }
+        else
+        {
+            if(up->ocount == UPOUTBOXMAX)
+            {
+                // The outage has outlasted the outbox; forget the oldest frame
+                GhUploadPath(up,up->outbox[up->ohead],path);
+                unlink(path);
+                up->ohead = (up->ohead + 1) % UPOUTBOXMAX;
+                up->ocount--;
+                __atomic_add_fetch(&up->dropped,1,__ATOMIC_RELAXED);
+            }
+            up->outbox[(up->ohead + up->ocount) % UPOUTBOXMAX] = f->hdr.seq;
+            up->ocount++;
+            __atomic_store_n(&up->pending,up->ocount,__ATOMIC_RELAXED);
+        }
+        pthread_mutex_lock(&up->lock);
+    }
+    pthread_mutex_unlock(&up->lock);
+}
+
+/** @brief Reads and checks one frame from the outbox
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param seq frame sequence number
+ *  @param buf buffer of sizeof(upframe_s) bytes
+ *  @param nsamples pointer to the number of samples in the frame
+ *  @return size_t frame bytes, 0 if the file is missing or damaged
+*/
+static size_t GhUploadLoad(const ghupload_s * up, uint64_t seq, uint8_t * buf, uint32_t * nsamples)
+{
+    int fd;
+    ssize_t got;
+    upheader_s hdr;
+    char path[FILEPATHSZ];
+
+    GhUploadPath(up,seq,path);
+    fd = open(path,O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+    {
+        return 0;
+    }
+    got = read(fd,buf,sizeof(upframe_s));
+    close(fd);
+    if(got < (ssize_t) sizeof(upheader_s))
+    {
+        return 0;
+    }
+    memcpy(&hdr,buf,sizeof(hdr));
+    if(hdr.magic != UPMAGIC || hdr.version != UPVERSION || hdr.seq != seq || hdr.size < UPBLOCKHDRSZ
+        || (size_t) got != sizeof(upheader_s) + hdr.size || GhCrc32(buf + sizeof(upheader_s),hdr.size) != hdr.crc)
+    {
+        return 0;
+    }
+    memcpy(nsamples,buf + sizeof(upheader_s) + offsetof(cblock_s,nsamples),sizeof(uint32_t));
+    return got;
+}
+
+/** @brief Waits until a descriptor is ready, giving up on a stop request
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param fd the collector socket, or a lookup's eventfd
+ *  @param events POLLIN or POLLOUT
+ *  @return int 1 when the descriptor is ready, 0 after UPTIMEOUT or on stop
+*/
+static int GhUploadWait(ghupload_s * up, int fd, short events)
+{
+    int n;
+    int64_t left;
+    int64_t deadline = GhUploadNow() + UPTIMEOUT;
+    uint64_t wake;
+    struct pollfd pfds[2];
+
+    pfds[0].fd = fd;
+    pfds[0].events = events;
+    pfds[1].fd = up->wakefd;
+    pfds[1].events = POLLIN;
+    while(!__atomic_load_n(&up->stop,__ATOMIC_ACQUIRE))
+    {
+        left = deadline - GhUploadNow();
+        if(left <= 0)
+        {
+            return 0;
+        }
+        n = poll(pfds,2,(int) left);
+        if(n == -1 && errno != EINTR)
+        {
+            return 0;
+        }
+        if(n <= 0)
+        {
+            continue;
+        }
+        if(pfds[1].revents & POLLIN)
+        {
+            // New frames are written out after this request
+            if(read(up->wakefd,&wake,sizeof(wake)) != sizeof(wake))
+            {
+                continue;
+            }
+        }
+        if(pfds[0].revents != 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** @brief Closes the collector connection
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+static void GhUploadDisconnect(ghupload_s * up)
+{
+    if(up->sock != -1)
+    {
+        close(up->sock);
+        up->sock = -1;
+    }
+}
+
+/** @brief Lets go of a name lookup, freeing it if the other side already has
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param r pointer to lookup
+ *  @return void
+*/
+static void GhUploadResolveDrop(upresolve_s * r)
+{
+    if(__atomic_sub_fetch(&r->refs,1,__ATOMIC_ACQ_REL) == 0)
+    {
+        if(r->res != NULL)
+        {
+            freeaddrinfo(r->res);
+        }
+        close(r->donefd);
+        free(r);
+    }
+}
+
+/** @brief Runs one name lookup
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to lookup
+ *  @return void * NULL
+*/
+static void * GhUploadResolveThread(void * arg)
+{
+    upresolve_s * r = arg;
+    uint64_t one = 1;
+    struct addrinfo hints = {0};
+
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    r->err = getaddrinfo(r->host,r->port,&hints,&r->res);
+    if(write(r->donefd,&one,sizeof(one)) != sizeof(one))
+    {
+        perror("Error (uploader lookup)");
+    }
+    GhUploadResolveDrop(r);
+    return NULL;
+}
+
+/** @brief Looks up the collector without holding up a stop request
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return struct addrinfo * addresses for freeaddrinfo(), NULL on error, UPTIMEOUT or stop
+*/
+static struct addrinfo * GhUploadResolve(ghupload_s * up)
+{
+    pthread_t tid;
+    pthread_attr_t attr;
+    struct addrinfo * res = NULL;
+    upresolve_s * r = (upresolve_s *) calloc(1,sizeof(upresolve_s));
+
+    if(r == NULL)
+    {
+        return NULL;
+    }
+    memcpy(r->host,up->host,sizeof(r->host));
+    memcpy(r->port,up->port,sizeof(r->port));
+    r->refs = 2;
+    r->donefd = eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC);
+    if(r->donefd == -1 || pthread_attr_init(&attr) != 0)
+    {
+        if(r->donefd != -1)
+        {
+            close(r->donefd);
+        }
+        free(r);
+        return NULL;
+    }
+    pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+    if(pthread_create(&tid,&attr,GhUploadResolveThread,r) != 0)
+    {
+        pthread_attr_destroy(&attr);
+        close(r->donefd);
+        free(r);
+        return NULL;
+    }
+    pthread_attr_destroy(&attr);
+
+    // The eventfd write orders the result before it
+    if(GhUploadWait(up,r->donefd,POLLIN) && r->err == 0)
+    {
+        res = r->res;
+        r->res = NULL;
+    }
+    GhUploadResolveDrop(r);
+    return res;
+}
+
+/** @brief Connects to the collector
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return int 1 on success, 0 on error
+*/
+static int GhUploadConnect(ghupload_s * up)
+{
+    int one = 1;
+    int err;
+    socklen_t len;
+    struct addrinfo * res;
+    struct addrinfo * ai;
+
+    res = GhUploadResolve(up);
+    if(res == NULL)
+    {
+        return 0;
+    }
+    for(ai = res; ai != NULL && up->sock == -1; ai = ai->ai_next)
+    {
+        up->sock = socket(ai->ai_family,ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,ai->ai_protocol);
+        if(up->sock == -1)
+        {
+            continue;
+        }
+        err = 0;
+        len = sizeof(err);
+        if(connect(up->sock,ai->ai_addr,ai->ai_addrlen) == -1
+            && (errno != EINPROGRESS || !GhUploadWait(up,up->sock,POLLOUT)
+                || getsockopt(up->sock,SOL_SOCKET,SO_ERROR,&err,&len) == -1 || err != 0))
+        {
+            GhUploadDisconnect(up);
+            continue;
+        }
+        setsockopt(up->sock,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+    }
+    freeaddrinfo(res);
+    return up->sock != -1;
+}
+
+/** @brief Sends a buffer in full
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param buf pointer to data
+ *  @param len number of bytes
+ *  @return int 1 on success, 0 on error or timeout
+*/
+static int GhUploadWrite(ghupload_s * up, const uint8_t * buf, size_t len)
+{
+    ssize_t n;
+    while(len > 0)
+    {
+        n = send(up->sock,buf,len,MSG_NOSIGNAL | MSG_DONTWAIT);
+        if(n > 0)
+        {
+            buf += n;
+            len -= n;
+        }
+        else if(n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        else if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            if(!GhUploadWait(up,up->sock,POLLOUT))
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/** @brief Appends whatever the collector has sent to the reply buffer
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return int 1 if bytes were added, 0 on close, error, timeout or a full buffer
+*/
+static int GhUploadRead(ghupload_s * up)
+{
+    ssize_t n;
+    while(up->replylen < UPREPLYSZ - 1)
+    {
+        n = recv(up->sock,up->reply + up->replylen,UPREPLYSZ - 1 - up->replylen,MSG_DONTWAIT);
+        if(n > 0)
+        {
+            up->replylen += n;
+            up->reply[up->replylen] = '\0';
+            return 1;
+        }
+        if(n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if(n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK) && GhUploadWait(up,up->sock,POLLIN))
+        {
+            continue;
+        }
+        return 0;
+    }
+    return 0;
+}
+
+/** @brief Settles the oldest frame in the outbox from one answer line
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param line "ACK <seq>" or "NAK <seq>"
+ *  @param k position of the frame in the request
+ *  @return int 1 if the line answered the oldest frame, 0 otherwise
+*/
+static int GhUploadAnswer(ghupload_s * up, const char * line, int k)
+{
+    unsigned long long seq;
+    char verdict[4];
+    char path[FILEPATHSZ];
+
+    if(up->ocount == 0 || sscanf(line,"%3s %llu",verdict,&seq) != 2 || seq != up->outbox[up->ohead])
+    {
+        return 0;
+    }
+    if(strcmp(verdict,"ACK") == 0)
+    {
+        __atomic_add_fetch(&up->acked,1,__ATOMIC_RELAXED);
+        __atomic_add_fetch(&up->samples,up->inflight[k],__ATOMIC_RELAXED);
+    }
+    else if(strcmp(verdict,"NAK") == 0)
+    {
+        // Sending it again would not change the answer
+        fprintf(stderr,"Upload: collector rejected frame %llu\n",seq);
+        __atomic_add_fetch(&up->rejected,1,__ATOMIC_RELAXED);
+    }
+    else
+    {
+        return 0;
+    }
+    GhUploadPath(up,seq,path);
+    unlink(path);
+    up->ohead = (up->ohead + 1) % UPOUTBOXMAX;
+    up->ocount--;
+    __atomic_store_n(&up->pending,up->ocount,__ATOMIC_RELAXED);
+    return 1;
+}
+
+/** @brief Sends the oldest frames in one request and settles the answers
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return int 1 if every frame sent was answered, 0 otherwise
+*/
+static int GhUploadRequest(ghupload_s * up)
+{
+    int k;
+    int n = 0;
+    int status;
+    int keep = 1;
+    size_t size;
+    size_t len = 0;
+    size_t hlen = 0;
+    long body;
+    char * eol;
+    char * start;
+    char * hend;
+    char * field;
+    char hdr[UPHTTPHDRSZ];
+    char path[FILEPATHSZ];
+    uint8_t * frames = up->sendbuf + UPHTTPHDRSZ;
+
+    // The oldest frames, in order; a damaged file is dropped once it is the oldest
+    while(n < UPSENDFRAMES && n < up->ocount)
+    {
+        size = GhUploadLoad(up,up->outbox[(up->ohead + n) % UPOUTBOXMAX],frames + len,&up->inflight[n]);
+        if(size > 0)
+        {
+            len += size;
+            n++;
+            continue;
+        }
+        if(n > 0)
+        {
+            break;
+        }
+        fprintf(stderr,"Upload: frame %llu is damaged, dropped\n",(unsigned long long) up->outbox[up->ohead]);
+        GhUploadPath(up,up->outbox[up->ohead],path);
+        unlink(path);
+        up->ohead = (up->ohead + 1) % UPOUTBOXMAX;
+        up->ocount--;
+        __atomic_store_n(&up->pending,up->ocount,__ATOMIC_RELAXED);
+        __atomic_add_fetch(&up->dropped,1,__ATOMIC_RELAXED);
+    }
+    if(n == 0)
+    {
+        return 1;
+    }
+
+    // The request line and headers go just ahead of the frames, so one send covers both
+    if(up->http)
+    {
+        hlen = snprintf(hdr,sizeof(hdr),"POST %s HTTP/1.1\r\nHost: %s:%s\r\nContent-Type: application/octet-stream\r\n"
+            "Content-Length: %zu\r\n\r\n",up->path,up->host,up->port,len);
+        if(hlen >= sizeof(hdr))
+        {
+            return 0;
+        }
+        memcpy(frames - hlen,hdr,hlen);
+    }
+    up->replylen = 0;
+    up->reply[0] = '\0';
+    if(!GhUploadWrite(up,frames - hlen,hlen + len))
+    {
+        return 0;
+    }
+
+    // One answer line per frame, in order
+    start = up->reply;
+    if(up->http)
+    {
+        while((hend = strstr(up->reply,"\r\n\r\n")) == NULL)
+        {
+            if(!GhUploadRead(up))
+            {
+                return 0;
+            }
+        }
+        *hend = '\0';
+        if(sscanf(up->reply,"HTTP/%*d.%*d %d",&status) != 1 || status != 200)
+        {
+            fprintf(stderr,"Upload: collector replied \"%.*s\"\n",(int) strcspn(up->reply,"\r\n"),up->reply);
+            return 0;
+        }
+        field = strcasestr(up->reply,"\r\nContent-Length:");
+        body = (field == NULL) ? -1 : strtol(field + 17,NULL,10);
+        field = strcasestr(up->reply,"\r\nConnection:");
+        keep = (field == NULL) || strncasecmp(field + 13 + strspn(field + 13," "),"close",5) != 0;
+        start = hend + 4;
+        if(body < 0 || body > UPREPLYSZ - 1 - (start - up->reply))
+        {
+            return 0;
+        }
+        while(up->reply + up->replylen < start + body)
+        {
+            if(!GhUploadRead(up))
+            {
+                return 0;
+            }
+        }
+        start[body] = '\0';
+    }
+    for(k=0; k<n; k++)
+    {
+        while((eol = strchr(start,'\n')) == NULL)
+        {
+            if(up->http)
+            {
+                return 0;
+            }
+            up->replylen -= start - up->reply;
+            memmove(up->reply,start,up->replylen + 1);
+            start = up->reply;
+            if(!GhUploadRead(up))
+            {
+                return 0;
+            }
+        }
+        *eol = '\0';
+        if(!GhUploadAnswer(up,start,k))
+        {
+            return 0;
+        }
+        start = eol + 1;
+    }
+    __atomic_add_fetch(&up->bytes,hlen + len,__ATOMIC_RELAXED);
+    if(!keep)
+    {
+        GhUploadDisconnect(up);
+    }
+    return 1;
+}
+
+/** @brief Sends one request, reconnecting as needed
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return int 1 on success, 0 if the collector could not be reached or did not answer
+*/
+static int GhUploadSend(ghupload_s * up)
+{
+    int reused = (up->sock != -1);
+    if(!reused && !GhUploadConnect(up))
+    {
+        return 0;
+    }
+    if(GhUploadRequest(up))
+    {
+        return 1;
+    }
+    GhUploadDisconnect(up);
+
+    // An idle connection the collector has since closed is not an outage
+    return reused && !__atomic_load_n(&up->stop,__ATOMIC_ACQUIRE) && GhUploadConnect(up) && GhUploadRequest(up);
+}
+
+/** @brief Writes out sealed frames and forwards the outbox
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param arg pointer to uploader
+ *  @return void * NULL
+*/
+static void * GhUploadThread(void * arg)
+{
+    ghupload_s * up = arg;
+    int backoff = 0;
+    int64_t left;
+    uint64_t wake;
+    unsigned int seed;
+    struct pollfd pfd;
+
+    // Lower priority, so on a busy core a wake-up does not preempt the control loop
+    setpriority(PRIO_PROCESS,(id_t) syscall(SYS_gettid),UPNICE);
+
+    // Read here rather than in GhUploadStart(), as it takes a few ms
+    up->node = GhGetSerial();
+    seed = (unsigned int)(up->node ^ (uint64_t) time(NULL));
+    GhUploadScan(up);
+    pfd.fd = up->wakefd;
+    pfd.events = POLLIN;
+    for(;;)
+    {
+        GhUploadPersist(up);
+        if(__atomic_load_n(&up->stop,__ATOMIC_ACQUIRE))
+        {
+            // Frames sealed along with the stop request
+            GhUploadPersist(up);
+            break;
+        }
+        if(up->ocount > 0 && GhUploadNow() >= up->retryat)
+        {
+            if(GhUploadSend(up))
+            {
+                backoff = 0;
+                __atomic_store_n(&up->backoff,0,__ATOMIC_RELAXED);
+                continue;
+            }
+            GhUploadDisconnect(up);
+            if(__atomic_load_n(&up->stop,__ATOMIC_ACQUIRE))
+            {
+                continue;
+            }
+
+            // Exponential backoff, jittered by a quarter so a fleet does not retry in step
+            backoff = (backoff == 0) ? UPBACKOFFMIN : ((backoff > UPBACKOFFMAX / 2) ? UPBACKOFFMAX : backoff * 2);
+            __atomic_store_n(&up->retryat,GhUploadNow() + backoff - backoff / 4 + rand_r(&seed) % (backoff / 2 + 1),__ATOMIC_RELAXED);
+            __atomic_store_n(&up->backoff,backoff,__ATOMIC_RELAXED);
+        }
+        left = (up->ocount > 0) ? up->retryat - GhUploadNow() : -1;
+        if(poll(&pfd,1,(up->ocount > 0 && left < 0) ? 0 : (int) left) > 0)
+        {
+            if(read(up->wakefd,&wake,sizeof(wake)) != sizeof(wake))
+            {
+                continue;
+            }
+        }
+    }
+    GhUploadDisconnect(up);
+    return NULL;
+}
+
+/** @brief Splits a collector URL into protocol, host, port and path
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param url tcp://host:port or http://host[:port][/path]
+ *  @return int 1 if the URL is valid, 0 otherwise
+*/
+static int GhUploadParse(ghupload_s * up, const char * url)
+{
+    int n = 0;
+    const char * p;
+
+    if(strncmp(url,"tcp://",6) == 0)
+    {
+        up->http = 0;
+        p = url + 6;
+    }
+    else if(strncmp(url,"http://",7) == 0)
+    {
+        up->http = 1;
+        p = url + 7;
+    }
+    else
+    {
+        return 0;
+    }
+    if(sscanf(p,"%127[^:/]%n",up->host,&n) != 1)
+    {
+        return 0;
+    }
+    p += n;
+    if(*p == ':')
+    {
+        n = 0;
+        if(sscanf(p + 1,"%7[0-9]%n",up->port,&n) != 1)
+        {
+            return 0;
+        }
+        p += n + 1;
+    }
+    else if(up->http)
+    {
+        strcpy(up->port,"80");
+    }
+    else
+    {
+        return 0;
+    }
+    if(*p != '\0' && (!up->http || *p != '/' || strlen(p) >= UPURLSZ))
+    {
+        return 0;
+    }
+    strcpy(up->path,(*p == '\0') ? "/" : p);
+    return 1;
+}
+
+/** @brief Starts the uploader thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param url collector URL, tcp://host:port or http://host[:port][/path]
+ *  @param dir outbox directory, created if missing
+ *  @return int 1 if the thread is running, 0 otherwise
+*/
+int GhUploadStart(ghupload_s * up, const char * url, const char * dir)
+{
+    memset(up,0,sizeof(ghupload_s));
+    up->sock = -1;
+    up->wakefd = -1;
+    if(!GhUploadParse(up,url))
+    {
+        fprintf(stderr,"Upload: bad collector URL %s (use tcp://host:port or http://host[:port][/path])\n",url);
+        return 0;
+    }
+    // UPDIRSZ leaves room for "/<16 hex digits>.ghf.tmp" after the directory
+    if(snprintf(up->dir,sizeof(up->dir),"%s",dir) >= (int) sizeof(up->dir))
+    {
+        fprintf(stderr,"Upload: outbox path %s is too long\n",dir);
+        return 0;
+    }
+    if(mkdir(dir,0755) == -1 && errno != EEXIST)
+    {
+        perror("Error (upload outbox)");
+        return 0;
+    }
+    if(pthread_mutex_init(&up->lock,NULL) != 0)
+    {
+        return 0;
+    }
+    up->wakefd = eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC);
+    if(up->wakefd == -1 || pthread_create(&up->tid,NULL,GhUploadThread,up) != 0)
+    {
+        perror("Error (uploader)");
+        if(up->wakefd != -1)
+        {
+            close(up->wakefd);
+        }
+        pthread_mutex_destroy(&up->lock);
+        return 0;
+    }
+    up->running = 1;
+    return 1;
+}
+
+/** @brief Adds a control cycle's sample and alarm changes to the open frame
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @param snap pointer to the cycle's snapshot
+ *  @return void
+*/
+void GhUploadSample(ghupload_s * up, const ghsnapshot_s * snap)
+{
+    int code;
+    uint32_t changed = snap->alarms ^ up->alarms;
+    upevent_s * ev;
+    reading_s live;
+
+    for(code=HTEMP; code<NALARMS && changed != 0; code++)
+    {
+        if(!(changed & ALARMBIT(code)))
+        {
+            continue;
+        }
+        ev = &up->event[up->nevents++];
+        ev->active = (snap->alarms & ALARMBIT(code)) != 0;
+        ev->code = code;
+        ev->time = ev->active ? (int64_t) snap->atime[code] : (int64_t) snap->rdata.rtime;
+        ev->value = ev->active ? snap->avalue[code] : up->avalue[code];
+        ev->pad = 0;
+        up->opened = (up->opened != 0) ? up->opened : snap->rdata.rtime;
+        if(up->nevents == UPMAXEVENTS)
+        {
+            GhUploadSeal(up);
+        }
+    }
+    up->alarms = snap->alarms;
+    memcpy(up->avalue,snap->avalue,sizeof(up->avalue));
+
+    // Held values are not new samples; a failed channel goes in as NAN
+    if(snap->rdata.stale != (1 << SENSORS) - 1)
+    {
+        live = GhLiveReadings(snap->rdata);
+        if(!GhCBlockAdd(&up->blk,&up->enc,live))
+        {
+            GhUploadSeal(up);
+            GhCBlockAdd(&up->blk,&up->enc,live);
+        }
+        up->opened = (up->opened != 0) ? up->opened : snap->rdata.rtime;
+    }
+    if(up->opened != 0 && ((UPALARMSEAL && changed != 0) || snap->rdata.rtime - up->opened >= UPFRAMESECS))
+    {
+        GhUploadSeal(up);
+    }
+}
+
+/** @brief Prints the outbox and what the collector has acknowledged
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+void GhUploadDisplay(const ghupload_s * up)
+{
+    int backoff = __atomic_load_n(&up->backoff,__ATOMIC_RELAXED);
+    int64_t left = __atomic_load_n(&up->retryat,__ATOMIC_RELAXED) - GhUploadNow();
+    uint64_t samples = __atomic_load_n(&up->samples,__ATOMIC_RELAXED);
+    uint64_t dropped = __atomic_load_n(&up->dropped,__ATOMIC_RELAXED);
+
+    fprintf(stdout,"Upload\tOutbox: %d\tSent: %llu frames, %llu samples",__atomic_load_n(&up->pending,__ATOMIC_RELAXED),
+        (unsigned long long) __atomic_load_n(&up->acked,__ATOMIC_RELAXED),(unsigned long long) samples);
+    if(samples > 0)
+    {
+        fprintf(stdout," (%.1lf B/sample)",(double) __atomic_load_n(&up->bytes,__ATOMIC_RELAXED) / samples);
+    }
+    if(backoff > 0)
+    {
+        fprintf(stdout,"\tCollector down, retry in %llds",(long long)((left > 0) ? (left + 999) / 1000 : 0));
+    }
+    if(dropped > 0)
+    {
+        fprintf(stdout,"\t%llu dropped",(unsigned long long) dropped);
+    }
+    fprintf(stdout,"\n");
+}
+
+/** @brief Sends the open frame to the outbox and stops the thread
+ *  @version 18OCT2026
+ *  @author Jakob Wood
+ *  @param up pointer to uploader
+ *  @return void
+*/
+void GhUploadStop(ghupload_s * up)
+{
+    if(!up->running)
+    {
+        return;
+    }
+    if(up->opened != 0)
+    {
+        GhUploadSeal(up);
+    }
+    __atomic_store_n(&up->stop,1,__ATOMIC_RELEASE);
+    GhUploadWake(up);
+    pthread_join(up->tid,NULL);
+    close(up->wakefd);
+    pthread_mutex_destroy(&up->lock);
+    up->running = 0;
+}
@@ -0,0 +1,157 @@
+/** @brief Gh store-and-forward uploader constants, structures, function prototypes
+*   @file ghupload.h
+*
+*   Samples and alarm changes are batched into frames for a central
+*   collector. A frame is one ghcompress.c block, cut to the words in use,
+*   then the alarm events, behind a header with the Pi's serial number, a
+*   sequence number and a CRC-32 of the rest. Frames are in host byte
+*   order, as the checkpoint is.
+*
+*   The control loop only encodes into the open frame and, once it is
+*   sealed, copies it onto a short queue. The uploader thread writes each
+*   queued frame to the outbox directory, one file per frame named by its
+*   sequence number, and sends the oldest frames to the collector. A file
+*   is deleted once the collector acknowledges it, so frames wait out
+*   outages and restarts on disk. A collector that is down or slow only
+*   holds up the thread, which retries with exponential backoff.
+*
+*   The uploader runs only when ghc is given a collector with -u; without
+*   one nothing is sealed or written to the outbox.
+*
+*   Collector URLs: tcp://host:port sends the frames on a bare connection,
+*   http://host:port/path sends them as the body of a POST. Either way the
+*   collector answers each frame with a line, "ACK <seq>" once it is stored
+*   (or was already) and "NAK <seq>" if it fails the checks.
+*/
+#ifndef GHUPLOAD_H
+#define GHUPLOAD_H
+
+// Includes
+#include <pthread.h>
+#include <stddef.h>
+#include "ghcontrol.h"
+#include "ghcompress.h"
+#include "ghshm.h"
+
+// Uploader Constants
+#define UPLOAD 1                        // 0 leaves the uploader out, 1 runs it when -u names a collector
+#define UPOUTBOX "ghoutbox"
+#define UPMAGIC 0x46554847              // "GHUF"
+#define UPVERSION 1
+#define UPFRAMESECS 120                 // s of samples per frame
+#define UPALARMSEAL 1                   // 1 sends a frame as soon as an alarm is raised or cleared
+#define UPMAXEVENTS 32                  // alarm events per frame
+#define UPQUEUE 8                       // sealed frames waiting for the thread
+#define UPOUTBOXMAX 5040                // frames kept on disk (a week at UPFRAMESECS), oldest deleted first
+#define UPSENDFRAMES 16                 // frames per request
+#define UPSEQBLOCK 65536                // sequence numbers reserved on disk at a time
+#define UPTIMEOUT 5000                  // ms without progress before a request fails
+#define UPBACKOFFMIN 1000               // ms before the first retry, doubled for each one after
+#define UPBACKOFFMAX 300000
+#define UPNICE 10                       // uploader thread nice value
+#define UPURLSZ 128
+#define UPNAMESZ 26                     // "/<16 hex digits>.ghf.tmp" and its NUL
+#define UPDIRSZ (FILEPATHSZ - UPNAMESZ) // so every outbox path fits in FILEPATHSZ
+#define UPREPLYSZ 2048
+#define UPHTTPHDRSZ 512                 // room for the request line and headers ahead of the frames
+#define UPBLOCKHDRSZ offsetof(cblock_s,words)
+
+//Typedefs
+typedef struct upheader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t nevents;
+    uint64_t node;                      // serial number of the Pi
+    uint64_t seq;                       // frame number, increasing across restarts
+    uint32_t size;                      // bytes after the header
+    uint32_t crc;                       // CRC-32 of those bytes
+}upheader_s;
+
+typedef struct upevent
+{
+    int64_t time;
+    double value;
+    uint16_t code;                      // alarm_e
+    uint16_t active;                    // 1 when raised, 0 when cleared
+    uint32_t pad;
+}upevent_s;
+
+typedef struct upframe
+{
+    upheader_s hdr;
+    uint8_t payload[sizeof(cblock_s) + UPMAXEVENTS * sizeof(upevent_s)];
+}upframe_s;
+
+typedef struct upresolve
+{
+    char host[UPURLSZ];
+    char port[8];
+    struct addrinfo * res;
+    int err;                            // getaddrinfo() result
+    int donefd;                         // eventfd, written once the lookup returns
+    int refs;                           // lookup thread and uploader; the last to let go frees it
+}upresolve_s;
+
+typedef struct ghupload
+{
+    // Control loop
+    cblock_s blk;                       // samples of the open frame
+    cstate_s enc;
+    upevent_s event[UPMAXEVENTS];
+    int nevents;
+    time_t opened;                      // first sample or event of the open frame, 0 while empty
+    uint32_t alarms;                    // ALARMBIT(code) at the last sample
+    double avalue[NALARMS];
+    upframe_s seal;
+
+    // Shared, queue under lock
+    pthread_mutex_t lock;
+    upframe_s queue[UPQUEUE];
+    int qhead;
+    int qcount;
+    int stop;
+    int wakefd;
+
+    // Uploader thread
+    pthread_t tid;
+    int running;
+    uint64_t node;                      // serial number of the Pi
+    int http;
+    int sock;
+    char host[UPURLSZ];
+    char port[8];
+    char path[UPURLSZ];
+    char dir[UPDIRSZ];
+    uint64_t seqnext;
+    uint64_t seqlimit;                  // first sequence number not yet reserved on disk
+    uint64_t outbox[UPOUTBOXMAX];       // sequence numbers on disk, oldest first
+    int ohead;
+    int ocount;
+    int backoff;                        // ms, 0 while the collector answers
+    int64_t retryat;                    // monotonic ms
+    upframe_s work;
+    uint32_t inflight[UPSENDFRAMES];    // samples in each frame of the request
+    uint8_t sendbuf[UPHTTPHDRSZ + UPSENDFRAMES * sizeof(upframe_s)] __attribute__((aligned(8)));
+    char reply[UPREPLYSZ];
+    size_t replylen;
+
+    // Counters, read by GhUploadDisplay()
+    uint64_t sealed;
+    uint64_t acked;
+    uint64_t rejected;
+    uint64_t dropped;                   // frames lost to a full queue, full outbox or failed write
+    uint64_t samples;                   // samples in acknowledged frames
+    uint64_t bytes;                     // bytes sent for acknowledged frames
+    int pending;                        // frames in the outbox
+}ghupload_s;
+
+// Function Prototypes
+///@cond INTERNAL
+int GhUploadStart(ghupload_s * up, const char * url, const char * dir);
+void GhUploadSample(ghupload_s * up, const ghsnapshot_s * snap);
+void GhUploadDisplay(const ghupload_s * up);
+void GhUploadStop(ghupload_s * up);
+///@endcond
+
+#endif
@@ -20,31 +20,86 @@
 #include <poll.h>
 #include <dirent.h>
 #include <linux/input.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <dlfcn.h>
 #include <time.h>
 
-// If running without physical Sensehat set EMULATOR to 1
-// Also comment out any calls you have in your main to GhLogData
-// Remember to also use -lpython2.7 instead of -lwiringPi in the makefile
-#define EMULATOR 0
-#if EMULATOR
- #include <python2.7/Python.h>
-#else
- #include <wiringPi.h>
- #include <wiringPiI2C.h>
-#endif
+// The sensors and the display are function tables picked with ShSelect()
+// before they are opened: the Sense Hat on i2c-dev or on the simulated bus,
+// or the sense_emu emulator through a Python loaded only when it is used.
+// One build runs them all; the sensor tables share the driver code above
+// the bus, so the simulated bus tests the same acquisitions as the Pi.
+
+// Sensor Bus Constants
+// Worst case per acquisition is SHREADDEADLINE plus one SHI2CTIMEOUT transfer
+#define SHI2CDEV "/dev/i2c-1"
+#define SHPYTHONLIB "libpython2.7.so.1.0"
+#define SIMBUSERRPCT 0          // percent of simulated transfers that fail
+#define SIMBUSHANGPCT 0         // percent of simulated conversions that never finish
+#define SIMCHECKREADS 20        // clean acquisitions timed by ShSimBusReport()
+#define SIMCHECKMS 2000         // read period the report drives the FIFO at
+#define SIMCHECKSTEP 5.0        // mB pressure step the FIFO must show
+#define SIMCHECKTOL 0.2         // mB allowed for the simulated noise
+#define SHI2CTIMEOUT 20         // ms adapter timeout for one transfer
+#define SHI2CRETRIES 3          // attempts per transfer
+#define SHI2CBACKOFF 1000       // us before the first retry, doubled for each one after
+#define SHREADDEADLINE 150      // ms budget for one sensor acquisition
+#define SHPOLLDELAY 5000        // us between one-shot status polls
+#define SHFAILLIMIT 3           // consecutive failed acquisitions before a sensor is failed
+#define SHPROBECYCLES 10        // acquisitions skipped between probes of a failed sensor
+#define SHHTS221 0
+#define SHLPS25H 1
+#define SHSENSORS 2
+
+// Conversion Constants
+#define SHFIXEDPOINT 0          // 1 converts with Q16 integer arithmetic, within 0.01 of the double path
+#define SHQBITS 16
+#define SHQHALF (1 << (SHQBITS - 1))
+#define SHCALREGS 13            // HTS221 calibration registers the conversion is built from
+#define SHCONVTOL 0.01          // largest fixed-point error, in C, % or hPa
+#define SHCONVCALS 64           // random calibrations ShConvertReport() sweeps
+#define SHCONVBENCHN 65536      // raw counts it times each path on
+#define SHCONVREPS 50
+#define SHCONVSEED 20261018u
 
 // LPS25H Constants
 #define LPS25HI2CADDRESS 0x5c
 #define PRESS_OUT_XL 0x28
 #define PRESS_OUT_L 0x29
 #define PRESS_OUT_H 0x2A
+#define RES_CONF 0x10
+#define LPS25HRESCONF 0x0A      // AVGT 32, AVGP 128 internal samples per output
 //#define TEMP_OUT_L 0x2B
 //#define TEMP_OUT_H 0x2C
 
+// LPS25H FIFO Constants
+// In stream mode the sensor converts at its own rate and keeps the newest
+// LPS25HFIFOSIZE samples; a read takes FIFO_STATUS and then every queued
+// sample in one burst. The rate is the fastest whose FIFO covers the read
+// period with LPS25HFIFOMARGIN to spare.
+#define LPS25HFIFO 1            // 0 takes a one-shot conversion on every read
+#define LPS25HFIFOSIZE 32
+#define LPS25HFIFOROLL 1        // the burst address rolls back from TEMP_OUT_H to PRESS_OUT_XL
+#define LPS25HFIFOMARGIN 1.25
+#define LPS25HSAMPLEBYTES 5     // PRESS_OUT_XL to TEMP_OUT_H
+#define FIFO_CTRL 0x2E
+#define FIFO_STATUS 0x2F
+#define LPS25HAUTOINC 0x80      // sub-address bit that steps through registers in a burst
+#define LPS25HPDBDU 0x84        // CTRL_REG1 power on, block data update, ODR in bits 6:4
+#define LPS25HFIFOEN 0x40       // CTRL_REG2 FIFO_EN
+#define LPS25HSTREAM 0x40       // FIFO_CTRL stream mode, the oldest sample is dropped when full
+#define LPS25HFIFOFULL 0x40     // FIFO_STATUS bits
+#define LPS25HFIFOEMPTY 0x20
+#define LPS25HFIFOLEVEL 0x1F
+#define LPS25HODRS 5            // one-shot, 1, 7, 12.5 and 25 Hz
+
 // HTS221 Constants
 #define HTS221I2CADDRESS 0x5F
 #define HTS221DELAY 25000
 #define WHO_AM_I 0x0F
+#define AV_CONF 0x10
+#define HTS221AVCONF 0x2D       // AVGT 64, AVGH 128 internal samples per output
 
 #define CTRL_REG1 0x20
 #define CTRL_REG2 0x21
@@ -80,6 +135,9 @@
 #define RGB565_GREEN    0x07E0
 #define RGB565_BLUE     0x001F
 
+// Enumerated Types
+typedef enum { SHOK, SHDEGRADED, SHFAILED } shstate_e;
+
 // Structures
 typedef struct fbpixel
 {
@@ -92,23 +150,132 @@ typedef struct lps25hData
 {
     double temperature;
     double pressure;
+    int valid;          // 0 when the acquisition failed or timed out
+    int16_t rawtemperature;
+    int32_t rawpressure;
 } lps25hData_s;
 
+typedef struct lps25hFifo
+{
+    int count;          // samples drained, oldest first
+    int overrun;        // 1 when the FIFO was full, so older samples may be lost
+    double hz;          // output data rate the samples were taken at
+    lps25hData_s sample[LPS25HFIFOSIZE];
+} lps25hFifo_s;
+
 typedef struct ht221sData
 {
     double temperature;
     double humidity;
+    int valid;          // 0 when the acquisition failed or timed out
+    int16_t rawtemperature;
+    int16_t rawhumidity;
+    uint32_t calid;     // identifies the calibration used for the conversion
 } ht221sData_s;
 
+typedef struct shhealth
+{
+    shstate_e state;
+    uint32_t consecutive;   // failed acquisitions in a row
+    uint32_t skip;          // acquisitions left before the next probe
+    uint64_t reads;
+    uint64_t failures;
+    uint64_t retries;
+} shhealth_s;
+
+typedef struct shcal
+{
+    int valid;
+    uint32_t id;            // FNV-1a hash of the calibration registers
+    double t_gradient_m;
+    double t_intercept_c;
+    double h_gradient_m;
+    double h_intercept_c;
+    int32_t t0_out;
+    int64_t t0_q;           // T0 in 0.01 C, Q16
+    int64_t t_slope_q;      // 0.01 C per count, Q16
+    int32_t h0_out;
+    int64_t h0_q;           // H0 in 0.01 %, Q16
+    int64_t h_slope_q;      // 0.01 % per count, Q16
+} shcal_s;
+
+typedef struct shxfer
+{
+    int fd;
+    int addr;               // bus address, for bursts
+    uint64_t deadline;      // monotonic us
+    shhealth_s *health;
+} shxfer_s;
+
+typedef struct shbus
+{
+    const char *name;
+    int (*open)(int addr);                  // handle for a device, -1 on failure
+    void (*close)(int fd);
+    int (*read8)(int fd, int reg);          // register value, -1 on failure
+    int (*write8)(int fd, int reg, int val);    // 0, -1 on failure
+    int (*burst)(int fd, int addr, int reg, uint8_t *buf, int len); // len, -1 on failure
+} shbus_s;
+
+typedef struct shsensors
+{
+    const char *name;
+    const shbus_s *bus;     // for the register-level driver, NULL otherwise
+    int pinned;             // 1 when every call must come from the thread that opened it
+    int (*open)(void);      // exit status
+    void (*close)(void);
+    ht221sData_s (*hts221)(void);
+    lps25hData_s (*lps25h)(void);
+    lps25hData_s (*lps25hfifo)(lps25hFifo_s *fifo);    // NULL takes one conversion as the batch
+    void (*fifoperiod)(int ms);                         // NULL without a FIFO
+} shsensors_s;
+
+typedef struct shdisplay
+{
+    const char *name;
+    int pinned;
+    int (*open)(void);      // exit status
+    void (*close)(void);
+    void (*clear)(void);
+    uint8_t (*setpixel)(int x, int y, fbpixel_s px);
+    uint16_t *(*framebuffer)(void);     // mapped NUM_WORDS RGB565 pixels, NULL if not mapped
+} shdisplay_s;
+
+// Backends
+extern const shsensors_s shi2csensors;     // Sense Hat on SHI2CDEV
+extern const shsensors_s shsimsensors;     // simulated bus with fault injection
+extern const shsensors_s shemusensors;     // sense_emu
+extern const shdisplay_s shfbdisplay;      // Sense Hat framebuffer, FILEPATH
+extern const shdisplay_s shemudisplay;     // sense_emu
+extern const shdisplay_s shnodisplay;      // headless
+
 // Function Prototypes
 /// @cond INTERNAL
+void ShSelect(const shsensors_s *sensors, const shdisplay_s *display);
+int ShPinned(void);
 int ShInit(void);
 int ShExit(void);
+int ShDisplayInit(void);
+int ShSensorInit(void);
+shhealth_s ShSensorHealth(int sensor);
+shcal_s ShHTS221Calibration(void);
+int32_t ShHTS221CentiTemp(const shcal_s *cal, int16_t t_out);
+int32_t ShHTS221CentiHumid(const shcal_s *cal, int16_t h_out);
+int32_t ShLPS25HCentiPress(int32_t press_out);
+int32_t ShLPS25HCentiTemp(int16_t temp_out);
+void ShSimBusFaults(int errpct, int hangpct);
+void ShSimBusAdvance(uint64_t us);
+void ShSimBusPressure(double mb);
+int ShSimBusReport(FILE *fp);
+int ShConvertReport(FILE *fp);
 void ShClearMatrix(void);
+uint16_t *ShFrameBuffer(void);
 uint8_t ShSetPixel(int x,int y,fbpixel_s px);
 int ShSetVerticalBar(int bar,fbpixel_s px, uint8_t value);
 double ShLPS25HGetPressure(void);
 lps25hData_s ShGetLPS25HData(void);
+lps25hData_s ShGetLPS25HFifo(lps25hFifo_s *fifo);
+void ShLPS25HFifoPeriod(int ms);
 ht221sData_s ShGetHT221SData(void);
 /// @endcond
 #endif